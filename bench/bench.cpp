@@ -0,0 +1,140 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "bench.h"
+
+#include <algorithm>
+#include <format>
+
+namespace {
+
+auto RunOnce(const Benchmark& benchmark, std::uint64_t iterations) {
+    auto state = BenchmarkState {iterations, benchmark.finish};
+    benchmark.function(state);
+    return state;
+}
+
+auto EscapeJson(std::string_view text) {
+    auto output = std::string {};
+    for (const auto c : text) {
+        if (c == '"' || c == '\\') output += '\\';
+        output += c;
+    }
+    return output;
+}
+
+} // namespace
+
+auto RunBenchmark(const Benchmark& benchmark, const BenchmarkOptions& options) -> BenchmarkResult {
+    const auto min_time = std::chrono::duration<double, std::nano>(options.min_time).count();
+
+    // grow the iteration count until one run takes at least min_time
+    auto iterations = std::uint64_t {1};
+    while (true) {
+        const auto state = RunOnce(benchmark, iterations);
+        if (state.Skipped()) {
+            return {.name = benchmark.name, .error = state.Skipped().value()};
+        }
+        if (!state.Finished()) {
+            return {.name = benchmark.name, .error = "benchmark did not run its loop"};
+        }
+
+        const auto elapsed = static_cast<double>(state.Elapsed().count());
+        if (elapsed >= min_time) break;
+
+        const auto predicted = elapsed > 0.0
+            ? min_time / elapsed * 1.2 * static_cast<double>(iterations)
+            : static_cast<double>(iterations) * 10.0;
+        iterations = std::clamp(
+            static_cast<std::uint64_t>(predicted),
+            iterations + 1,
+            iterations * 10
+        );
+    }
+
+    auto samples = std::vector<double> {};
+    auto items = std::uint64_t {0};
+    auto bytes = std::uint64_t {0};
+    auto counters = std::vector<std::pair<std::string, double>> {};
+    for (auto i = 0u; i < std::max(options.repetitions, 1u); ++i) {
+        const auto state = RunOnce(benchmark, iterations);
+        samples.emplace_back(static_cast<double>(state.Elapsed().count()) / static_cast<double>(iterations));
+        items = state.ItemsPerIteration();
+        bytes = state.BytesPerIteration();
+        counters = state.Counters();
+    }
+    std::ranges::sort(samples);
+
+    const auto median = samples[samples.size() / 2];
+    return {
+        .name = benchmark.name,
+        .iterations = iterations,
+        .ns_per_op = median,
+        .min_ns = samples.front(),
+        .max_ns = samples.back(),
+        .items_per_second = static_cast<double>(items) * 1e9 / median,
+        .bytes_per_second = static_cast<double>(bytes) * 1e9 / median,
+        .counters = std::move(counters)
+    };
+}
+
+auto WriteJson(
+    std::ostream& stream,
+    const BenchmarkContext& context,
+    const std::vector<BenchmarkResult>& results
+) -> void {
+    stream << "{\n  \"context\": {\n";
+    stream << std::format("    \"label\": \"{}\",\n", EscapeJson(context.label));
+    stream << std::format("    \"build_type\": \"{}\",\n", EscapeJson(context.build_type));
+    stream << std::format("    \"gl_renderer\": \"{}\"\n", EscapeJson(context.gl_renderer));
+    stream << "  },\n  \"benchmarks\": [";
+
+    auto separator = "\n";
+    for (const auto& result : results) {
+        stream << separator << std::format(
+            "    {{\"name\": \"{}\", \"iterations\": {}, \"ns_per_op\": {:.3f}, "
+            "\"min_ns\": {:.3f}, \"max_ns\": {:.3f}, \"items_per_second\": {:.1f}, "
+            "\"bytes_per_second\": {:.1f}",
+            EscapeJson(result.name), result.iterations, result.ns_per_op,
+            result.min_ns, result.max_ns, result.items_per_second, result.bytes_per_second
+        );
+        if (!result.counters.empty()) {
+            stream << ", \"counters\": {";
+            auto counter_separator = "";
+            for (const auto& [name, value] : result.counters) {
+                stream << std::format("{}\"{}\": {:g}", counter_separator, EscapeJson(name), value);
+                counter_separator = ", ";
+            }
+            stream << '}';
+        }
+        if (!result.error.empty()) {
+            stream << std::format(", \"error\": \"{}\"", EscapeJson(result.error));
+        }
+        stream << '}';
+        separator = ",\n";
+    }
+    stream << "\n  ]\n}\n";
+}
+
+auto WriteTable(std::ostream& stream, const BenchmarkResult& result) -> void {
+    if (!result.error.empty()) {
+        stream << std::format("{:<36} skipped: {}\n", result.name, result.error);
+        return;
+    }
+
+    auto throughput = std::string {};
+    if (result.bytes_per_second > 0.0) {
+        throughput = std::format("{:.1f} MB/s", result.bytes_per_second / 1e6);
+    } else if (result.items_per_second > 0.0) {
+        throughput = std::format("{:.3g} items/s", result.items_per_second);
+    }
+
+    for (const auto& [name, value] : result.counters) {
+        throughput += std::format(" {}={:.4g}", name, value);
+    }
+
+    stream << std::format(
+        "{:<36} {:>14.1f} ns {:>14.1f} ns {:>14.1f} ns {:>12} {}\n",
+        result.name, result.ns_per_op, result.min_ns, result.max_ns, result.iterations, throughput
+    );
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A small benchmark harness. Each benchmark is a function that sets up its
+// state and then loops on BenchmarkState::Running; only the loop is timed.
+//
+//   registry.Add("Box/Generate", [](BenchmarkState& state) {
+//       const auto params = ...;
+//       while (state.Running()) {
+//           DoNotOptimize(BoxGeometry::Generate(params));
+//       }
+//   });
+class BenchmarkState {
+public:
+    BenchmarkState(std::uint64_t iterations, const std::function<void()>& finish)
+      : iterations_(iterations), remaining_(iterations), finish_(finish) {}
+
+    // starts the clock on the first call and stops it after the last iteration
+    auto Running() -> bool {
+        if (!started_) {
+            started_ = true;
+            start_ = Clock::now();
+        }
+        if (remaining_ > 0) {
+            --remaining_;
+            return true;
+        }
+        if (finish_) finish_();
+        elapsed_ = Clock::now() - start_ - paused_;
+        return false;
+    }
+
+    // leaves work inside the loop, such as evicting caches, out of the timing
+    auto PauseTiming() { pause_start_ = Clock::now(); }
+
+    auto ResumeTiming() { paused_ += Clock::now() - pause_start_; }
+
+    // work done per iteration, for throughput
+    auto SetItemsPerIteration(std::uint64_t items) { items_ = items; }
+
+    auto SetBytesPerIteration(std::uint64_t bytes) { bytes_ = bytes; }
+
+    // a named figure reported next to the timings, such as a ratio achieved
+    auto SetCounter(std::string name, double value) { counters_.emplace_back(std::move(name), value); }
+
+    // call instead of running the loop when the benchmark cannot run
+    auto Skip(std::string reason) { skipped_ = std::move(reason); }
+
+    [[nodiscard]] auto Skipped() const -> const std::optional<std::string>& { return skipped_; }
+
+    [[nodiscard]] auto Finished() const { return started_ && remaining_ == 0; }
+
+    [[nodiscard]] auto Iterations() const { return iterations_; }
+
+    [[nodiscard]] auto Elapsed() const { return elapsed_; }
+
+    [[nodiscard]] auto ItemsPerIteration() const { return items_; }
+
+    [[nodiscard]] auto BytesPerIteration() const { return bytes_; }
+
+    [[nodiscard]] auto Counters() const -> const std::vector<std::pair<std::string, double>>& { return counters_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t iterations_;
+    std::uint64_t remaining_;
+    std::uint64_t items_ {0};
+    std::uint64_t bytes_ {0};
+
+    const std::function<void()>& finish_;
+
+    std::optional<std::string> skipped_ {};
+    std::vector<std::pair<std::string, double>> counters_ {};
+
+    bool started_ {false};
+    Clock::time_point start_ {};
+    Clock::time_point pause_start_ {};
+    std::chrono::nanoseconds paused_ {0};
+    std::chrono::nanoseconds elapsed_ {0};
+};
+
+// keeps the compiler from discarding a result that is otherwise unused
+template <typename T>
+auto DoNotOptimize(const T& value) -> void {
+    static auto sink = std::atomic<const void*> {nullptr};
+    sink.store(&value, std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+using BenchmarkFunction = std::function<void(BenchmarkState& state)>;
+
+struct Benchmark {
+    std::string name;
+    BenchmarkFunction function;
+
+    // runs inside the timed region after the last iteration; GL benchmarks
+    // use glFinish so queued work is paid for by the benchmark that issued it
+    std::function<void()> finish {};
+};
+
+struct BenchmarkResult {
+    std::string name;
+    std::uint64_t iterations {0};
+    double ns_per_op {0.0}; // median of the repetitions
+    double min_ns {0.0};
+    double max_ns {0.0};
+    double items_per_second {0.0};
+    double bytes_per_second {0.0};
+    std::vector<std::pair<std::string, double>> counters {};
+    std::string error {}; // set when the benchmark was skipped
+};
+
+struct BenchmarkOptions {
+    std::chrono::milliseconds min_time {100}; // per repetition
+    std::uint32_t repetitions {5};
+};
+
+class BenchmarkRegistry {
+public:
+    auto Add(std::string name, BenchmarkFunction function, std::function<void()> finish = {}) {
+        benchmarks_.emplace_back(std::move(name), std::move(function), std::move(finish));
+    }
+
+    [[nodiscard]] auto Benchmarks() const -> const std::vector<Benchmark>& { return benchmarks_; }
+
+private:
+    std::vector<Benchmark> benchmarks_ {};
+};
+
+auto RunBenchmark(const Benchmark& benchmark, const BenchmarkOptions& options) -> BenchmarkResult;
+
+struct BenchmarkContext {
+    std::string label {};
+    std::string build_type {};
+    std::string gl_renderer {};
+};
+
+auto WriteJson(
+    std::ostream& stream,
+    const BenchmarkContext& context,
+    const std::vector<BenchmarkResult>& results
+) -> void;
+
+auto WriteTable(std::ostream& stream, const BenchmarkResult& result) -> void;
+
+// cpu_benchmarks.cpp
+auto RegisterCpuBenchmarks(BenchmarkRegistry& registry) -> void;
+
+// gl_benchmarks.cpp; expects a current GL context
+auto RegisterGlBenchmarks(BenchmarkRegistry& registry) -> void;
\ No newline at end of file
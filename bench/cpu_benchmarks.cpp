@@ -0,0 +1,653 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "bench.h"
+#include "fixtures.h"
+#include "reference_mesh.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <memory>
+#include <fstream>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "core/command_list.h"
+#include "core/debug_draw.h"
+#include "core/event_dispatcher.h"
+#include "core/events.h"
+#include "core/occlusion_culler.h"
+#include "core/perspective_camera.h"
+#include "geometries/box_geometry.h"
+#include "geometries/mesh_bvh.h"
+#include "geometries/mesh_processing.h"
+#include "geometries/mesh_simplifier.h"
+#include "geometries/meshlets.h"
+#include "geometries/plane_geometry.h"
+#include "loaders/asset_archive.h"
+#include "loaders/file_reader.h"
+#include "loaders/image_loader.h"
+#include "resources/clustered_lights.h"
+#include "resources/orbit_controls.h"
+#include "resources/scene_index.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+auto GeometryBenchmarks(BenchmarkRegistry& registry) {
+    for (const auto segments : {1u, 32u}) {
+        registry.Add(std::format("BoxGeometry/Generate/{}", segments), [segments](BenchmarkState& state) {
+            const auto params = BoxGeometry::Parameters {
+                .width = 1.0f,
+                .height = 1.0f,
+                .depth = 1.0f,
+                .width_segments = segments,
+                .height_segments = segments,
+                .depth_segments = segments
+            };
+            state.SetItemsPerIteration(BoxGeometry::Generate(params).vertex_data.size() / 8);
+            while (state.Running()) {
+                DoNotOptimize(BoxGeometry::Generate(params));
+            }
+        });
+    }
+
+    for (const auto segments : {1u, 256u}) {
+        registry.Add(std::format("PlaneGeometry/Generate/{}", segments), [segments](BenchmarkState& state) {
+            const auto params = PlaneGeometry::Parameters {
+                .width = 1.0f,
+                .height = 1.0f,
+                .width_segments = segments,
+                .height_segments = segments
+            };
+            state.SetItemsPerIteration(PlaneGeometry::Generate(params).vertex_data.size() / 8);
+            while (state.Running()) {
+                DoNotOptimize(PlaneGeometry::Generate(params));
+            }
+        });
+    }
+}
+
+auto MeshBenchmarks(BenchmarkRegistry& registry) {
+    // one vertex per heightmap texel
+    constexpr auto kSize = 4096;
+    const auto params = PlaneGeometry::Parameters {
+        .width = 100.0f,
+        .height = 100.0f,
+        .width_segments = kSize - 1,
+        .height_segments = kSize - 1
+    };
+    const auto vertices = static_cast<std::size_t>(kSize) * kSize;
+
+    // the displaced offsets grow with every iteration, which costs the same
+    for (const auto scalar : {false, true}) {
+        const auto name = std::format("Mesh/Displace/{}{}", kSize, scalar ? "/scalar" : "");
+        registry.Add(name, [=](BenchmarkState& state) {
+            auto data = PlaneGeometry::Generate(params);
+            const auto heightmap = Heightmap(kSize);
+            state.SetItemsPerIteration(vertices);
+            while (state.Running()) {
+                if (scalar) {
+                    ReferenceDisplace(data, *heightmap, 2.0f);
+                } else {
+                    DisplaceVertices(data, *heightmap, {.scale = 2.0f});
+                }
+            }
+        });
+    }
+
+    for (const auto scalar : {false, true}) {
+        const auto name = std::format("Mesh/GridNormals/{}{}", kSize, scalar ? "/scalar" : "");
+        registry.Add(name, [=](BenchmarkState& state) {
+            auto data = PlaneGeometry::Generate(params);
+            DisplaceVertices(data, *Heightmap(kSize), {.scale = 2.0f});
+            state.SetItemsPerIteration(vertices);
+            while (state.Running()) {
+                if (scalar) {
+                    ReferenceGridNormals(data, PlaneGeometry::Grid(params));
+                } else {
+                    ComputeGridNormals(data, PlaneGeometry::Grid(params));
+                }
+            }
+        });
+    }
+
+    for (const auto scalar : {false, true}) {
+        const auto name = std::format("Mesh/Normals/{}{}", kSize, scalar ? "/scalar" : "");
+        registry.Add(name, [=](BenchmarkState& state) {
+            auto data = PlaneGeometry::Generate(params);
+            DisplaceVertices(data, *Heightmap(kSize), {.scale = 2.0f});
+            state.SetItemsPerIteration(vertices);
+            while (state.Running()) {
+                if (scalar) {
+                    ReferenceNormals(data);
+                } else {
+                    ComputeNormals(data);
+                }
+            }
+        });
+    }
+
+    // throughput in input triangles, and the reduction and error of each level
+    for (const auto segments : {64u, 256u}) {
+        registry.Add(std::format("Mesh/GenerateLods/{}", segments), [segments](BenchmarkState& state) {
+            const auto grid = PlaneGeometry::Parameters {
+                .width = 100.0f,
+                .height = 100.0f,
+                .width_segments = segments,
+                .height_segments = segments
+            };
+            auto data = PlaneGeometry::Generate(grid);
+            DisplaceVertices(data, *Heightmap(256), {.scale = 10.0f});
+            ComputeGridNormals(data, PlaneGeometry::Grid(grid));
+
+            const auto indices = data.index_data.size();
+            state.SetItemsPerIteration(indices / 3);
+            while (state.Running()) {
+                data.index_data.resize(indices);
+                GenerateLods(data, {});
+            }
+
+            for (auto lod = std::size_t {1}; lod < data.lods.size(); ++lod) {
+                const auto ratio = static_cast<double>(data.lods[lod].index_count) / static_cast<double>(indices);
+                state.SetCounter(std::format("lod{}_triangles", lod), ratio);
+                state.SetCounter(std::format("lod{}_error", lod), data.lods[lod].error);
+            }
+        });
+    }
+
+    registry.Add("Mesh/BuildMeshlets/256", [](BenchmarkState& state) {
+        const auto grid = PlaneGeometry::Parameters {
+            .width = 100.0f,
+            .height = 100.0f,
+            .width_segments = 256,
+            .height_segments = 256
+        };
+        auto data = PlaneGeometry::Generate(grid);
+        DisplaceVertices(data, *Heightmap(256), {.scale = 10.0f});
+        ComputeGridNormals(data, PlaneGeometry::Grid(grid));
+
+        state.SetItemsPerIteration(data.index_data.size() / 3);
+        while (state.Running()) {
+            BuildMeshlets(data, {});
+        }
+        state.SetCounter("meshlets", static_cast<double>(data.meshlets.size()));
+    });
+}
+
+auto OcclusionBenchmarks(BenchmarkRegistry& registry) {
+    // one frame of a street: walls on both sides and across the far end,
+    // with a grid of small boxes behind and between them
+    registry.Add("OcclusionCuller/Frame", [](BenchmarkState& state) {
+        auto camera = PerspectiveCamera {60.0f, 16.0f / 9.0f, 0.1f, 200.0f};
+        camera.transform = glm::inverse(glm::lookAt(
+            glm::vec3 {0.0f, 2.0f, 20.0f},
+            glm::vec3 {0.0f, 2.0f, 0.0f},
+            glm::vec3 {0.0f, 1.0f, 0.0f}
+        ));
+        camera.OnUpdate();
+
+        const auto wall = BoxGeometry::Generate({
+            .width = 1.0f,
+            .height = 1.0f,
+            .depth = 1.0f,
+            .width_segments = 4,
+            .height_segments = 4,
+            .depth_segments = 4
+        });
+        auto walls = std::vector<glm::mat4> {};
+        for (auto i = 0; i < 8; ++i) {
+            const auto z = 10.0f - static_cast<float>(i) * 6.0f;
+            for (const auto side : {-1.0f, 1.0f}) {
+                const auto position = glm::vec3 {side * 6.0f, 4.0f, z};
+                walls.emplace_back(glm::scale(glm::translate(glm::mat4 {1.0f}, position), glm::vec3 {1.0f, 8.0f, 5.0f}));
+            }
+        }
+        walls.emplace_back(glm::scale(glm::translate(glm::mat4 {1.0f}, glm::vec3 {0.0f, 5.0f, -40.0f}), glm::vec3 {14.0f, 10.0f, 1.0f}));
+
+        auto boxes = std::vector<glm::vec3> {};
+        for (auto x = 0; x < 32; ++x) {
+            for (auto z = 0; z < 32; ++z) {
+                boxes.emplace_back(static_cast<float>(x) * 3.0f - 46.5f, 0.0f, -static_cast<float>(z) * 3.0f);
+            }
+        }
+
+        auto culler = OcclusionCuller {{.width = 256, .height = 128}};
+        auto visible = std::size_t {0};
+        state.SetItemsPerIteration(boxes.size());
+        while (state.Running()) {
+            culler.BeginFrame(camera.Projection() * camera.View());
+            for (const auto& model : walls) culler.AddOccluder(wall, model);
+            culler.Rasterize();
+            visible = 0;
+            for (const auto& box : boxes) {
+                visible += !culler.IsOccluded(box, box + glm::vec3 {1.0f});
+            }
+        }
+        DoNotOptimize(visible);
+
+        const auto& stats = culler.GetStats();
+        state.SetCounter("occluder_triangles", static_cast<double>(stats.occluder_triangles));
+        state.SetCounter("occluded", static_cast<double>(stats.occluded));
+        state.SetCounter("rasterize_ms", stats.rasterize_ms);
+        state.SetCounter("test_ms", stats.test_ms);
+    });
+}
+
+// a displaced grid of about a million triangles
+auto MillionTriangles() {
+    const auto grid = PlaneGeometry::Parameters {
+        .width = 100.0f,
+        .height = 100.0f,
+        .width_segments = 708,
+        .height_segments = 708
+    };
+    auto data = PlaneGeometry::Generate(grid);
+    DisplaceVertices(data, *Heightmap(256), {.scale = 10.0f});
+    return data;
+}
+
+auto BvhBenchmarks(BenchmarkRegistry& registry) {
+    for (const auto parallel : {false, true}) {
+        const auto name = std::format("MeshBvh/Build/1M/{}", parallel ? "parallel" : "serial");
+        registry.Add(name, [parallel](BenchmarkState& state) {
+            const auto data = MillionTriangles();
+            state.SetItemsPerIteration(data.index_data.size() / 3);
+            while (state.Running()) {
+                DoNotOptimize(MeshBvh {data, {.parallel = parallel}});
+            }
+        });
+    }
+
+    // cursor rays spread over the screen, as picking would cast them
+    registry.Add("MeshBvh/Raycast/1M", [](BenchmarkState& state) {
+        const auto bvh = MeshBvh {MillionTriangles(), {}};
+        auto camera = PerspectiveCamera {45.0f, 4.0f / 3.0f, 0.1f, 500.0f};
+        camera.transform = glm::inverse(glm::lookAt(
+            glm::vec3 {0.0f, 60.0f, 80.0f},
+            glm::vec3 {0.0f},
+            glm::vec3 {0.0f, 1.0f, 0.0f}
+        ));
+        camera.OnUpdate();
+
+        auto rays = std::vector<Ray> {};
+        for (auto y = 0; y < 32; ++y) {
+            for (auto x = 0; x < 32; ++x) {
+                rays.emplace_back(camera.CursorRay({x * 32.0f + 16.0f, y * 24.0f + 12.0f}, {1024.0f, 768.0f}));
+            }
+        }
+
+        auto hits = std::size_t {0};
+        state.SetItemsPerIteration(rays.size());
+        while (state.Running()) {
+            hits = 0;
+            for (const auto& ray : rays) hits += bvh.Raycast(ray).has_value();
+        }
+        state.SetCounter("hits", static_cast<double>(hits) / static_cast<double>(rays.size()));
+    });
+
+    // every object moves a little each frame, so the tree is refitted
+    registry.Add("SceneIndex/Update/4096", [](BenchmarkState& state) {
+        const auto box = std::make_shared<MeshBvh>(BoxGeometry::Generate({
+            .width = 1.0f,
+            .height = 1.0f,
+            .depth = 1.0f,
+            .width_segments = 1,
+            .height_segments = 1,
+            .depth_segments = 1
+        }), BvhParameters {});
+
+        auto positions = std::vector<glm::vec3> {};
+        auto index = SceneIndex {};
+        for (auto i = 0; i < 4096; ++i) {
+            positions.emplace_back(static_cast<float>(i % 64) * 2.0f, 0.0f, static_cast<float>(i / 64) * 2.0f);
+            index.Add(box, glm::translate(glm::mat4 {1.0f}, positions.back()));
+        }
+        index.Update();
+
+        auto frame = 0;
+        state.SetItemsPerIteration(positions.size());
+        while (state.Running()) {
+            const auto offset = glm::vec3 {0.0f, static_cast<float>(frame++ % 2) * 0.1f, 0.0f};
+            for (auto i = 0u; i < positions.size(); ++i) {
+                index.SetTransform(i, glm::translate(glm::mat4 {1.0f}, positions[i] + offset));
+            }
+            index.Update();
+        }
+    });
+}
+
+auto LightBenchmarks(BenchmarkRegistry& registry) {
+    for (const auto count : {256u, 4096u}) {
+        registry.Add(std::format("ClusteredLights/Bin/{}", count), [count](BenchmarkState& state) {
+            auto camera = PerspectiveCamera {60.0f, 16.0f / 9.0f, 0.1f, 200.0f};
+            camera.transform = glm::inverse(glm::lookAt(
+                glm::vec3 {0.0f, 8.0f, 60.0f},
+                glm::vec3 {0.0f},
+                glm::vec3 {0.0f, 1.0f, 0.0f}
+            ));
+            camera.OnUpdate();
+
+            auto lighting = ClusteredLights {{}};
+            lighting.lights = ScatteredLights(count);
+            state.SetItemsPerIteration(count);
+            while (state.Running()) {
+                lighting.Bin(camera);
+            }
+            const auto& stats = lighting.GetStats();
+            state.SetCounter("visible", static_cast<double>(stats.visible));
+            state.SetCounter("references", static_cast<double>(stats.references));
+        });
+    }
+}
+
+// the dispatcher events went through before they were keyed by type: a
+// name lookup per dispatch, weak listeners locked one by one, and a heap
+// allocated event that listeners downcast
+class NamedDispatcher {
+public:
+    using Listener = std::function<void(Event*)>;
+
+    auto AddEventListener(const std::string& name, std::weak_ptr<Listener> listener) {
+        callbacks_[name].emplace_back(std::move(listener));
+    }
+
+    auto Dispatch(const std::string& name, std::unique_ptr<Event> event) {
+        if (!callbacks_.contains(name)) return;
+        auto& callbacks = callbacks_[name];
+        for (auto iter = begin(callbacks); iter != end(callbacks);) {
+            if (const auto& callback = iter->lock()) {
+                (*callback)(event.get());
+                ++iter;
+            } else {
+                iter = callbacks.erase(iter);
+            }
+        }
+    }
+
+private:
+    std::unordered_map<std::string, std::vector<std::weak_ptr<Listener>>> callbacks_;
+};
+
+auto EventBenchmarks(BenchmarkRegistry& registry) {
+    for (const auto listeners : {1u, 16u}) {
+        registry.Add(std::format("EventDispatcher/Dispatch/{}", listeners), [listeners](BenchmarkState& state) {
+            auto& dispatcher = EventDispatcher::Get();
+            auto received = 0;
+            auto handles = std::vector<ListenerHandle> {};
+            for (auto i = 0u; i < listeners; ++i) {
+                handles.emplace_back(dispatcher.AddEventListener<MouseEvent>(
+                    [&received](const MouseEvent&) { ++received; }
+                ));
+            }
+
+            auto event = MouseEvent {};
+            event.type = MouseEvent::Type::Moved;
+            event.button = MouseButton::None;
+            while (state.Running()) {
+                dispatcher.Dispatch(event);
+            }
+            DoNotOptimize(received);
+
+            for (auto& handle : handles) dispatcher.RemoveEventListener(handle);
+        });
+
+        registry.Add(std::format("EventDispatcher/DispatchByName/{}", listeners), [listeners](BenchmarkState& state) {
+            auto dispatcher = NamedDispatcher {};
+            auto received = 0;
+            auto callbacks = std::vector<std::shared_ptr<NamedDispatcher::Listener>> {};
+            for (auto i = 0u; i < listeners; ++i) {
+                callbacks.emplace_back(std::make_shared<NamedDispatcher::Listener>([&received](Event* event) {
+                    if (event->As<MouseEvent>()) ++received;
+                }));
+                dispatcher.AddEventListener("mouse_event", callbacks.back());
+            }
+
+            while (state.Running()) {
+                auto event = std::make_unique<MouseEvent>();
+                event->type = MouseEvent::Type::Moved;
+                event->button = MouseButton::None;
+                dispatcher.Dispatch("mouse_event", std::move(event));
+            }
+            DoNotOptimize(received);
+        });
+    }
+}
+
+auto LoaderBenchmarks(BenchmarkRegistry& registry) {
+    registry.Add("ImageLoader/Load/png", [](BenchmarkState& state) {
+        // synchronous load of a file the OS has cached, so mostly decode
+        const auto path = fs::path {BENCH_ASSETS_DIR} / "checker.png";
+        const auto loader = ImageLoader::Create();
+        auto bytes = std::size_t {0};
+        const auto load = [&bytes](LoaderResult<Image> result) {
+            if (result) bytes = result.value()->Bytes();
+        };
+
+        loader->Load(path, load);
+        if (bytes == 0) {
+            state.Skip(std::format("failed to load '{}'", path.string()));
+            return;
+        }
+
+        state.SetBytesPerIteration(bytes);
+        while (state.Running()) {
+            loader->Load(path, load);
+        }
+    });
+
+    // every file read whole, either as loose files checked and opened one by
+    // one like Loader does, or looked up in an archive mapped once; cold runs
+    // evict the files from the page cache before each iteration, untimed
+    constexpr auto kFiles = std::size_t {2048};
+    constexpr auto kFileSize = std::size_t {4096};
+    const auto dir = fs::temp_directory_path() / "opengl-cmake-bench-archive";
+    const auto archive_path = dir / "assets.pak";
+    const auto files = std::make_shared<std::vector<fs::path>>();
+    const auto prepare = [=] {
+        if (!files->empty()) return;
+        *files = LooseFiles(dir, kFiles, kFileSize);
+        PackFiles(dir, *files, archive_path);
+    };
+    const auto sum = [](std::span<const std::byte> bytes) {
+        return std::accumulate(bytes.begin(), bytes.end(), 0u, [](auto total, auto byte) {
+            return total + static_cast<unsigned>(byte);
+        });
+    };
+
+    for (const auto cold : {false, true}) {
+        const auto suffix = cold ? "cold" : "warm";
+
+        registry.Add(std::format("AssetArchive/Read/loose/{}", suffix), [=](BenchmarkState& state) {
+            prepare();
+            if (cold && !DropPageCache(dir / files->front())) {
+                state.Skip("page cache cannot be dropped");
+                return;
+            }
+            state.SetItemsPerIteration(kFiles);
+            state.SetBytesPerIteration(kFiles * kFileSize);
+            auto buffer = std::vector<std::byte> {};
+            while (state.Running()) {
+                if (cold) {
+                    state.PauseTiming();
+                    for (const auto& file : *files) DropPageCache(dir / file);
+                    state.ResumeTiming();
+                }
+                auto total = 0u;
+                for (const auto& file : *files) {
+                    const auto path = dir / file;
+                    if (!fs::exists(path)) continue;
+                    auto stream = std::ifstream {path, std::ios::binary | std::ios::ate};
+                    buffer.resize(static_cast<std::size_t>(stream.tellg()));
+                    stream.seekg(0);
+                    stream.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+                    total += sum(buffer);
+                }
+                DoNotOptimize(total);
+            }
+        });
+
+        registry.Add(std::format("AssetArchive/Read/archive/{}", suffix), [=](BenchmarkState& state) {
+            prepare();
+            if (const auto archive = AssetArchive::Open(archive_path); !archive) {
+                state.Skip(archive.error());
+                return;
+            }
+            if (cold && !DropPageCache(archive_path)) {
+                state.Skip("page cache cannot be dropped");
+                return;
+            }
+            state.SetItemsPerIteration(kFiles);
+            state.SetBytesPerIteration(kFiles * kFileSize);
+            while (state.Running()) {
+                // mapped pages are not evicted, so cold runs reopen the archive
+                if (cold) {
+                    state.PauseTiming();
+                    DropPageCache(archive_path);
+                    state.ResumeTiming();
+                }
+                const auto archive = AssetArchive::Open(archive_path).value();
+                auto total = 0u;
+                for (const auto& file : *files) {
+                    if (const auto entry = archive->Find(file)) {
+                        if (const auto data = archive->Read(*entry)) total += sum(data->bytes);
+                    }
+                }
+                DoNotOptimize(total);
+            }
+        });
+    }
+
+    // a batch read from disk, evicted from the page cache before each
+    // iteration: one blocking read after another as Loader::Load does, or
+    // through either FileReader backend
+    constexpr auto kReads = std::size_t {512};
+    constexpr auto kReadSize = std::size_t {64 * 1024};
+    const auto reads = std::make_shared<std::vector<fs::path>>();
+    const auto prepare_reads = [=] {
+        if (!reads->empty()) return;
+        const auto read_dir = fs::temp_directory_path() / "opengl-cmake-bench-reads";
+        for (const auto& file : LooseFiles(read_dir, kReads, kReadSize)) {
+            reads->emplace_back(read_dir / file);
+        }
+    };
+
+    using Backend = FileReader::Backend;
+    const auto readers = {
+        std::pair {"sequential", std::optional<Backend> {}},
+        std::pair {"thread_pool", std::optional {Backend::kThreadPool}},
+        std::pair {"io_uring", std::optional {Backend::kIoUring}}
+    };
+    for (const auto& reader : readers) {
+        const auto name = reader.first;
+        const auto backend = reader.second;
+        registry.Add(std::format("FileReader/ReadMany/{}/cold", name), [=](BenchmarkState& state) {
+            if (backend == Backend::kIoUring && FileReader::GetBackend() != Backend::kIoUring) {
+                state.Skip("io_uring is not available");
+                return;
+            }
+            prepare_reads();
+            if (!DropPageCache(reads->front())) {
+                state.Skip("page cache cannot be dropped");
+                return;
+            }
+
+            state.SetItemsPerIteration(kReads);
+            state.SetBytesPerIteration(kReads * kReadSize);
+            auto buffer = std::vector<std::byte> {};
+            while (state.Running()) {
+                state.PauseTiming();
+                for (const auto& path : *reads) DropPageCache(path);
+                state.ResumeTiming();
+
+                auto bytes = std::size_t {0};
+                if (backend) {
+                    FileReader::ReadMany(*reads, [&bytes](std::size_t, FileBuffer read) {
+                        if (read) bytes += read->size();
+                    }, *backend);
+                } else {
+                    for (const auto& path : *reads) {
+                        auto stream = std::ifstream {path, std::ios::binary | std::ios::ate};
+                        buffer.resize(static_cast<std::size_t>(stream.tellg()));
+                        stream.seekg(0);
+                        stream.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+                        bytes += buffer.size();
+                    }
+                }
+                DoNotOptimize(bytes);
+            }
+        });
+    }
+}
+
+// recording and handing over a frame's lines, without drawing them
+auto DebugDrawBenchmarks(BenchmarkRegistry& registry) {
+    registry.Add("DebugDraw/Record/10000", [](BenchmarkState& state) {
+        auto debug = DebugDraw {};
+        auto commands = CommandList {};
+        state.SetItemsPerIteration(20000);
+        while (state.Running()) {
+            commands.Reset();
+            DebugGrid(debug, 10000);
+            debug.Submit(commands, glm::mat4 {1.0f}, 1.0 / 60.0);
+        }
+        state.SetCounter("lines", static_cast<double>(debug.GetStats().lines));
+    });
+}
+
+auto CameraBenchmarks(BenchmarkRegistry& registry) {
+    registry.Add("PerspectiveCamera/OnUpdate", [](BenchmarkState& state) {
+        auto camera = PerspectiveCamera {45.0f, 4.0f / 3.0f, 0.1f, 100.0f};
+        while (state.Running()) {
+            camera.OnUpdate();
+            DoNotOptimize(camera.View());
+        }
+    });
+
+    registry.Add("OrbitControls/Orbit", [](BenchmarkState& state) {
+        auto camera = PerspectiveCamera {45.0f, 4.0f / 3.0f, 0.1f, 100.0f};
+        auto controls = OrbitControls {&camera};
+
+        // a left-button drag, one mouse move per update
+        auto event = MouseEvent {};
+        event.type = MouseEvent::Type::ButtonPressed;
+        event.button = MouseButton::Left;
+        EventDispatcher::Get().Dispatch(event);
+        controls.OnUpdate(1.0f / 60.0f);
+
+        event.type = MouseEvent::Type::Moved;
+        while (state.Running()) {
+            event.position.x += 1.0f;
+            EventDispatcher::Get().Dispatch(event);
+            controls.OnUpdate(1.0f / 60.0f);
+            camera.OnUpdate();
+            DoNotOptimize(camera.View());
+        }
+
+        event.type = MouseEvent::Type::ButtonReleased;
+        EventDispatcher::Get().Dispatch(event);
+    });
+}
+
+} // namespace
+
+auto RegisterCpuBenchmarks(BenchmarkRegistry& registry) -> void {
+    GeometryBenchmarks(registry);
+    MeshBenchmarks(registry);
+    OcclusionBenchmarks(registry);
+    BvhBenchmarks(registry);
+    LightBenchmarks(registry);
+    EventBenchmarks(registry);
+    LoaderBenchmarks(registry);
+    DebugDrawBenchmarks(registry);
+    CameraBenchmarks(registry);
+}
\ No newline at end of file
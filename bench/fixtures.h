@@ -0,0 +1,157 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __unix__
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "core/debug_draw.h"
+#include "core/image.h"
+#include "loaders/archive_format.h"
+#include "resources/clustered_lights.h"
+
+// rolling hills, so terrain and displacement have height ranges to work with
+inline auto Heightmap(int size) {
+    const auto texels = static_cast<std::size_t>(size) * static_cast<std::size_t>(size);
+    auto data = ImageData {new unsigned char[texels * 4], [](void* data) {
+        delete[] static_cast<unsigned char*>(data);
+    }};
+    for (auto z = 0; z < size; ++z) {
+        for (auto x = 0; x < size; ++x) {
+            const auto height = 0.5f + 0.25f * std::sin(x * 0.05f) + 0.25f * std::cos(z * 0.07f);
+            const auto texel = static_cast<std::size_t>(z) * size + x;
+            for (auto channel = 0; channel < 4; ++channel) {
+                data[texel * 4 + channel] = static_cast<unsigned char>(height * 255.0f);
+            }
+        }
+    }
+    return std::make_shared<Image>(Image {{
+        .filename = "heightmap",
+        .width = size,
+        .height = size,
+        .depth = 4
+    }, std::move(data)});
+}
+
+// lights over a 100 x 100 ground around the origin, placed along a
+// low-discrepancy sequence so every run bins the same field
+inline auto ScatteredLights(std::size_t count) {
+    auto lights = std::vector<Light> {};
+    for (auto i = std::size_t {0}; i < count; ++i) {
+        const auto t = static_cast<float>(i);
+        const auto u = std::fmod(0.5f + t * 0.7548777f, 1.0f);
+        const auto v = std::fmod(0.5f + t * 0.5698403f, 1.0f);
+        lights.emplace_back(Light {
+            .position = {u * 100.0f - 50.0f, 1.0f + 2.0f * v, v * 100.0f - 50.0f},
+            .range = 3.0f + 4.0f * std::fmod(t * 0.618034f, 1.0f),
+            .color = {u, 1.0f - u, v},
+            .intensity = 4.0f
+        });
+    }
+    return lights;
+}
+
+// a box and a sphere per cell of a 100-wide grid, as bounds would be drawn
+inline auto DebugGrid(DebugDraw& debug, int count) {
+    for (auto i = 0; i < count; ++i) {
+        const auto p = glm::vec3 {static_cast<float>(i % 100) - 50.0f, 0.0f, static_cast<float>(i / 100) - 50.0f};
+        debug.Box(p, p + glm::vec3 {0.5f}, {1.0f, 1.0f, 0.0f});
+        debug.Sphere(p + glm::vec3 {0.25f}, 0.25f, {0.0f, 1.0f, 1.0f});
+    }
+}
+
+// count files of the given size under dir, each filled with its own index,
+// returned relative to dir
+inline auto LooseFiles(const std::filesystem::path& dir, std::size_t count, std::size_t size) {
+    std::filesystem::create_directories(dir);
+    auto paths = std::vector<std::filesystem::path> {};
+    auto bytes = std::string(size, '\0');
+    for (auto i = std::size_t {0}; i < count; ++i) {
+        std::ranges::fill(bytes, static_cast<char>(i));
+        const auto path = std::filesystem::path {std::format("{:04}.bin", i)};
+        auto file = std::ofstream {dir / path, std::ios::binary};
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        paths.emplace_back(path);
+    }
+    return paths;
+}
+
+// packs files under dir the way asset-packer does, without compression
+inline auto PackFiles(
+    const std::filesystem::path& dir,
+    const std::vector<std::filesystem::path>& paths,
+    const std::filesystem::path& archive
+) {
+    auto keys = std::vector<std::string> {};
+    for (const auto& path : paths) keys.emplace_back(path.generic_string());
+    std::ranges::sort(keys, {}, [](const auto& key) { return ArchiveHash(key); });
+
+    auto entries = std::vector<ArchiveEntry>(keys.size());
+    auto strings = std::string {};
+    auto offset = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    for (const auto& key : keys) strings += key;
+    offset += strings.size();
+
+    auto path_offset = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    for (auto i = std::size_t {0}; i < keys.size(); ++i) {
+        const auto size = std::filesystem::file_size(dir / keys[i]);
+        offset = (offset + kArchiveAlignment - 1) / kArchiveAlignment * kArchiveAlignment;
+        entries[i] = {
+            .hash = ArchiveHash(keys[i]),
+            .offset = offset,
+            .size = size,
+            .raw_size = size,
+            .path_offset = static_cast<std::uint32_t>(path_offset),
+            .path_size = static_cast<std::uint32_t>(keys[i].size()),
+            .format = ArchiveFormat::kRaw,
+            .flags = 0
+        };
+        offset += size;
+        path_offset += keys[i].size();
+    }
+
+    auto file = std::ofstream {archive, std::ios::binary};
+    const auto header = ArchiveHeader {
+        .magic = kArchiveMagic,
+        .version = kArchiveVersion,
+        .entry_count = static_cast<std::uint32_t>(entries.size()),
+        .reserved = 0
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(ArchiveEntry)));
+    file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+    for (auto i = std::size_t {0}; i < keys.size(); ++i) {
+        file.seekp(static_cast<std::streamoff>(entries[i].offset));
+        auto loose = std::ifstream {dir / keys[i], std::ios::binary};
+        file << loose.rdbuf();
+    }
+}
+
+// asks the OS to evict the files from the page cache, so the next read goes
+// to the disk; false where that cannot be done
+inline auto DropPageCache(const std::filesystem::path& path) {
+#ifdef __unix__
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    const auto dropped = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return dropped;
+#else
+    (void)path;
+    return false;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,336 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <array>
+#include <cmath>
+#include <format>
+#include <memory>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "core/command_list.h"
+#include "core/debug_draw.h"
+#include "core/image.h"
+#include "core/render_target.h"
+#include "core/shaders.h"
+#include "core/texture2d.h"
+#include "geometries/box_geometry.h"
+#include "geometries/mesh_processing.h"
+#include "geometries/mesh_simplifier.h"
+#include "geometries/meshlets.h"
+#include "geometries/plane_geometry.h"
+#include "resources/clustered_lights.h"
+#include "resources/terrain.h"
+#include "shaders/headers/scene_frag.h"
+#include "shaders/headers/scene_vert.h"
+
+namespace {
+
+auto SceneShader() {
+    auto shader = std::make_unique<Shaders>(std::vector<ShaderInfo> {
+        {ShaderType::kVertexShader, _SHADER_scene_vert},
+        {ShaderType::kFragmentShader, _SHADER_scene_frag}
+    });
+    ClusteredLights::SetSamplers(*shader);
+    return shader;
+}
+
+auto Finish() {
+    glFinish();
+}
+
+// close to the ground, looking across the terrain
+auto TerrainCamera() {
+    auto camera = PerspectiveCamera {60.0f, 4.0f / 3.0f, 0.5f, 4000.0f};
+    camera.transform = glm::inverse(glm::lookAt(
+        glm::vec3 {0.0f, 45.0f, 0.0f},
+        glm::vec3 {200.0f, 20.0f, 150.0f},
+        glm::vec3 {0.0f, 1.0f, 0.0f}
+    ));
+    camera.OnUpdate();
+    return camera;
+}
+
+// a displaced grid with four levels of detail
+auto LodGrid() {
+    const auto grid = PlaneGeometry::Parameters {
+        .width = 100.0f,
+        .height = 100.0f,
+        .width_segments = 128,
+        .height_segments = 128
+    };
+    auto data = PlaneGeometry::Generate(grid);
+    DisplaceVertices(data, *Heightmap(256), {.scale = 10.0f});
+    ComputeGridNormals(data, PlaneGeometry::Grid(grid));
+    GenerateLods(data, {.levels = 4});
+    return data;
+}
+
+// a finely divided box seen from a corner, so half of it faces away
+auto MeshletBox() {
+    auto data = BoxGeometry::Generate({
+        .width = 1.0f,
+        .height = 1.0f,
+        .depth = 1.0f,
+        .width_segments = 128,
+        .height_segments = 128,
+        .depth_segments = 128
+    });
+    BuildMeshlets(data, {});
+    return data;
+}
+
+// above the edge of a 100 x 100 ground, looking across it
+auto GroundCamera() {
+    auto camera = PerspectiveCamera {60.0f, 4.0f / 3.0f, 0.1f, 200.0f};
+    camera.transform = glm::inverse(glm::lookAt(
+        glm::vec3 {0.0f, 8.0f, 60.0f},
+        glm::vec3 {0.0f},
+        glm::vec3 {0.0f, 1.0f, 0.0f}
+    ));
+    camera.OnUpdate();
+    return camera;
+}
+
+auto BoxCamera() {
+    auto camera = PerspectiveCamera {60.0f, 4.0f / 3.0f, 0.1f, 100.0f};
+    camera.transform = glm::inverse(glm::lookAt(
+        glm::vec3 {2.0f, 1.5f, 2.5f},
+        glm::vec3 {0.0f},
+        glm::vec3 {0.0f, 1.0f, 0.0f}
+    ));
+    camera.OnUpdate();
+    return camera;
+}
+
+} // namespace
+
+auto RegisterGlBenchmarks(BenchmarkRegistry& registry) -> void {
+    registry.Add("Geometry/Draw", [](BenchmarkState& state) {
+        const auto shader = SceneShader();
+        shader->SetUniform("u_Projection", glm::mat4 {1.0f});
+        shader->SetUniform("u_ModelView", glm::mat4 {1.0f});
+        const auto geometry = BoxGeometry {{
+            .width = 1.0f,
+            .height = 1.0f,
+            .depth = 1.0f,
+            .width_segments = 1,
+            .height_segments = 1,
+            .depth_segments = 1
+        }};
+
+        state.SetItemsPerIteration(1);
+        while (state.Running()) {
+            geometry.Draw(*shader);
+        }
+    }, Finish);
+
+    // the cost of each level, next to its error from Mesh/GenerateLods
+    for (const auto lod : {0u, 1u, 2u, 3u}) {
+        registry.Add(std::format("Geometry/Draw/lod{}", lod), [lod](BenchmarkState& state) {
+            const auto shader = SceneShader();
+            shader->SetUniform("u_Projection", glm::mat4 {1.0f});
+            shader->SetUniform("u_ModelView", glm::scale(glm::mat4 {1.0f}, glm::vec3 {0.01f}));
+            const auto data = LodGrid();
+            const auto geometry = Geometry {data};
+            if (lod >= data.lods.size()) {
+                state.Skip("the grid has fewer levels");
+                return;
+            }
+
+            state.SetItemsPerIteration(data.lods[lod].index_count / 3);
+            while (state.Running()) {
+                geometry.Draw(*shader, lod);
+            }
+        }, Finish);
+    }
+
+    registry.Add("Geometry/SelectLod", [](BenchmarkState& state) {
+        const auto geometry = Geometry {LodGrid()};
+        const auto camera = TerrainCamera();
+        auto model = glm::mat4 {1.0f};
+        while (state.Running()) {
+            // walks the grid away from the camera so every level is chosen
+            model[3].x = model[3].x > 2000.0f ? 0.0f : model[3].x + 1.0f;
+            DoNotOptimize(geometry.SelectLod(camera, model, 1080.0f));
+        }
+    });
+
+    registry.Add("Geometry/Cull", [](BenchmarkState& state) {
+        const auto geometry = Geometry {MeshletBox()};
+        const auto camera = BoxCamera();
+        auto list = MeshletDrawList {};
+        while (state.Running()) {
+            geometry.Cull(camera, glm::mat4 {1.0f}, list);
+        }
+        state.SetItemsPerIteration(geometry.Meshlets().size());
+        state.SetCounter("culled", static_cast<double>(list.culled) / static_cast<double>(geometry.Meshlets().size()));
+    });
+
+    // triangles submitted with and without culling the meshlets
+    for (const auto cull : {false, true}) {
+        registry.Add(std::format("Geometry/Draw/box/{}", cull ? "meshlets" : "whole"), [cull](BenchmarkState& state) {
+            const auto shader = SceneShader();
+            const auto camera = BoxCamera();
+            shader->SetUniform("u_Projection", camera.Projection());
+            shader->SetUniform("u_ModelView", camera.View());
+            const auto data = MeshletBox();
+            const auto geometry = Geometry {data};
+            auto list = MeshletDrawList {};
+
+            while (state.Running()) {
+                if (cull) {
+                    geometry.Cull(camera, glm::mat4 {1.0f}, list);
+                    geometry.Draw(*shader, list);
+                } else {
+                    geometry.Draw(*shader);
+                }
+            }
+            const auto triangles = cull ? list.triangles : data.index_data.size() / 3;
+            state.SetItemsPerIteration(triangles);
+            state.SetCounter("triangles", static_cast<double>(triangles));
+        }, Finish);
+    }
+
+    // the light loop of every fragment over the ground, with its lights
+    // binned or not
+    for (const auto brute_force : {false, true}) {
+        const auto name = std::format("ClusteredLights/Draw/1024/{}", brute_force ? "brute-force" : "clustered");
+        registry.Add(name, [brute_force](BenchmarkState& state) {
+            const auto shader = SceneShader();
+            const auto camera = GroundCamera();
+            const auto ground = glm::rotate(glm::mat4 {1.0f}, glm::radians(-90.0f), glm::vec3 {1.0f, 0.0f, 0.0f});
+            const auto geometry = PlaneGeometry {{
+                .width = 100.0f,
+                .height = 100.0f,
+                .width_segments = 64,
+                .height_segments = 64
+            }};
+
+            // white, so the lights alone make the colour
+            const auto image = std::make_shared<Image>(Image {{
+                .filename = "white",
+                .width = 1,
+                .height = 1,
+                .depth = 4
+            }, ImageData {new unsigned char[4] {255, 255, 255, 255}, [](void* data) {
+                delete[] static_cast<unsigned char*>(data);
+            }}});
+            auto texture = Texture2D {image};
+
+            auto lighting = ClusteredLights {{}};
+            lighting.lights = ScatteredLights(1024);
+            lighting.brute_force = brute_force;
+
+            auto commands = CommandList {};
+            glEnable(GL_DEPTH_TEST);
+            while (state.Running()) {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                commands.Reset();
+                lighting.Submit(commands, camera, *shader);
+                commands.Execute();
+                shader->SetUniform("u_Projection", camera.Projection());
+                shader->SetUniform("u_ModelView", camera.View() * ground);
+                texture.Bind();
+                geometry.Draw(*shader);
+            }
+            glDisable(GL_DEPTH_TEST);
+            state.SetCounter("bin_ms", lighting.GetStats().bin_ms);
+        }, Finish);
+    }
+
+    // upload and draw of the lines DebugDraw/Record makes
+    registry.Add("DebugDraw/Draw/10000", [](BenchmarkState& state) {
+        auto debug = DebugDraw {};
+        auto commands = CommandList {};
+        const auto camera = GroundCamera();
+        state.SetItemsPerIteration(20000);
+        while (state.Running()) {
+            commands.Reset();
+            DebugGrid(debug, 10000);
+            debug.Submit(commands, camera.Projection() * camera.View(), 1.0 / 60.0);
+            commands.Execute();
+        }
+    }, Finish);
+
+    // what dynamic resolution adds to every frame: stretching the scene over
+    // the window, or copying it at full scale
+    for (const auto scale : {0.5f, 1.0f}) {
+        registry.Add(std::format("RenderTarget/Upscale/{}", scale), [scale](BenchmarkState& state) {
+            auto viewport = std::array<GLint, 4> {};
+            glGetIntegerv(GL_VIEWPORT, viewport.data());
+            auto window = GLint {0};
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &window);
+
+            auto target = RenderTarget {};
+            target.Resize(
+                static_cast<int>(std::lround(viewport[2] * scale)),
+                static_cast<int>(std::lround(viewport[3] * scale))
+            );
+            target.Bind();
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            state.SetItemsPerIteration(static_cast<std::size_t>(viewport[2]) * viewport[3]);
+            while (state.Running()) {
+                target.BlitTo(static_cast<GLuint>(window), viewport[2], viewport[3]);
+            }
+        }, Finish);
+    }
+
+    registry.Add("Shaders/SetUniform/mat4", [](BenchmarkState& state) {
+        const auto shader = SceneShader();
+        auto matrix = glm::mat4 {1.0f};
+        while (state.Running()) {
+            matrix[3][0] += 1.0f;
+            shader->SetUniform("u_ModelView", matrix);
+        }
+    }, Finish);
+
+    registry.Add("Texture2D/Upload/512", [](BenchmarkState& state) {
+        constexpr auto kSize = 512;
+        constexpr auto kBytes = std::size_t {kSize * kSize * 4};
+        const auto image = std::make_shared<Image>(Image {{
+            .filename = "bench",
+            .width = kSize,
+            .height = kSize,
+            .depth = 4
+        }, ImageData {new unsigned char[kBytes] {}, [](void* data) {
+            delete[] static_cast<unsigned char*>(data);
+        }}});
+
+        auto texture = Texture2D {};
+        state.SetBytesPerIteration(kBytes);
+        while (state.Running()) {
+            // the upload happens on the first bind after SetImage
+            texture.SetImage(image);
+            texture.Bind();
+        }
+    }, Finish);
+
+    for (const auto size : {1024.0f, 16384.0f}) {
+        registry.Add(std::format("Terrain/Select/{}", size), [size](BenchmarkState& state) {
+            auto terrain = Terrain {{.size = size}, Heightmap(512)};
+            const auto camera = TerrainCamera();
+
+            while (state.Running()) {
+                terrain.Select(camera);
+            }
+            state.SetItemsPerIteration(terrain.GetStats().patches);
+        });
+
+        registry.Add(std::format("Terrain/Draw/{}", size), [size](BenchmarkState& state) {
+            auto terrain = Terrain {{.size = size}, Heightmap(512)};
+            const auto camera = TerrainCamera();
+
+            while (state.Running()) {
+                terrain.Draw(camera);
+            }
+            state.SetItemsPerIteration(terrain.GetStats().triangles);
+        }, Finish);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "bench.h"
+
+#ifdef HEADLESS_ENABLED
+    #include <glad/glad.h>
+
+    #include "core/headless_window.h"
+#endif
+
+auto GetOption(std::span<char*> args, std::string_view name) -> std::optional<std::string> {
+    for (auto i = std::size_t {1}; i + 1 < args.size(); ++i) {
+        if (args[i] == name) return args[i + 1];
+    }
+    return std::nullopt;
+}
+
+auto HasFlag(std::span<char*> args, std::string_view name) {
+    const auto options = args.subspan(1);
+    return std::ranges::find(options, name) != end(options);
+}
+
+// usage: opengl-cmake-bench [--filter <text>] [--json <file>] [--label <text>]
+//                           [--min-time <ms>] [--repetitions <n>] [--no-gl]
+auto main(int argc, char* argv[]) -> int {
+    const auto args = std::span {argv, static_cast<std::size_t>(argc)};
+
+    auto registry = BenchmarkRegistry {};
+    RegisterCpuBenchmarks(registry);
+
+    auto context = BenchmarkContext {
+        .label = GetOption(args, "--label").value_or(""),
+        #ifdef NDEBUG
+            .build_type = "release",
+        #else
+            .build_type = "debug",
+        #endif
+        .gl_renderer = ""
+    };
+
+    #ifdef HEADLESS_ENABLED
+        // GL benchmarks need a context; without a GPU, Mesa's llvmpipe works
+        auto window = std::unique_ptr<HeadlessWindow> {nullptr};
+        if (!HasFlag(args, "--no-gl")) {
+            window = std::make_unique<HeadlessWindow>(HeadlessWindow::Parameters {
+                .width = 256,
+                .height = 256,
+                .frames = 0,
+                .timestep = 1.0 / 60.0
+            });
+            if (window->IsValid()) {
+                context.gl_renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+                RegisterGlBenchmarks(registry);
+            } else {
+                std::cerr << "No GL context, skipping GL benchmarks\n";
+            }
+        }
+    #else
+        std::cerr << "Built without headless support, skipping GL benchmarks\n";
+    #endif
+
+    auto options = BenchmarkOptions {};
+    if (auto min_time = GetOption(args, "--min-time")) {
+        options.min_time = std::chrono::milliseconds {std::atoi(min_time->c_str())};
+    }
+    if (auto repetitions = GetOption(args, "--repetitions")) {
+        options.repetitions = static_cast<std::uint32_t>(std::atoi(repetitions->c_str()));
+    }
+
+    const auto filter = GetOption(args, "--filter").value_or("");
+
+    std::cout << std::format(
+        "{:<36} {:>17} {:>17} {:>17} {:>12}\n",
+        "benchmark", "median", "min", "max", "iterations"
+    );
+
+    auto results = std::vector<BenchmarkResult> {};
+    for (const auto& benchmark : registry.Benchmarks()) {
+        if (!benchmark.name.contains(filter)) continue;
+        results.emplace_back(RunBenchmark(benchmark, options));
+        WriteTable(std::cout, results.back());
+    }
+
+    if (auto path = GetOption(args, "--json")) {
+        auto stream = std::ofstream {path.value(), std::ios::trunc};
+        WriteJson(stream, context, results);
+        if (!stream) {
+            std::cerr << std::format("Failed to write '{}'\n", path.value());
+            return 1;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "core/geometry.h"
+#include "core/image.h"
+#include "geometries/mesh_processing.h"
+
+// Plain per-vertex versions of the mesh processing kernels, which the
+// benchmarks compare against for speed and the tests for results.
+
+inline auto ReferenceDisplace(GeometryData& data, const Image& image, float scale) {
+    const auto width = static_cast<int>(image.width);
+    const auto height = static_cast<int>(image.height);
+    const auto texel = [&](int x, int y) {
+        return static_cast<float>(image.Data()[(y * width + x) * 4]);
+    };
+
+    for (auto i = std::size_t {0}; i < data.vertex_data.size(); i += 8) {
+        auto* vertex = &data.vertex_data[i];
+        const auto x = std::clamp(vertex[6] * (width - 1), 0.0f, width - 1.0f);
+        const auto y = std::clamp(vertex[7] * (height - 1), 0.0f, height - 1.0f);
+        const auto x0 = static_cast<int>(x);
+        const auto y0 = static_cast<int>(y);
+        const auto x1 = std::min(x0 + 1, width - 1);
+        const auto y1 = std::min(y0 + 1, height - 1);
+        const auto top = glm::mix(texel(x0, y0), texel(x1, y0), x - x0);
+        const auto bottom = glm::mix(texel(x0, y1), texel(x1, y1), x - x0);
+        const auto offset = glm::mix(top, bottom, y - y0) * scale / 255.0f;
+        for (auto axis = 0; axis < 3; ++axis) vertex[axis] += vertex[axis + 3] * offset;
+    }
+}
+
+inline auto ReferenceFrame(GeometryData& data, std::size_t i, glm::vec3 normal, glm::vec3 tangent, glm::vec3 bitangent) {
+    normal = glm::normalize(normal);
+    tangent = glm::normalize(tangent - normal * glm::dot(normal, tangent));
+    const auto w = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+    for (auto axis = 0; axis < 3; ++axis) {
+        data.vertex_data[i * 8 + 3 + axis] = normal[axis];
+        data.tangent_data[i * 4 + axis] = tangent[axis];
+    }
+    data.tangent_data[i * 4 + 3] = w;
+}
+
+inline auto ReferenceGridNormals(GeometryData& data, const GridLayout& grid) {
+    const auto columns = static_cast<int>(grid.columns);
+    const auto rows = static_cast<int>(grid.rows);
+    data.tangent_data.resize(data.vertex_data.size() / 2);
+
+    const auto position = [&](int x, int y) {
+        const auto* vertex = &data.vertex_data[(std::clamp(y, 0, rows - 1) * columns + std::clamp(x, 0, columns - 1)) * 8];
+        return glm::vec3 {vertex[0], vertex[1], vertex[2]};
+    };
+    const auto u_sign = data.vertex_data[14] < data.vertex_data[6] ? -1.0f : 1.0f;
+    const auto v_sign = data.vertex_data[columns * 8 + 7] < data.vertex_data[7] ? -1.0f : 1.0f;
+
+    for (auto y = 0; y < rows; ++y) {
+        for (auto x = 0; x < columns; ++x) {
+            const auto i = static_cast<std::size_t>(y * columns + x);
+            const auto along_row = position(x + 1, y) - position(x - 1, y);
+            const auto along_column = position(x, y + 1) - position(x, y - 1);
+            const auto* old = &data.vertex_data[i * 8 + 3];
+            auto normal = glm::cross(along_row, along_column);
+            if (glm::dot(normal, glm::vec3 {old[0], old[1], old[2]}) < 0.0f) normal = -normal;
+            ReferenceFrame(data, i, normal, along_row * u_sign, along_column * v_sign);
+        }
+    }
+}
+
+inline auto ReferenceNormals(GeometryData& data) {
+    const auto count = data.vertex_data.size() / 8;
+    data.tangent_data.resize(count * 4);
+    auto sums = std::vector<glm::vec3>(count * 3);
+
+    const auto& indices = data.index_data;
+    for (auto t = std::size_t {0}; t < indices.size(); t += 3) {
+        const auto* a = &data.vertex_data[indices[t] * 8];
+        const auto* b = &data.vertex_data[indices[t + 1] * 8];
+        const auto* c = &data.vertex_data[indices[t + 2] * 8];
+        const auto edge1 = glm::vec3 {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        const auto edge2 = glm::vec3 {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        const auto du1 = b[6] - a[6];
+        const auto dv1 = b[7] - a[7];
+        const auto du2 = c[6] - a[6];
+        const auto dv2 = c[7] - a[7];
+
+        const auto normal = glm::cross(edge1, edge2);
+        const auto determinant = du1 * dv2 - du2 * dv1;
+        const auto weight = std::abs(determinant) < 1e-12f ? 0.0f : glm::length(normal) / determinant;
+        const auto tangent = (edge1 * dv2 - edge2 * dv1) * weight;
+        const auto bitangent = (edge2 * du1 - edge1 * du2) * weight;
+        for (auto corner = 0; corner < 3; ++corner) {
+            auto* sum = &sums[indices[t + corner] * 3];
+            sum[0] += normal;
+            sum[1] += tangent;
+            sum[2] += bitangent;
+        }
+    }
+
+    for (auto i = std::size_t {0}; i < count; ++i) {
+        ReferenceFrame(data, i, sums[i * 3], sums[i * 3 + 1], sums[i * 3 + 2]);
+    }
+}
\ No newline at end of file
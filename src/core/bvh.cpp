@@ -0,0 +1,213 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "core/bvh.h"
+
+#include <bit>
+
+#include "core/worker_pool.h"
+
+namespace {
+
+constexpr auto kBins = 16;
+constexpr auto kTraversalCost = 1.0f; // against 1 for testing an item
+constexpr auto kMaxDepth = 48u;       // well inside the traversal stack
+constexpr auto kParallelItems = 16384u;
+
+using Bounds = Bvh::Bounds;
+using Node = Bvh::Node;
+
+// a subtree left for a worker thread
+struct Subtree {
+    unsigned node;
+    unsigned begin;
+    unsigned end;
+    unsigned depth;
+    std::vector<Node> nodes {};
+};
+
+// an item and its bounds, moved around as the tree is split so every pass
+// reads them in order
+struct Primitive {
+    Bounds bounds;
+    glm::vec3 centroid;
+    unsigned item;
+};
+
+struct Builder {
+    std::span<Primitive> primitives;
+    unsigned max_leaf_size;
+    std::vector<Node>& nodes;
+
+    // when set, subtrees at split_depth are queued instead of built
+    std::vector<Subtree>* subtrees {nullptr};
+    unsigned split_depth {0};
+
+    auto Build(unsigned node, unsigned begin, unsigned end, unsigned depth) -> void {
+        if (subtrees && depth == split_depth) {
+            subtrees->emplace_back(node, begin, end, depth);
+            return;
+        }
+
+        auto node_bounds = Bounds {};
+        auto centroid_bounds = Bounds {};
+        for (auto i = begin; i < end; ++i) {
+            node_bounds.Grow(primitives[i].bounds);
+            centroid_bounds.Grow({primitives[i].centroid, primitives[i].centroid});
+        }
+        nodes[node] = {node_bounds, begin, end - begin};
+
+        const auto count = end - begin;
+        if (count <= 1 || depth >= kMaxDepth) return;
+
+        // all three axes are binned in one pass
+        const auto extent = centroid_bounds.max - centroid_bounds.min;
+        const auto scale = glm::vec3 {
+            extent.x > 0.0f ? kBins / extent.x : 0.0f,
+            extent.y > 0.0f ? kBins / extent.y : 0.0f,
+            extent.z > 0.0f ? kBins / extent.z : 0.0f
+        };
+        auto bin_bounds = std::array<std::array<Bounds, kBins>, 3> {};
+        auto bin_counts = std::array<std::array<unsigned, kBins>, 3> {};
+        for (auto i = begin; i < end; ++i) {
+            for (auto axis = 0; axis < 3; ++axis) {
+                const auto bin = Bin(primitives[i], axis, centroid_bounds.min[axis], scale[axis]);
+                bin_bounds[axis][bin].Grow(primitives[i].bounds);
+                ++bin_counts[axis][bin];
+            }
+        }
+
+        auto best_cost = std::numeric_limits<float>::max();
+        auto best_axis = -1;
+        auto best_bin = 0;
+        for (auto axis = 0; axis < 3; ++axis) {
+            if (scale[axis] == 0.0f) continue;
+
+            // costs of splitting after each bin, from both ends
+            auto left_costs = std::array<float, kBins - 1> {};
+            auto left = Bounds {};
+            auto left_count = 0u;
+            for (auto bin = 0; bin < kBins - 1; ++bin) {
+                left.Grow(bin_bounds[axis][bin]);
+                left_count += bin_counts[axis][bin];
+                left_costs[bin] = left_count > 0 ? left.Area() * static_cast<float>(left_count) : 0.0f;
+            }
+            auto right = Bounds {};
+            auto right_count = 0u;
+            for (auto bin = kBins - 1; bin > 0; --bin) {
+                right.Grow(bin_bounds[axis][bin]);
+                right_count += bin_counts[axis][bin];
+                const auto cost = left_costs[bin - 1] + right.Area() * static_cast<float>(right_count);
+                if (right_count > 0 && right_count < count && cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = bin;
+                }
+            }
+        }
+
+        auto middle = begin + count / 2;
+        if (best_axis >= 0) {
+            // a leaf is cheaper when every ray reaching the node would pay
+            // more to descend than to test all of its items
+            const auto area = node_bounds.Area();
+            if (count <= max_leaf_size && kTraversalCost * area + best_cost >= static_cast<float>(count) * area) return;
+
+            const auto split = std::partition(
+                primitives.begin() + begin,
+                primitives.begin() + end,
+                [&](const Primitive& primitive) {
+                    return Bin(primitive, best_axis, centroid_bounds.min[best_axis], scale[best_axis]) < best_bin;
+                }
+            );
+            middle = static_cast<unsigned>(split - primitives.begin());
+        } else if (count <= max_leaf_size) {
+            return; // every centroid is in the same place
+        }
+
+        const auto child = static_cast<unsigned>(nodes.size());
+        nodes.resize(nodes.size() + 2);
+        nodes[node].first = child;
+        nodes[node].count = 0;
+        Build(child, begin, middle, depth + 1);
+        Build(child + 1, middle, end, depth + 1);
+    }
+
+    static auto Bin(const Primitive& primitive, int axis, float min, float scale) -> int {
+        return std::min(static_cast<int>((primitive.centroid[axis] - min) * scale), kBins - 1);
+    }
+};
+
+} // namespace
+
+Bvh::Bvh(std::span<const Bounds> items, const BvhParameters& params) {
+    if (items.empty()) return;
+
+    auto primitives = std::vector<Primitive>(items.size());
+    for (auto i = std::size_t {0}; i < items.size(); ++i) {
+        primitives[i] = {items[i], (items[i].min + items[i].max) * 0.5f, static_cast<unsigned>(i)};
+    }
+    nodes_.reserve(items.size() / std::max(params.max_leaf_size / 2, 1u) * 2 + 1);
+    nodes_.emplace_back();
+
+    auto builder = Builder {
+        .primitives = primitives,
+        .max_leaf_size = std::max(params.max_leaf_size, 1u),
+        .nodes = nodes_
+    };
+    const auto count = static_cast<unsigned>(items.size());
+    auto& pool = WorkerPool::Get();
+    const auto workers = static_cast<unsigned>(pool.Concurrency());
+    const auto finish = [&] {
+        items_.resize(primitives.size());
+        for (auto i = std::size_t {0}; i < primitives.size(); ++i) items_[i] = primitives[i].item;
+    };
+    if (!params.parallel || workers == 1 || count < kParallelItems) {
+        builder.Build(0, 0, count, 0);
+        finish();
+        return;
+    }
+
+    // the top of the tree is split on this thread, then a few subtrees per
+    // worker are built separately, since they are uneven
+    auto subtrees = std::vector<Subtree> {};
+    builder.subtrees = &subtrees;
+    builder.split_depth = static_cast<unsigned>(std::bit_width(workers - 1)) + 2;
+    builder.Build(0, 0, count, 0);
+
+    pool.Run(subtrees.size(), [&](std::size_t i) {
+        auto& subtree = subtrees[i];
+        subtree.nodes.emplace_back();
+        auto local = Builder {
+            .primitives = primitives,
+            .max_leaf_size = builder.max_leaf_size,
+            .nodes = subtree.nodes
+        };
+        local.Build(0, subtree.begin, subtree.end, subtree.depth);
+    });
+
+    // each subtree's root replaces its placeholder and the rest is appended,
+    // so children still come after their parents, as Refit expects
+    for (auto& subtree : subtrees) {
+        const auto base = static_cast<unsigned>(nodes_.size()) - 1;
+        for (auto& node : subtree.nodes) {
+            if (node.count == 0) node.first += base;
+        }
+        nodes_[subtree.node] = subtree.nodes.front();
+        nodes_.insert(nodes_.end(), subtree.nodes.begin() + 1, subtree.nodes.end());
+    }
+    finish();
+}
+
+auto Bvh::Refit(std::span<const Bounds> items) -> void {
+    for (auto i = nodes_.size(); i-- > 0;) {
+        auto& node = nodes_[i];
+        node.bounds = {};
+        if (node.count > 0) {
+            for (auto j = node.first; j < node.first + node.count; ++j) node.bounds.Grow(items[items_[j]]);
+        } else {
+            node.bounds.Grow(nodes_[node.first].bounds);
+            node.bounds.Grow(nodes_[node.first + 1].bounds);
+        }
+    }
+}
\ No newline at end of file
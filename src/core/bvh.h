@@ -0,0 +1,173 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "core/frustum.h"
+#include "core/ray.h"
+
+struct BvhParameters {
+    unsigned max_leaf_size {8};
+    bool parallel {true}; // builds subtrees on the shared worker pool
+};
+
+// Bounding volume hierarchy over boxes, which may be triangles or whole
+// objects. The tree is split where the surface area heuristic estimates the
+// cheapest ray tests, choosing among 16 bins per axis. Items are referred to
+// by their index in the span given to the constructor:
+//
+//   auto bvh = Bvh {bounds, {}};
+//   bvh.Query(frustum, [&](unsigned item) { ... });
+//   auto hit = bvh.Raycast(ray, max_distance, [&](unsigned item, float nearest) {
+//       return IntersectItem(item, ray, nearest); // std::optional<float>
+//   });
+//
+// Refit keeps the tree and only moves its bounds, which is enough for items
+// that move a little each frame; rebuild when they have moved far.
+class Bvh {
+public:
+    struct Bounds {
+        glm::vec3 min {std::numeric_limits<float>::max()};
+        glm::vec3 max {std::numeric_limits<float>::lowest()};
+
+        auto Grow(const Bounds& other) {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        [[nodiscard]] auto Empty() const { return min.x > max.x; }
+
+        [[nodiscard]] auto Area() const {
+            const auto size = glm::max(max - min, glm::vec3 {0.0f});
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+    };
+
+    // inner nodes have count 0 and their children at first and first + 1;
+    // leaves hold items()[first, first + count)
+    struct Node {
+        Bounds bounds;
+        unsigned first;
+        unsigned count;
+    };
+
+    Bvh() = default;
+
+    Bvh(std::span<const Bounds> items, const BvhParameters& params);
+
+    auto Refit(std::span<const Bounds> items) -> void;
+
+    [[nodiscard]] auto Empty() const { return nodes_.empty(); }
+
+    // an empty box when there are no items
+    [[nodiscard]] auto Root() const -> Bounds { return nodes_.empty() ? Bounds {} : nodes_.front().bounds; }
+
+    [[nodiscard]] auto Nodes() const -> const std::vector<Node>& { return nodes_; }
+
+    [[nodiscard]] auto Items() const -> const std::vector<unsigned>& { return items_; }
+
+    // visit(item) for every item whose box overlaps the given one
+    template <typename Visit>
+    auto Query(const glm::vec3& min, const glm::vec3& max, Visit&& visit) const {
+        Traverse(
+            [&](const Bounds& bounds) {
+                return glm::all(glm::lessThanEqual(bounds.min, max)) && glm::all(glm::lessThanEqual(min, bounds.max));
+            },
+            visit
+        );
+    }
+
+    // visit(item) for every item that may be inside the frustum
+    template <typename Visit>
+    auto Query(const Frustum& frustum, Visit&& visit) const {
+        Traverse([&](const Bounds& bounds) { return frustum.IntersectsBox(bounds.min, bounds.max); }, visit);
+    }
+
+    // the nearest hit, where intersect(item, nearest) returns the distance to
+    // the item, or nothing when it is missed or further than nearest
+    template <typename Intersect>
+    auto Raycast(const Ray& ray, float max_distance, Intersect&& intersect) const -> std::optional<RayHit> {
+        if (nodes_.empty()) return std::nullopt;
+
+        const auto inverse = 1.0f / ray.direction;
+        auto nearest = max_distance;
+        auto hit = std::optional<unsigned> {};
+
+        auto stack = std::array<unsigned, kStackSize> {};
+        auto size = std::size_t {0};
+        if (Slab(nodes_.front().bounds, ray.origin, inverse, nearest) < nearest) stack[size++] = 0;
+
+        while (size > 0) {
+            const auto& node = nodes_[stack[--size]];
+            if (node.count > 0) {
+                for (auto i = node.first; i < node.first + node.count; ++i) {
+                    if (const auto distance = intersect(items_[i], nearest); distance && *distance < nearest) {
+                        nearest = *distance;
+                        hit = items_[i];
+                    }
+                }
+                continue;
+            }
+
+            // the nearer child is visited first, so the other is often skipped
+            auto near_child = node.first;
+            auto far_child = node.first + 1;
+            auto near_distance = Slab(nodes_[near_child].bounds, ray.origin, inverse, nearest);
+            auto far_distance = Slab(nodes_[far_child].bounds, ray.origin, inverse, nearest);
+            if (far_distance < near_distance) {
+                std::swap(near_child, far_child);
+                std::swap(near_distance, far_distance);
+            }
+            if (far_distance < nearest) stack[size++] = far_child;
+            if (near_distance < nearest) stack[size++] = near_child;
+        }
+
+        if (!hit) return std::nullopt;
+        return RayHit {nearest, ray.At(nearest), *hit};
+    }
+
+private:
+    // deeper than any tree the build produces
+    static constexpr auto kStackSize = std::size_t {64};
+
+    std::vector<Node> nodes_ {};
+    std::vector<unsigned> items_ {};
+
+    // distance to the box along the ray, or infinity when it is missed
+    static auto Slab(const Bounds& bounds, const glm::vec3& origin, const glm::vec3& inverse, float max_distance) {
+        const auto t0 = (bounds.min - origin) * inverse;
+        const auto t1 = (bounds.max - origin) * inverse;
+        const auto near = glm::min(t0, t1);
+        const auto far = glm::max(t0, t1);
+        const auto enter = std::max({near.x, near.y, near.z, 0.0f});
+        const auto exit = std::min({far.x, far.y, far.z, max_distance});
+        return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+    }
+
+    template <typename Overlaps, typename Visit>
+    auto Traverse(const Overlaps& overlaps, Visit& visit) const {
+        if (nodes_.empty()) return;
+        auto stack = std::array<unsigned, kStackSize> {};
+        auto size = std::size_t {0};
+        stack[size++] = 0;
+        while (size > 0) {
+            const auto& node = nodes_[stack[--size]];
+            if (!overlaps(node.bounds)) continue;
+            if (node.count > 0) {
+                for (auto i = node.first; i < node.first + node.count; ++i) visit(items_[i]);
+            } else {
+                stack[size++] = node.first + 1;
+                stack[size++] = node.first;
+            }
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "command_list.h"
+
+#include <glad/glad.h>
+
+#include "core/geometry.h"
+#include "core/shaders.h"
+#include "core/texture2d.h"
+
+template <typename... Ts>
+struct Overloaded : Ts... { using Ts::operator()...; };
+
+auto CommandList::Execute() const -> void {
+    for (const auto& command : commands_) {
+        std::visit(Overloaded {
+            [](const Clear& clear) {
+                glClearColor(clear.color.x, clear.color.y, clear.color.z, clear.color.w);
+                glClear(clear.depth ? GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT);
+            },
+            [](const SetUniform& uniform) {
+                std::visit([&uniform](const auto& value) {
+                    uniform.shader->SetUniform(uniform.name, value);
+                }, uniform.value);
+            },
+            [](const BindTexture& bind) {
+                bind.texture->Bind();
+            },
+            [](const Draw& draw) {
+                draw.geometry->Draw(*draw.shader, draw.lod);
+            },
+            [](const Callback& callback) {
+                callback.function();
+            }
+        }, command);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Geometry;
+class Shaders;
+class Texture2D;
+
+using UniformValue = std::variant<int, float, glm::vec3, glm::mat3, glm::mat4>;
+
+// GL-agnostic record of a frame's rendering. Recording only copies values and
+// non-owning handles, so it can happen on any thread; Execute replays the
+// commands on the thread that owns the GL context. Handles and uniform names
+// must outlive the list.
+class CommandList {
+public:
+    struct Clear {
+        glm::vec4 color;
+        bool depth;
+    };
+
+    struct SetUniform {
+        const Shaders* shader;
+        std::string_view name;
+        UniformValue value;
+    };
+
+    struct BindTexture {
+        Texture2D* texture;
+    };
+
+    struct Draw {
+        const Geometry* geometry;
+        const Shaders* shader;
+        std::size_t lod;
+    };
+
+    // for renderers that issue their own GL calls, such as Terrain; state the
+    // function needs should be captured by value when recording
+    struct Callback {
+        std::function<void()> function;
+    };
+
+    using Command = std::variant<Clear, SetUniform, BindTexture, Draw, Callback>;
+
+    auto AddClear(const glm::vec4& color, bool depth = true) {
+        commands_.emplace_back(Clear {color, depth});
+    }
+
+    auto AddUniform(const Shaders& shader, std::string_view name, const UniformValue& value) {
+        commands_.emplace_back(SetUniform {&shader, name, value});
+    }
+
+    auto AddBindTexture(Texture2D& texture) {
+        commands_.emplace_back(BindTexture {&texture});
+    }
+
+    auto AddDraw(const Geometry& geometry, const Shaders& shader, std::size_t lod = 0) {
+        commands_.emplace_back(Draw {&geometry, &shader, lod});
+    }
+
+    auto AddCallback(std::function<void()> function) {
+        commands_.emplace_back(Callback {std::move(function)});
+    }
+
+    // keeps the capacity, so recording a similar frame does not allocate
+    auto Reset() { commands_.clear(); }
+
+    auto Execute() const -> void;
+
+    [[nodiscard]] auto Size() const { return commands_.size(); }
+
+private:
+    std::vector<Command> commands_ {};
+};
\ No newline at end of file
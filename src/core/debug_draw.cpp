@@ -0,0 +1,233 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "core/debug_draw.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "core/render_stats.h"
+#include "shaders/headers/debug_frag.h"
+#include "shaders/headers/debug_vert.h"
+
+namespace {
+
+constexpr auto kSegments = std::size_t {24}; // per circle
+
+auto Pack(const glm::vec3& color) {
+    const auto channel = [](float c) {
+        return static_cast<std::uint32_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return channel(color.x) | channel(color.y) << 8 | channel(color.z) << 16 | 0xffu << 24;
+}
+
+// points on the unit circle, the first repeated at the end
+auto UnitCircle() -> const std::array<std::pair<float, float>, kSegments + 1>& {
+    static const auto circle = [] {
+        auto points = std::array<std::pair<float, float>, kSegments + 1> {};
+        for (auto i = std::size_t {0}; i <= kSegments; ++i) {
+            const auto angle = 2.0f * std::numbers::pi_v<float> * static_cast<float>(i % kSegments) / kSegments;
+            points[i] = {std::cos(angle), std::sin(angle)};
+        }
+        return points;
+    }();
+    return circle;
+}
+
+} // namespace
+
+auto DebugDraw::Recycle() -> void {
+    // the batch drawn two frames ago is only cleared once recording has
+    // moved on to it, with room for as many lines as the last frame had
+    if (!submitted_) return;
+    const auto& last = batches_[current_ ^ 1];
+    for (auto list = 0; list < 2; ++list) {
+        auto& lines = batches_[current_][list];
+        lines.clear();
+        lines.reserve(last[list].size());
+    }
+    submitted_ = false;
+}
+
+auto DebugDraw::Emit(const DebugStyle& style, std::size_t count) -> std::vector<Vertex>& {
+    Recycle();
+
+    const auto list = style.depth_test ? 0 : 1;
+    if (style.lifetime > 0.0f) {
+        auto& remaining = remaining_[list];
+        remaining.insert(remaining.end(), count / 2, style.lifetime);
+        return timed_[list];
+    }
+    return batches_[current_][list];
+}
+
+auto DebugDraw::Line(const glm::vec3& a, const glm::vec3& b, const glm::vec3& color, const DebugStyle& style) -> void {
+    const auto packed = Pack(color);
+    auto& v = Emit(style, 2);
+    v.push_back({a, packed});
+    v.push_back({b, packed});
+}
+
+auto DebugDraw::Box(const glm::vec3& min, const glm::vec3& max, const glm::vec3& color, const DebugStyle& style) -> void {
+    auto corners = std::array<glm::vec3, 8> {};
+    for (auto i = 0; i < 8; ++i) {
+        corners[i] = {i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z};
+    }
+    Edges(corners, color, style);
+}
+
+auto DebugDraw::Box(
+    const glm::vec3& min,
+    const glm::vec3& max,
+    const glm::mat4& transform,
+    const glm::vec3& color,
+    const DebugStyle& style
+) -> void {
+    auto corners = std::array<glm::vec3, 8> {};
+    for (auto i = 0; i < 8; ++i) {
+        const auto corner = glm::vec4 {i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.0f};
+        corners[i] = glm::vec3 {transform * corner};
+    }
+    Edges(corners, color, style);
+}
+
+auto DebugDraw::Frustum(const glm::mat4& view_projection, const glm::vec3& color, const DebugStyle& style) -> void {
+    // the corners of clip space, back in world space
+    const auto inverse = glm::inverse(view_projection);
+    auto corners = std::array<glm::vec3, 8> {};
+    for (auto i = 0; i < 8; ++i) {
+        const auto p = inverse * glm::vec4 {i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f};
+        corners[i] = glm::vec3 {p} / p.w;
+    }
+    Edges(corners, color, style);
+}
+
+auto DebugDraw::Edges(const std::array<glm::vec3, 8>& corners, const glm::vec3& color, const DebugStyle& style) -> void {
+    // corners are numbered by their x, y and z bits; an edge joins two that
+    // differ in one
+    const auto packed = Pack(color);
+    auto& v = Emit(style, 24);
+    for (auto i = 0; i < 8; ++i) {
+        for (auto bit = 1; bit < 8; bit <<= 1) {
+            if (i & bit) continue;
+            v.push_back({corners[i], packed});
+            v.push_back({corners[i | bit], packed});
+        }
+    }
+}
+
+auto DebugDraw::Sphere(const glm::vec3& center, float radius, const glm::vec3& color, const DebugStyle& style) -> void {
+    const auto packed = Pack(color);
+    const auto& circle = UnitCircle();
+    auto& v = Emit(style, kSegments * 6);
+    for (auto i = std::size_t {0}; i < kSegments; ++i) {
+        const auto [c0, s0] = circle[i];
+        const auto [c1, s1] = circle[i + 1];
+        v.push_back({center + glm::vec3 {c0, s0, 0.0f} * radius, packed});
+        v.push_back({center + glm::vec3 {c1, s1, 0.0f} * radius, packed});
+        v.push_back({center + glm::vec3 {0.0f, c0, s0} * radius, packed});
+        v.push_back({center + glm::vec3 {0.0f, c1, s1} * radius, packed});
+        v.push_back({center + glm::vec3 {s0, 0.0f, c0} * radius, packed});
+        v.push_back({center + glm::vec3 {s1, 0.0f, c1} * radius, packed});
+    }
+}
+
+auto DebugDraw::Axes(const glm::mat4& transform, float size, const DebugStyle& style) -> void {
+    const auto origin = glm::vec3 {transform[3]};
+    Line(origin, origin + glm::vec3 {transform[0]} * size, {1.0f, 0.0f, 0.0f}, style);
+    Line(origin, origin + glm::vec3 {transform[1]} * size, {0.0f, 1.0f, 0.0f}, style);
+    Line(origin, origin + glm::vec3 {transform[2]} * size, {0.0f, 0.0f, 1.0f}, style);
+}
+
+auto DebugDraw::Submit(CommandList& commands, const glm::mat4& view_projection, double delta) -> void {
+    Recycle();
+
+    auto& batch = batches_[current_];
+    stats_ = {};
+    for (auto list = 0; list < 2; ++list) {
+        batch[list].insert(batch[list].end(), timed_[list].begin(), timed_[list].end());
+        stats_.lines += batch[list].size() / 2;
+
+        // lines that outlive this frame move down over the expired ones
+        auto& remaining = remaining_[list];
+        auto& timed = timed_[list];
+        auto kept = std::size_t {0};
+        for (auto line = std::size_t {0}; line < remaining.size(); ++line) {
+            remaining[line] -= static_cast<float>(delta);
+            if (remaining[line] <= 0.0f) continue;
+            remaining[kept] = remaining[line];
+            timed[kept * 2] = timed[line * 2];
+            timed[kept * 2 + 1] = timed[line * 2 + 1];
+            ++kept;
+        }
+        remaining.resize(kept);
+        timed.resize(kept * 2);
+        stats_.timed += kept;
+    }
+
+    if (stats_.lines > 0) {
+        commands.AddCallback([this, &batch, view_projection] { Draw(batch, view_projection); });
+    }
+    current_ ^= 1;
+    submitted_ = true;
+}
+
+auto DebugDraw::Draw(const Batch& batch, const glm::mat4& view_projection) -> void {
+    if (vao_ == 0) {
+        shader_ = std::make_unique<Shaders>(std::vector<ShaderInfo> {
+            {ShaderType::kVertexShader, _SHADER_debug_vert},
+            {ShaderType::kFragmentShader, _SHADER_debug_frag}
+        });
+
+        glGenVertexArrays(1, &vao_);
+        glBindVertexArray(vao_);
+        glGenBuffers(1, &vbo_);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(
+            1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+            reinterpret_cast<void*>(offsetof(Vertex, color))
+        );
+    } else {
+        glBindVertexArray(vao_);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    }
+    RENDER_STATS_ADD(vao_binds, 1);
+
+    // respecified each frame so the driver can hand out fresh storage; the
+    // size only grows, so it usually matches the storage it recycles
+    const auto& [depth, overlay] = batch;
+    const auto bytes = (depth.size() + overlay.size()) * sizeof(Vertex);
+    capacity_ = std::max(bytes, capacity_);
+    glBufferData(GL_ARRAY_BUFFER, capacity_, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, depth.size() * sizeof(Vertex), depth.data());
+    glBufferSubData(GL_ARRAY_BUFFER, depth.size() * sizeof(Vertex), overlay.size() * sizeof(Vertex), overlay.data());
+    RENDER_STATS_ADD(buffer_bytes, bytes);
+
+    shader_->SetUniform("u_ViewProjection", view_projection);
+    if (!depth.empty()) {
+        glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(depth.size()));
+        RENDER_STATS_ADD(draw_calls, 1);
+    }
+    if (!overlay.empty()) {
+        const auto depth_test = glIsEnabled(GL_DEPTH_TEST);
+        glDisable(GL_DEPTH_TEST);
+        glDrawArrays(GL_LINES, static_cast<GLint>(depth.size()), static_cast<GLsizei>(overlay.size()));
+        if (depth_test) glEnable(GL_DEPTH_TEST);
+        RENDER_STATS_ADD(draw_calls, 1);
+    }
+    glBindVertexArray(0);
+}
+
+DebugDraw::~DebugDraw() {
+    if (vao_) {
+        glDeleteBuffers(1, &vbo_);
+        glDeleteVertexArrays(1, &vao_);
+    }
+}
\ No newline at end of file
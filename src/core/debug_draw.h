@@ -0,0 +1,113 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "core/command_list.h"
+#include "core/shaders.h"
+
+struct DebugStyle {
+    float lifetime {0.0f}; // seconds; 0 draws for this frame only
+    bool depth_test {true};  // false draws on top of the scene
+};
+
+// Immediate-mode lines for bounds, frusta, targets and the like. Every call
+// appends to the frame's batch, which Submit hands to the command list; it
+// is drawn from one streaming buffer in at most two draws, the depth-tested
+// lines and those on top:
+//
+//   debug.Box(bounds.min, bounds.max, {1.0f, 1.0f, 0.0f});
+//   debug.Axes(transform, 0.5f, {.lifetime = 2.0f, .depth_test = false});
+//   debug.Submit(commands, camera.Projection() * camera.View(), delta);
+//
+// Recording belongs to one thread, such as the simulation. Batches are
+// double buffered as the command lists are, so recording a frame never
+// touches the one being drawn, as long as every frame is submitted.
+class DebugDraw {
+public:
+    struct Stats {
+        std::size_t lines {0};  // in the last submitted frame
+        std::size_t timed {0};  // of those, lines with a lifetime left
+    };
+
+    // GL objects are created by the first draw
+    DebugDraw() = default;
+
+    // deleted copy constructors and assignment operators
+    DebugDraw(const DebugDraw&) = delete;
+    DebugDraw& operator=(const DebugDraw&) = delete;
+
+    auto Line(const glm::vec3& a, const glm::vec3& b, const glm::vec3& color, const DebugStyle& style = {}) -> void;
+
+    auto Box(const glm::vec3& min, const glm::vec3& max, const glm::vec3& color, const DebugStyle& style = {}) -> void;
+
+    // a box in the space of a transform, such as a model's bounds
+    auto Box(
+        const glm::vec3& min,
+        const glm::vec3& max,
+        const glm::mat4& transform,
+        const glm::vec3& color,
+        const DebugStyle& style = {}
+    ) -> void;
+
+    // a circle around each axis
+    auto Sphere(const glm::vec3& center, float radius, const glm::vec3& color, const DebugStyle& style = {}) -> void;
+
+    // the volume a view-projection matrix sees, such as a camera's
+    auto Frustum(const glm::mat4& view_projection, const glm::vec3& color, const DebugStyle& style = {}) -> void;
+
+    // the x, y and z axes of a transform in red, green and blue
+    auto Axes(const glm::mat4& transform, float size, const DebugStyle& style = {}) -> void;
+
+    // records the frame's lines into the command list, then ages the lines
+    // that have a lifetime
+    auto Submit(CommandList& commands, const glm::mat4& view_projection, double delta) -> void;
+
+    // of the last Submit, for the recording thread
+    [[nodiscard]] auto GetStats() const -> const Stats& { return stats_; }
+
+    ~DebugDraw();
+
+private:
+    struct Vertex {
+        glm::vec3 position;
+        std::uint32_t color; // RGBA8
+    };
+
+    // depth-tested lines, then lines on top
+    using Batch = std::array<std::vector<Vertex>, 2>;
+
+    std::array<Batch, 2> batches_ {};
+    std::size_t current_ {0};
+    bool submitted_ {false};
+
+    // lines with a lifetime, two vertices and one remaining time each
+    std::array<std::vector<Vertex>, 2> timed_ {};
+    std::array<std::vector<float>, 2> remaining_ {};
+
+    Stats stats_ {};
+
+    std::unique_ptr<Shaders> shader_ {nullptr};
+    unsigned int vao_ {0};
+    unsigned int vbo_ {0};
+    std::size_t capacity_ {0};
+
+    auto Recycle() -> void;
+
+    // the list count vertices go to, appended with push_back; timed lines
+    // get their remaining times here
+    auto Emit(const DebugStyle& style, std::size_t count) -> std::vector<Vertex>&;
+
+    auto Edges(const std::array<glm::vec3, 8>& corners, const glm::vec3& color, const DebugStyle& style) -> void;
+
+    auto Draw(const Batch& batch, const glm::mat4& view_projection) -> void;
+};
\ No newline at end of file
@@ -0,0 +1,121 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/event_dispatcher.h"
+#include "core/mpsc_queue.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+enum class EventPriority {
+    kHigh,
+    kNormal,
+    kLow
+};
+
+// Deferred, thread-safe front end to EventDispatcher. Any thread can post a
+// typed event; the render thread delivers them in Drain, higher priorities
+// first. Each priority has its own bounded queue, and posting to a full
+// queue drops the event instead of blocking the producer.
+class EventBus {
+public:
+    static constexpr auto kCapacity = std::size_t {1024};
+
+    struct Stats {
+        std::size_t posted {0};
+        std::size_t delivered {0};
+        std::size_t dropped {0};
+        std::size_t high_water {0};
+    };
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    static auto Get() -> EventBus& {
+        static auto instance = EventBus {};
+        return instance;
+    }
+
+    // safe to call from any thread; returns false if the event was dropped
+    template <typename T>
+    auto Post(T event, EventPriority priority = EventPriority::kNormal) -> bool {
+        auto& channel = channels_[static_cast<std::size_t>(priority)];
+        auto delivery = [event = std::move(event)]() {
+            EventDispatcher::Get().Dispatch(event);
+        };
+
+        if (!channel.queue.TryPush(std::move(delivery))) {
+            channel.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        channel.posted.fetch_add(1, std::memory_order_relaxed);
+        const auto depth = channel.queue.Size();
+        auto high_water = channel.high_water.load(std::memory_order_relaxed);
+        while (depth > high_water &&
+               !channel.high_water.compare_exchange_weak(high_water, depth, std::memory_order_relaxed)) {}
+
+        if (auto wake = wake_.load(std::memory_order_acquire)) wake();
+        return true;
+    }
+
+    // delivers events on the calling (render) thread; events posted by
+    // listeners while draining are delivered on the next call
+    auto Drain() -> std::size_t {
+        auto delivered = std::size_t {0};
+        for (auto& channel : channels_) {
+            for (auto pending = channel.queue.Size(); pending > 0; --pending) {
+                auto delivery = channel.queue.TryPop();
+                if (!delivery) break;
+                (*delivery)();
+                channel.delivered.fetch_add(1, std::memory_order_relaxed);
+                ++delivered;
+            }
+        }
+        return delivered;
+    }
+
+    // see MainThreadQueue::SetWakeCallback
+    auto SetWakeCallback(void (*wake)()) {
+        wake_.store(wake, std::memory_order_release);
+    }
+
+    [[nodiscard]] auto GetStats(EventPriority priority) const -> Stats {
+        const auto& channel = channels_[static_cast<std::size_t>(priority)];
+        return {
+            .posted = channel.posted.load(std::memory_order_relaxed),
+            .delivered = channel.delivered.load(std::memory_order_relaxed),
+            .dropped = channel.dropped.load(std::memory_order_relaxed),
+            .high_water = channel.high_water.load(std::memory_order_relaxed)
+        };
+    }
+
+    [[nodiscard]] auto Depth() const {
+        auto depth = std::size_t {0};
+        for (const auto& channel : channels_) {
+            depth += channel.queue.Size();
+        }
+        return depth;
+    }
+
+private:
+    struct Channel {
+        BoundedMpscQueue<std::function<void()>> queue {kCapacity};
+        std::atomic<std::size_t> posted {0};
+        std::atomic<std::size_t> dropped {0};
+        std::atomic<std::size_t> high_water {0};
+        std::atomic<std::size_t> delivered {0}; // written by Drain, read by any thread
+    };
+
+    EventBus() = default;
+    ~EventBus() = default;
+
+    std::array<Channel, 3> channels_ {};
+
+    std::atomic<void (*)()> wake_ {nullptr};
+};
\ No newline at end of file
@@ -5,13 +5,43 @@
 
 #include "events.h"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
-#include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
-using EventListener = std::function<void(Event*)>;
+using EventTypeId = std::uint32_t;
+
+namespace detail {
+
+inline auto NextEventTypeId() -> EventTypeId {
+    // types can first be used from different threads
+    static auto next = std::atomic<EventTypeId> {0};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+// dense per-type index, assigned the first time a type is used
+template <typename T>
+auto EventTypeOf() -> EventTypeId {
+    static const auto id = detail::NextEventTypeId();
+    return id;
+}
+
+template <typename T>
+using EventListener = std::function<void(const T&)>;
+
+struct ListenerHandle {
+    EventTypeId type {0};
+    std::uint32_t index {0};
+    std::uint32_t generation {0};
+
+    [[nodiscard]] auto IsValid() const { return generation != 0; }
+};
 
 class EventDispatcher {
 public:
@@ -23,42 +53,149 @@ public:
         return instance;
     }
 
-    auto AddEventListener(const std::string& name, std::weak_ptr<EventListener> listener) {
-        if (callbacks_.contains(name)) {
-            callbacks_.at(name).emplace_back(listener);
-        } else {
-            callbacks_.try_emplace(name, std::vector{listener});
-        }
+    // listeners added while an event of the same type is being dispatched
+    // start receiving events from the next dispatch
+    template <typename T>
+    auto AddEventListener(EventListener<T> listener) -> ListenerHandle {
+        return GetChannel<T>().Add(std::move(listener));
     }
 
-    auto RemoveEventListener(const std::string& name, std::shared_ptr<EventListener> listener) {
-        if (callbacks_.contains(name)) {
-            auto& callbacks = callbacks_[name];
-            std::erase_if(callbacks, [&listener](const auto& callback) {
-                if (auto c = callback.lock()) return c == listener;
-                return false;
-            });
+    // safe to call at any time, including from inside a listener
+    auto RemoveEventListener(ListenerHandle& handle) {
+        if (handle.IsValid() && handle.type < channels_.size() && channels_[handle.type]) {
+            channels_[handle.type]->Remove(handle);
         }
+        handle = {};
+    }
+
+    template <typename T>
+    auto Dispatch(const T& event) {
+        const auto id = EventTypeOf<T>();
+        if (id >= channels_.size() || !channels_[id]) return;
+        static_cast<Channel<T>*>(channels_[id].get())->Dispatch(event);
     }
 
-    auto Dispatch(const std::string& name, std::unique_ptr<Event> event) {
-        if (!callbacks_.contains(name)) {
-            return;
+private:
+    struct ChannelBase {
+        virtual auto Remove(const ListenerHandle& handle) -> void = 0;
+        virtual ~ChannelBase() = default;
+    };
+
+    // Listeners live in dense slots; a handle stays valid only while its
+    // generation matches, so stale handles are harmless. Slots are never
+    // added, reused or cleared while a dispatch is iterating over them;
+    // those changes are deferred until the outermost dispatch returns.
+    template <typename T>
+    struct Channel : ChannelBase {
+        struct Slot {
+            EventListener<T> listener;
+            std::uint32_t generation {1};
+            bool active {false};
+        };
+
+        struct Pending {
+            std::uint32_t index;
+            std::uint32_t generation;
+            EventListener<T> listener;
+        };
+
+        std::vector<Slot> slots;
+        std::vector<std::uint32_t> free_slots;
+        std::vector<Pending> pending;
+        std::vector<std::uint32_t> removed;
+        std::uint32_t reserved {0};
+        int dispatch_depth {0};
+
+        auto Add(EventListener<T> listener) -> ListenerHandle {
+            auto index = std::uint32_t {0};
+            auto generation = std::uint32_t {1};
+            if (!free_slots.empty()) {
+                index = free_slots.back();
+                free_slots.pop_back();
+                generation = slots[index].generation;
+            } else {
+                index = static_cast<std::uint32_t>(slots.size()) + reserved;
+            }
+
+            if (dispatch_depth > 0) {
+                if (index >= slots.size()) ++reserved;
+                pending.emplace_back(index, generation, std::move(listener));
+            } else {
+                Place(index, std::move(listener));
+            }
+            return {EventTypeOf<T>(), index, generation};
         }
-        auto& callbacks = callbacks_[name];
-        for (auto iter = begin(callbacks); iter != end(callbacks);) {
-            if (const auto& callback = iter->lock()) {
-                (*callback)(event.get());
-                iter++;
+
+        auto Remove(const ListenerHandle& handle) -> void override {
+            for (auto& entry : pending) {
+                if (entry.index == handle.index && entry.generation == handle.generation) {
+                    entry.listener = nullptr;
+                    return;
+                }
+            }
+
+            if (handle.index >= slots.size()) return;
+            auto& slot = slots[handle.index];
+            if (!slot.active || slot.generation != handle.generation) return;
+
+            slot.active = false;
+            if (dispatch_depth > 0) {
+                removed.emplace_back(handle.index);
             } else {
-                iter = callbacks.erase(iter); // update iter to the next valid position
+                Release(handle.index);
             }
         }
-    }
 
-private:
+        auto Dispatch(const T& event) {
+            ++dispatch_depth;
+            const auto count = slots.size();
+            for (auto i = std::size_t {0}; i < count; ++i) {
+                if (slots[i].active) slots[i].listener(event);
+            }
+            if (--dispatch_depth == 0) Flush();
+        }
+
+        auto Place(std::uint32_t index, EventListener<T> listener) -> void {
+            if (index >= slots.size()) slots.resize(index + 1);
+            slots[index].listener = std::move(listener);
+            slots[index].active = true;
+        }
+
+        auto Release(std::uint32_t index) -> void {
+            if (index >= slots.size()) slots.resize(index + 1);
+            slots[index].listener = nullptr;
+            ++slots[index].generation;
+            free_slots.emplace_back(index);
+        }
+
+        auto Flush() -> void {
+            for (auto& entry : pending) {
+                if (entry.listener) {
+                    Place(entry.index, std::move(entry.listener));
+                } else {
+                    Release(entry.index); // removed before it was placed
+                }
+            }
+            pending.clear();
+            reserved = 0;
+
+            for (auto index : removed) {
+                Release(index);
+            }
+            removed.clear();
+        }
+    };
+
     EventDispatcher() = default;
     ~EventDispatcher() = default;
 
-    std::unordered_map<std::string, std::vector<std::weak_ptr<EventListener>>> callbacks_;
-};
\ No newline at end of file
+    std::vector<std::unique_ptr<ChannelBase>> channels_;
+
+    template <typename T>
+    auto GetChannel() -> Channel<T>& {
+        const auto id = EventTypeOf<T>();
+        if (id >= channels_.size()) channels_.resize(id + 1);
+        if (!channels_[id]) channels_[id] = std::make_unique<Channel<T>>();
+        return *static_cast<Channel<T>*>(channels_[id].get());
+    }
+};
@@ -0,0 +1,81 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/event_dispatcher.h"
+#include "core/events.h"
+
+#include <array>
+#include <cstddef>
+
+// Frame-scoped input queue. Window callbacks write events by value into a
+// fixed ring and the window dispatches them in one pass per frame, so no
+// input event touches the heap. Consecutive moves are merged into one event
+// that keeps the latest position and the accumulated delta; consecutive
+// scrolls are summed.
+class EventQueue {
+public:
+    static constexpr auto kCapacity = std::size_t {256};
+
+    struct Stats {
+        std::size_t dispatched {0};
+        std::size_t coalesced {0};
+        std::size_t dropped {0};
+    };
+
+    auto Push(const MouseEvent& event) -> void {
+        using enum MouseEvent::Type;
+
+        // events that are already being dispatched are never modified
+        if (size_ > sealed_) {
+            auto& last = events_[Slot(size_ - 1)];
+            if (last.type == event.type && (event.type == Moved || event.type == Scrolled)) {
+                last.position = event.position;
+                last.delta += event.delta;
+                last.scroll += event.scroll;
+                ++stats_.coalesced;
+                return;
+            }
+        }
+
+        if (size_ == kCapacity) {
+            ++stats_.dropped;
+            return;
+        }
+        events_[Slot(size_++)] = event;
+    }
+
+    // events pushed by listeners during dispatch are kept for the next call
+    auto Dispatch() -> void {
+        sealed_ = size_;
+        for (auto i = std::size_t {0}; i < sealed_; ++i) {
+            EventDispatcher::Get().Dispatch(events_[Slot(i)]);
+        }
+
+        head_ = Slot(sealed_);
+        size_ -= sealed_;
+        stats_.dispatched += sealed_;
+        sealed_ = 0;
+    }
+
+    auto Clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    [[nodiscard]] auto Size() const { return size_; }
+
+    [[nodiscard]] auto GetStats() const -> const Stats& { return stats_; }
+
+private:
+    std::array<MouseEvent, kCapacity> events_ {};
+
+    std::size_t head_ {0};
+    std::size_t size_ {0};
+    std::size_t sealed_ {0};
+
+    Stats stats_ {};
+
+    [[nodiscard]] auto Slot(std::size_t i) const -> std::size_t { return (head_ + i) % kCapacity; }
+};
\ No newline at end of file
@@ -42,6 +42,7 @@ struct MouseEvent : public Event {
     };
 
     glm::vec2 position;
+    glm::vec2 delta;
     glm::vec2 scroll;
 
     MouseEvent::Type type;
@@ -0,0 +1,107 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+#include <GLFW/glfw3.h>
+
+static auto ThreadCpuTime() -> std::chrono::nanoseconds;
+
+FramePacer::FramePacer() : FramePacer(Parameters {}) {}
+
+FramePacer::FramePacer(const Parameters& params) : params_(params) {
+    cpu_time_start_ = ThreadCpuTime();
+}
+
+auto FramePacer::SwapInterval() const -> int {
+    switch (params_.mode) {
+        case Mode::kVsync: return 1;
+        case Mode::kAdaptiveVsync:
+            if (glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+                return -1;
+            }
+            return 1;
+        default: break;
+    }
+    return 0;
+}
+
+auto FramePacer::Wait() -> void {
+    if (params_.mode == Mode::kTargetRate && params_.target_rate > 0.0) {
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / params_.target_rate)
+        );
+
+        deadline_ += period;
+        auto now = Clock::now();
+        // when more than a frame behind, start over instead of rushing
+        // through frames to catch up
+        if (now - deadline_ > period) {
+            deadline_ = now;
+        }
+
+        if (deadline_ - now > params_.spin_threshold) {
+            std::this_thread::sleep_for(deadline_ - now - params_.spin_threshold);
+        }
+        while (Clock::now() < deadline_) {
+            std::this_thread::yield();
+        }
+    }
+
+    Record();
+}
+
+auto FramePacer::Record() -> void {
+    using namespace std::chrono;
+
+    const auto now = Clock::now();
+    samples_[sample_count_++ % kSamples] = duration<double, std::milli>(now - last_frame_).count();
+    last_frame_ = now;
+
+    // statistics are refreshed twice per second
+    const auto elapsed = now - cpu_window_start_;
+    if (elapsed < milliseconds {500}) return;
+
+    const auto count = std::min(sample_count_, kSamples);
+    const auto first = begin(samples_);
+    const auto mean = std::accumulate(first, first + count, 0.0) / count;
+    const auto variance = std::accumulate(first, first + count, 0.0, [mean](auto sum, auto sample) {
+        return sum + (sample - mean) * (sample - mean);
+    }) / count;
+
+    const auto cpu_time = ThreadCpuTime();
+
+    stats_.frame_ms = mean;
+    stats_.jitter_ms = std::sqrt(variance);
+    stats_.cpu_usage = duration<double>(cpu_time - cpu_time_start_) / duration<double>(elapsed);
+
+    cpu_time_start_ = cpu_time;
+    cpu_window_start_ = now;
+}
+
+static auto ThreadCpuTime() -> std::chrono::nanoseconds {
+#ifdef _WIN32
+    auto creation = FILETIME {}, exit = FILETIME {}, kernel = FILETIME {}, user = FILETIME {};
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    const auto ticks = (static_cast<std::uint64_t>(kernel.dwHighDateTime) << 32 | kernel.dwLowDateTime) +
+                       (static_cast<std::uint64_t>(user.dwHighDateTime) << 32 | user.dwLowDateTime);
+    return std::chrono::nanoseconds {ticks * 100};
+#else
+    auto time = timespec {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return std::chrono::seconds {time.tv_sec} + std::chrono::nanoseconds {time.tv_nsec};
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+// Limits how often the render loop runs. Vsync modes leave the waiting to
+// the swap; kTargetRate sleeps until shortly before each deadline and spins
+// for the remainder, since sleeps alone overshoot by up to a scheduler tick.
+class FramePacer {
+public:
+    enum class Mode {
+        kUnlimited,
+        kVsync,
+        kAdaptiveVsync, // vsync, but late frames tear instead of waiting
+        kTargetRate
+    };
+
+    struct Parameters {
+        Mode mode {Mode::kUnlimited};
+        double target_rate {60.0};
+        std::chrono::microseconds spin_threshold {1500};
+    };
+
+    struct Stats {
+        double frame_ms {0.0};
+        double jitter_ms {0.0}; // standard deviation of the frame time
+        double cpu_usage {0.0}; // of the render thread, 0 to 1
+    };
+
+    FramePacer();
+
+    explicit FramePacer(const Parameters& params);
+
+    // value for glfwSwapInterval
+    [[nodiscard]] auto SwapInterval() const -> int;
+
+    // call once per frame, after the buffer swap
+    auto Wait() -> void;
+
+    [[nodiscard]] auto GetParameters() const -> const Parameters& { return params_; }
+
+    [[nodiscard]] auto GetStats() const -> const Stats& { return stats_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr auto kSamples = std::size_t {120};
+
+    Parameters params_;
+
+    Stats stats_ {};
+
+    Clock::time_point deadline_ {Clock::now()};
+    Clock::time_point last_frame_ {Clock::now()};
+    Clock::time_point cpu_window_start_ {Clock::now()};
+
+    std::chrono::nanoseconds cpu_time_start_ {0};
+
+    std::array<double, kSamples> samples_ {};
+    std::size_t sample_count_ {0};
+
+    auto Record() -> void;
+};
+
+// Runs a simulation at a fixed rate regardless of the render rate. Rendering
+// then blends the last two simulated states by Alpha().
+class FixedTimestep {
+public:
+    FixedTimestep(double step, std::function<void(const double step)> update)
+      : step_(step), update_(std::move(update)) {}
+
+    // returns the number of steps taken; after a long stall the backlog is
+    // dropped rather than simulated, so a hitch cannot snowball
+    auto Advance(double delta) -> int {
+        static constexpr auto kMaxSteps = 8;
+
+        accumulator_ += delta;
+        auto steps = 0;
+        while (accumulator_ >= step_ && steps < kMaxSteps) {
+            update_(step_);
+            accumulator_ -= step_;
+            ++steps;
+        }
+        if (steps == kMaxSteps) accumulator_ = 0.0;
+        return steps;
+    }
+
+    // how far the render time is between the previous and the current step
+    [[nodiscard]] auto Alpha() const { return accumulator_ / step_; }
+
+    [[nodiscard]] auto Step() const { return step_; }
+
+private:
+    double step_;
+    double accumulator_ {0.0};
+
+    std::function<void(const double step)> update_;
+};
\ No newline at end of file
@@ -0,0 +1,53 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Per-frame timings, written as CSV when the log is destroyed so that
+// logging adds no I/O to the frame. Columns:
+//
+//   frame     frame index, matches InputRecorder frames
+//   frame_ms  wall-clock time since the previous frame
+//   work_ms   time spent in the frame's program, before the buffer swap
+class FrameTimeLog {
+public:
+    explicit FrameTimeLog(const fs::path& path) : path_(path) {}
+
+    FrameTimeLog(const FrameTimeLog&) = delete;
+    FrameTimeLog& operator=(const FrameTimeLog&) = delete;
+
+    auto Add(std::uint32_t frame, double frame_ms, double work_ms) {
+        samples_.emplace_back(frame, frame_ms, work_ms);
+    }
+
+    ~FrameTimeLog() {
+        auto stream = std::ofstream {path_, std::ios::trunc};
+        stream << "frame,frame_ms,work_ms\n";
+        for (const auto& sample : samples_) {
+            stream << std::format("{},{:.4f},{:.4f}\n", sample.frame, sample.frame_ms, sample.work_ms);
+        }
+        if (!stream) {
+            std::cerr << std::format("Failed to write frame log '{}'\n", path_.string());
+        }
+    }
+
+private:
+    struct Sample {
+        std::uint32_t frame;
+        double frame_ms;
+        double work_ms;
+    };
+
+    fs::path path_;
+
+    std::vector<Sample> samples_ {};
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "frustum.h"
+
+#include <glm/glm.hpp>
+
+Frustum::Frustum(const glm::mat4& view_projection) {
+    // rows of the matrix; glm stores columns
+    auto rows = std::array<glm::vec4, 4> {};
+    for (auto i = 0; i < 4; ++i) {
+        rows[i] = {
+            view_projection[0][i],
+            view_projection[1][i],
+            view_projection[2][i],
+            view_projection[3][i]
+        };
+    }
+
+    planes_ = {
+        rows[3] + rows[0], // left
+        rows[3] - rows[0], // right
+        rows[3] + rows[1], // bottom
+        rows[3] - rows[1], // top
+        rows[3] + rows[2], // near
+        rows[3] - rows[2]  // far
+    };
+
+    for (auto& plane : planes_) {
+        plane = plane / glm::length(glm::vec3 {plane});
+    }
+}
+
+auto Frustum::IntersectsBox(const glm::vec3& min, const glm::vec3& max) const -> bool {
+    for (const auto& plane : planes_) {
+        // the corner furthest along the plane normal
+        const auto corner = glm::vec3 {
+            plane.x >= 0.0f ? max.x : min.x,
+            plane.y >= 0.0f ? max.y : min.y,
+            plane.z >= 0.0f ? max.z : min.z
+        };
+        if (glm::dot(glm::vec3 {plane}, corner) + plane.w < 0.0f) return false;
+    }
+    return true;
+}
+
+auto Frustum::IntersectsSphere(const glm::vec3& center, float radius) const -> bool {
+    for (const auto& plane : planes_) {
+        if (glm::dot(glm::vec3 {plane}, center) + plane.w < -radius) return false;
+    }
+    return true;
+}
\ No newline at end of file
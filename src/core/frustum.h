@@ -0,0 +1,29 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <array>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+// The six planes of a view frustum, extracted from a projection * view
+// matrix. Plane normals point inwards; the tests are conservative, so a
+// shape near a corner may be reported as visible when it is not.
+class Frustum {
+public:
+    Frustum() = default;
+
+    explicit Frustum(const glm::mat4& view_projection);
+
+    [[nodiscard]] auto IntersectsBox(const glm::vec3& min, const glm::vec3& max) const -> bool;
+
+    [[nodiscard]] auto IntersectsSphere(const glm::vec3& center, float radius) const -> bool;
+
+    [[nodiscard]] auto Planes() const -> const std::array<glm::vec4, 6>& { return planes_; }
+
+private:
+    std::array<glm::vec4, 6> planes_ {};
+};
\ No newline at end of file
@@ -3,10 +3,15 @@
 
 #include "geometry.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include <glad/glad.h>
 
+#include "core/frustum.h"
+#include "core/render_stats.h"
+
 #define BUFFER_OFFSET(offset) ((void*)(offset * sizeof(GLfloat)))
 #define STRIDE(stride) (sizeof(GLfloat) * stride)
 
@@ -17,25 +22,38 @@ Geometry::Geometry(
     SetVertexData(vertex_data, index_data);
 }
 
+Geometry::Geometry(const GeometryData& data) {
+    SetVertexData(data.vertex_data, data.index_data, data.tangent_data, data.lods, data.meshlets);
+}
+
 auto Geometry::SetVertexData(
     const std::vector<float>& vertex_data,
-    const std::vector<unsigned int>& index_data
+    const std::vector<unsigned int>& index_data,
+    const std::vector<float>& tangent_data,
+    const std::vector<LodLevel>& lods,
+    const std::vector<Meshlet>& meshlets
 ) -> void {
     glGenVertexArrays(1, &vao_);
     glBindVertexArray(vao_);
 
     ConfigureVertices(vertex_data);
+    if (!tangent_data.empty()) {
+        ConfigureTangents(tangent_data);
+    }
     if (!index_data.empty()) {
-        ConfigureIndices(index_data);
+        ConfigureIndices(index_data, lods);
     }
+    ComputeBounds(vertex_data);
+    meshlets_ = meshlets;
 
     // clean-up
     glBindVertexArray(0);
     glDeleteBuffers(1, &vbo_);
+    glDeleteBuffers(1, &tangent_vbo_);
     glDeleteBuffers(1, &ebo_);
 }
 
-auto Geometry::Draw(const Shaders& shader) const -> void {
+auto Geometry::Draw(const Shaders& shader, std::size_t lod) const -> void {
     if (vao_ == 0) {
         std::cerr << "Geometry not initialized. Cannot draw." << std::endl;
         return;
@@ -43,11 +61,101 @@ auto Geometry::Draw(const Shaders& shader) const -> void {
 
     shader.Use();
     glBindVertexArray(vao_);
-    if (indices_size_ > 0) {
-        glDrawElements(GL_TRIANGLES, indices_size_, GL_UNSIGNED_INT, nullptr);
+    RENDER_STATS_ADD(vao_binds, 1);
+    RENDER_STATS_ADD(draw_calls, 1);
+    if (!lods_.empty()) {
+        const auto& level = lods_[std::min(lod, lods_.size() - 1)];
+        glDrawElements(
+            GL_TRIANGLES,
+            static_cast<GLsizei>(level.index_count),
+            GL_UNSIGNED_INT,
+            reinterpret_cast<void*>(level.index_offset * sizeof(GLuint))
+        );
+        RENDER_STATS_ADD(triangles, level.index_count / 3);
     } else {
         glDrawArrays(GL_TRIANGLES, 0, 3);
+        RENDER_STATS_ADD(triangles, 1);
+    }
+}
+
+auto Geometry::SelectLod(
+    const PerspectiveCamera& camera,
+    const glm::mat4& model,
+    float viewport_height,
+    float pixel_error
+) const -> std::size_t {
+    if (lods_.size() < 2) return 0;
+
+    // the largest axis scale bounds how much the model matrix grows errors
+    const auto scale = std::sqrt(std::max({
+        glm::dot(glm::vec3 {model[0]}, glm::vec3 {model[0]}),
+        glm::dot(glm::vec3 {model[1]}, glm::vec3 {model[1]}),
+        glm::dot(glm::vec3 {model[2]}, glm::vec3 {model[2]})
+    }));
+
+    // distance to the nearest point of the bounding sphere; inside it, the
+    // finest level is always used
+    const auto center = glm::vec3 {camera.View() * model * glm::vec4 {center_, 1.0f}};
+    const auto distance = glm::length(center) - radius_ * scale;
+    if (distance <= 0.0f) return 0;
+
+    // Projection()[1][1] is 1 / tan(fov / 2)
+    const auto pixels_per_unit = viewport_height * 0.5f * camera.Projection()[1][1] / distance;
+    for (auto lod = lods_.size() - 1; lod > 0; --lod) {
+        if (lods_[lod].error * scale * pixels_per_unit <= pixel_error) return lod;
+    }
+    return 0;
+}
+
+auto Geometry::Cull(const PerspectiveCamera& camera, const glm::mat4& model, MeshletDrawList& list) const -> void {
+    list.counts.clear();
+    list.offsets.clear();
+    list.triangles = 0;
+    list.culled = 0;
+
+    // both tests run in model space, where the bounds were computed
+    const auto frustum = Frustum {camera.Projection() * camera.View() * model};
+    const auto eye = glm::vec3 {glm::inverse(model) * camera.transform[3]};
+
+    auto end = std::size_t {0}; // of the last range, to merge with
+    for (const auto& meshlet : meshlets_) {
+        const auto to_center = meshlet.center - eye;
+        if (glm::dot(to_center, meshlet.cone_axis) >= meshlet.cone_cutoff * glm::length(to_center) + meshlet.radius ||
+            !frustum.IntersectsSphere(meshlet.center, meshlet.radius)) {
+            ++list.culled;
+            continue;
+        }
+
+        if (!list.counts.empty() && meshlet.index_offset == end) {
+            list.counts.back() += static_cast<int>(meshlet.index_count);
+        } else {
+            list.counts.emplace_back(static_cast<int>(meshlet.index_count));
+            list.offsets.emplace_back(reinterpret_cast<const void*>(meshlet.index_offset * sizeof(GLuint)));
+        }
+        end = meshlet.index_offset + meshlet.index_count;
+        list.triangles += meshlet.index_count / 3;
+    }
+}
+
+auto Geometry::Draw(const Shaders& shader, const MeshletDrawList& list) const -> void {
+    if (vao_ == 0) {
+        std::cerr << "Geometry not initialized. Cannot draw." << std::endl;
+        return;
     }
+    if (list.counts.empty()) return;
+
+    shader.Use();
+    glBindVertexArray(vao_);
+    glMultiDrawElements(
+        GL_TRIANGLES,
+        list.counts.data(),
+        GL_UNSIGNED_INT,
+        list.offsets.data(),
+        static_cast<GLsizei>(list.counts.size())
+    );
+    RENDER_STATS_ADD(vao_binds, 1);
+    RENDER_STATS_ADD(draw_calls, 1);
+    RENDER_STATS_ADD(triangles, list.triangles);
 }
 
 auto Geometry::ConfigureVertices(const std::vector<float>& vertex_data) -> void {
@@ -59,22 +167,39 @@ auto Geometry::ConfigureVertices(const std::vector<float>& vertex_data) -> void
         vertex_data.data(),
         GL_STATIC_DRAW
     );
+    RENDER_STATS_ADD(buffer_bytes, vertex_data.size() * sizeof(float));
 
     // vertices
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, STRIDE(8), BUFFER_OFFSET(0));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, STRIDE(kVertexFloats), BUFFER_OFFSET(0));
 
     // normals
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, STRIDE(8), BUFFER_OFFSET(3));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, STRIDE(kVertexFloats), BUFFER_OFFSET(3));
 
     // texture coordinates
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, STRIDE(8), BUFFER_OFFSET(6));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, STRIDE(kVertexFloats), BUFFER_OFFSET(6));
 }
 
-auto Geometry::ConfigureIndices(const std::vector<unsigned int>& index_data) -> void {
-    indices_size_ = index_data.size();
+auto Geometry::ConfigureTangents(const std::vector<float>& tangent_data) -> void {
+    glGenBuffers(1, &tangent_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, tangent_vbo_);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        tangent_data.size() * sizeof(float),
+        tangent_data.data(),
+        GL_STATIC_DRAW
+    );
+    RENDER_STATS_ADD(buffer_bytes, tangent_data.size() * sizeof(float));
+
+    // tangents, with the bitangent sign in w
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, STRIDE(4), BUFFER_OFFSET(0));
+}
+
+auto Geometry::ConfigureIndices(const std::vector<unsigned int>& index_data, const std::vector<LodLevel>& lods) -> void {
+    lods_ = lods.empty() ? std::vector {LodLevel {0, index_data.size(), 0.0f}} : lods;
 
     glGenBuffers(1, &ebo_);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
@@ -84,4 +209,24 @@ auto Geometry::ConfigureIndices(const std::vector<unsigned int>& index_data) ->
         index_data.data(),
         GL_STATIC_DRAW
     );
+    RENDER_STATS_ADD(buffer_bytes, index_data.size() * sizeof(unsigned int));
+}
+
+auto Geometry::ComputeBounds(const std::vector<float>& vertex_data) -> void {
+    if (vertex_data.empty()) return;
+
+    auto min = glm::vec3 {vertex_data[0], vertex_data[1], vertex_data[2]};
+    auto max = min;
+    for (auto i = std::size_t {0}; i + 2 < vertex_data.size(); i += kVertexFloats) {
+        const auto position = glm::vec3 {vertex_data[i], vertex_data[i + 1], vertex_data[i + 2]};
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+
+    center_ = (min + max) * 0.5f;
+    radius_ = 0.0f;
+    for (auto i = std::size_t {0}; i + 2 < vertex_data.size(); i += kVertexFloats) {
+        const auto position = glm::vec3 {vertex_data[i], vertex_data[i + 1], vertex_data[i + 2]};
+        radius_ = std::max(radius_, glm::distance(position, center_));
+    }
 }
\ No newline at end of file
@@ -3,10 +3,64 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
+#include <glm/glm.hpp>
+
+#include "core/perspective_camera.h"
 #include "core/shaders.h"
 
+// a range of index_data drawn at one level of detail
+struct LodLevel {
+    std::size_t index_offset {0};
+    std::size_t index_count {0};
+    float error {0.0f}; // distance from the full mesh, in model units
+};
+
+// a cluster of neighbouring triangles, contiguous in index_data, with the
+// bounds Geometry::Cull tests against
+struct Meshlet {
+    std::size_t index_offset {0};
+    std::size_t index_count {0};
+    glm::vec3 center {0.0f};
+    float radius {0.0f};
+
+    // all triangles face away from any eye for which
+    // dot(center - eye, cone_axis) >= cone_cutoff * |center - eye| + radius
+    glm::vec3 cone_axis {0.0f};
+    float cone_cutoff {1.0f};
+};
+
+// index ranges for one glMultiDrawElements call, built by Geometry::Cull;
+// reused from frame to frame so recording does not allocate
+struct MeshletDrawList {
+    std::vector<int> counts {};
+    std::vector<const void*> offsets {};
+    std::size_t triangles {0};
+    std::size_t culled {0}; // meshlets rejected
+};
+
+// floats per vertex in GeometryData::vertex_data: position, normal and uv
+constexpr auto kVertexFloats = std::size_t {8};
+
+// interleaved position, normal and uv (kVertexFloats per vertex) and indices,
+// as generated on the CPU before being uploaded
+struct GeometryData {
+    std::vector<float> vertex_data {};
+    std::vector<unsigned int> index_data {};
+
+    // xyz and handedness per vertex; empty unless computed, see mesh_processing.h
+    std::vector<float> tangent_data {};
+
+    // finest first, each level an index range over the same vertices; empty
+    // means one level covering index_data, see mesh_simplifier.h
+    std::vector<LodLevel> lods {};
+
+    // over the finest level only; empty unless built, see meshlets.h
+    std::vector<Meshlet> meshlets {};
+};
+
 class Geometry {
 public:
     Geometry(
@@ -14,22 +68,57 @@ public:
         const std::vector<unsigned int>& index_data = {}
     );
 
-    auto Draw(const Shaders& shader) const -> void;
+    // uploads tangents as attribute 3 when the data has them
+    explicit Geometry(const GeometryData& data);
+
+    auto Draw(const Shaders& shader, std::size_t lod = 0) const -> void;
+
+    // the coarsest level whose error projects to at most pixel_error pixels
+    // for a viewport of the given height
+    [[nodiscard]] auto SelectLod(
+        const PerspectiveCamera& camera,
+        const glm::mat4& model,
+        float viewport_height,
+        float pixel_error = 1.0f
+    ) const -> std::size_t;
+
+    [[nodiscard]] auto LodCount() const { return lods_.size(); }
+
+    // the meshlets that are in the frustum and not facing away from the
+    // camera; adjacent ranges are merged
+    auto Cull(const PerspectiveCamera& camera, const glm::mat4& model, MeshletDrawList& list) const -> void;
+
+    // draws the ranges of a list from Cull in one call
+    auto Draw(const Shaders& shader, const MeshletDrawList& list) const -> void;
+
+    [[nodiscard]] auto Meshlets() const -> const std::vector<Meshlet>& { return meshlets_; }
 
 protected:
     Geometry() = default;
 
     auto SetVertexData(
         const std::vector<float>& vertex_data,
-        const std::vector<unsigned int>& index_data = {}
+        const std::vector<unsigned int>& index_data = {},
+        const std::vector<float>& tangent_data = {},
+        const std::vector<LodLevel>& lods = {},
+        const std::vector<Meshlet>& meshlets = {}
     ) -> void;
 
 private:
     unsigned int vao_ {0};
     unsigned int vbo_ {0};
     unsigned int ebo_ {0};
-    unsigned int indices_size_ {0};
+    unsigned int tangent_vbo_ {0};
+
+    std::vector<LodLevel> lods_ {};
+    std::vector<Meshlet> meshlets_ {};
+
+    // bounding sphere in model space, for SelectLod
+    glm::vec3 center_ {0.0f};
+    float radius_ {0.0f};
 
     auto ConfigureVertices(const std::vector<float>& vertex_data) -> void;
-    auto ConfigureIndices(const std::vector<unsigned int>& index_data) -> void;
+    auto ConfigureTangents(const std::vector<float>& tangent_data) -> void;
+    auto ConfigureIndices(const std::vector<unsigned int>& index_data, const std::vector<LodLevel>& lods) -> void;
+    auto ComputeBounds(const std::vector<float>& vertex_data) -> void;
 };
\ No newline at end of file
@@ -0,0 +1,256 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "headless_window.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <string_view>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <imgui.h>
+#include <imgui/imgui_impl_opengl3.h>
+
+#include "event_bus.h"
+#include "main_thread_queue.h"
+#include "profiler.h"
+#include "render_stats.h"
+#include "timer.h"
+
+static auto eglHasExtension(EGLDisplay display, const char* name) -> bool;
+
+HeadlessWindow::HeadlessWindow(const Parameters& params) : params_(params) {
+    if (!CreateContext()) {
+        return;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cerr << "Failed to load OpenGL functions\n";
+        return;
+    }
+
+    if (!CreateFramebuffer()) {
+        std::cerr << "Failed to create the offscreen framebuffer\n";
+        return;
+    }
+
+    // ImGui runs without a platform backend; size and time are set per frame
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui_ImplOpenGL3_Init();
+
+    valid_ = true;
+}
+
+auto HeadlessWindow::CreateContext() -> bool {
+    // prefer a display that needs no window system at all
+    auto display = EGL_NO_DISPLAY;
+    const auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT")
+    );
+    if (get_platform_display && eglHasExtension(EGL_NO_DISPLAY, "EGL_MESA_platform_surfaceless")) {
+        display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        std::cerr << "Failed to initialize EGL\n";
+        return false;
+    }
+    display_ = display;
+
+    // every later failure hands the display back before returning
+    const auto fail = [&](std::string_view message) {
+        std::cerr << message;
+        if (surface_) eglDestroySurface(display, surface_);
+        eglTerminate(display);
+        surface_ = nullptr;
+        display_ = nullptr;
+        return false;
+    };
+
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    auto config = EGLConfig {};
+    auto config_count = EGLint {0};
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &config_count) || config_count == 0) {
+        return fail("No EGL config supports desktop OpenGL\n");
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 1,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    auto context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+    if (context == EGL_NO_CONTEXT) {
+        return fail(std::format("Failed to create an OpenGL 4.1 context ({:#x})\n", eglGetError()));
+    }
+
+    // rendering goes to our own framebuffer, so the surface is only needed
+    // on drivers that cannot make a context current without one
+    auto surface = EGL_NO_SURFACE;
+    if (!eglHasExtension(display, "EGL_KHR_surfaceless_context")) {
+        const EGLint surface_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, surface_attributes);
+        if (surface == EGL_NO_SURFACE) {
+            eglDestroyContext(display, context);
+            return fail("Failed to create an EGL pbuffer surface\n");
+        }
+        surface_ = surface;
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        eglDestroyContext(display, context);
+        return fail("Failed to make the EGL context current\n");
+    }
+
+    context_ = context;
+    return true;
+}
+
+auto HeadlessWindow::CreateFramebuffer() -> bool {
+    glGenRenderbuffers(1, &color_buffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, params_.width, params_.height);
+
+    glGenRenderbuffers(1, &depth_buffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, params_.width, params_.height);
+
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_buffer_);
+
+    glViewport(0, 0, params_.width, params_.height);
+
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+auto HeadlessWindow::Start(const std::function<void(const double delta)>& program) -> void {
+    if (!IsValid()) return;
+
+    auto timer = Timer {};
+    auto& io = ImGui::GetIO();
+    io.DisplaySize = {static_cast<float>(params_.width), static_cast<float>(params_.height)};
+
+    for (auto frame = std::uint32_t {0}; ; ++frame) {
+        const auto finished = replay_ && params_.frames == 0
+            ? replay_->IsFinished(frame)
+            : frame >= params_.frames;
+        if (finished) break;
+
+        const auto elapsed = timer.GetSeconds();
+        timer.Reset();
+
+        io.DeltaTime = static_cast<float>(params_.timestep);
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui::NewFrame();
+
+        MainThreadQueue::Get().Drain();
+        EventBus::Get().Drain();
+        if (replay_) replay_->Dispatch(frame);
+
+        {
+            PROFILE_ZONE("Program");
+            PROFILE_GPU_ZONE("Program");
+            program(params_.timestep);
+        }
+
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        // without a swap nothing forces the frame to complete, which would
+        // let the driver queue frames and make the timings meaningless
+        glFinish();
+        PROFILE_FRAME();
+        RENDER_STATS_FRAME(elapsed * 1000.0);
+
+        if (frame_log_) {
+            frame_log_->Add(frame, elapsed * 1000.0, timer.GetSeconds() * 1000.0);
+        }
+    }
+}
+
+auto HeadlessWindow::ReadPixels() const -> std::shared_ptr<Image> {
+    const auto width = static_cast<std::size_t>(params_.width);
+    const auto height = static_cast<std::size_t>(params_.height);
+    const auto row = width * 4;
+
+    auto pixels = ImageData {new unsigned char[row * height], [](void* data) {
+        delete[] static_cast<unsigned char*>(data);
+    }};
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, params_.width, params_.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.get());
+
+    // OpenGL returns the bottom row first
+    for (auto y = std::size_t {0}; y < height / 2; ++y) {
+        std::swap_ranges(
+            pixels.get() + y * row,
+            pixels.get() + (y + 1) * row,
+            pixels.get() + (height - 1 - y) * row
+        );
+    }
+
+    return std::make_shared<Image>(Image::Parameters {
+        .filename = {},
+        .width = params_.width,
+        .height = params_.height,
+        .depth = 4
+    }, std::move(pixels));
+}
+
+HeadlessWindow::~HeadlessWindow() {
+    if (context_ == nullptr) return;
+
+    if (valid_) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    // the profiler is a static that outlives the context
+    PROFILE_RELEASE_GPU();
+
+    // the names exist only once the GL functions were loaded
+    if (framebuffer_ != 0) {
+        glDeleteFramebuffers(1, &framebuffer_);
+        glDeleteRenderbuffers(1, &color_buffer_);
+        glDeleteRenderbuffers(1, &depth_buffer_);
+    }
+
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface_) eglDestroySurface(display_, surface_);
+    eglDestroyContext(display_, context_);
+    eglTerminate(display_);
+}
+
+static auto eglHasExtension(EGLDisplay display, const char* name) -> bool {
+    const auto extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (extensions == nullptr) return false;
+
+    const auto length = std::strlen(name);
+    // match whole names only, not a prefix or suffix of a longer one
+    for (auto start = extensions; (start = std::strstr(start, name)); start += length) {
+        const auto begins = start == extensions || start[-1] == ' ';
+        const auto ends = start[length] == ' ' || start[length] == '\0';
+        if (begins && ends) return true;
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+#include <glad/glad.h>
+
+#include "core/frame_time_log.h"
+#include "core/image.h"
+#include "core/input_recorder.h"
+
+// Offscreen counterpart to Window for machines without a display or GPU.
+// Creates a GL 4.1 core context through EGL (surfaceless where supported,
+// a pbuffer otherwise, both work on Mesa llvmpipe) and renders into a
+// framebuffer object of the requested size. Start runs the same program
+// as Window for a fixed number of frames with a fixed timestep.
+class HeadlessWindow {
+public:
+    struct Parameters {
+        int width {1024};
+        int height {768};
+        std::uint32_t frames {100};
+        double timestep {1.0 / 60.0};
+    };
+
+    explicit HeadlessWindow(const Parameters& params);
+
+    // deleted copy constructors and assignment operators
+    HeadlessWindow(const HeadlessWindow&) = delete;
+    HeadlessWindow& operator=(const HeadlessWindow&) = delete;
+
+    [[nodiscard]] auto IsValid() const { return valid_; }
+
+    auto Start(const std::function<void(const double delta)>& program) -> void;
+
+    // drives input from a recording; runs until it ends when frames is 0
+    auto Replay(std::shared_ptr<InputReplay> replay) { replay_ = replay; }
+
+    auto LogFrameTimes(const fs::path& path) {
+        frame_log_ = std::make_unique<FrameTimeLog>(path);
+    }
+
+    // reads back the current contents of the framebuffer, top row first;
+    // call from the program or after Start returns
+    [[nodiscard]] auto ReadPixels() const -> std::shared_ptr<Image>;
+
+    ~HeadlessWindow();
+
+private:
+    Parameters params_;
+
+    void* display_ {nullptr};
+    void* context_ {nullptr};
+    void* surface_ {nullptr};
+
+    GLuint framebuffer_ {0};
+    GLuint color_buffer_ {0};
+    GLuint depth_buffer_ {0};
+
+    std::shared_ptr<InputReplay> replay_ {nullptr};
+    std::unique_ptr<FrameTimeLog> frame_log_ {nullptr};
+
+    bool valid_ {false};
+
+    auto CreateContext() -> bool;
+
+    auto CreateFramebuffer() -> bool;
+};
\ No newline at end of file
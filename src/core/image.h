@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
@@ -59,6 +60,9 @@ public:
 
     [[nodiscard]] auto Data() const { return data_.get(); }
 
+    // pixel data is always decoded to four channels
+    [[nodiscard]] auto Bytes() const -> std::size_t { return width * height * 4; }
+
     ~Image() = default;
 
 private:
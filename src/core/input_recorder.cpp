@@ -0,0 +1,92 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "input_recorder.h"
+
+#include <format>
+#include <fstream>
+#include <iostream>
+
+auto InputRecorder::Create(const fs::path& path)
+    -> std::expected<std::shared_ptr<InputRecorder>, std::string> {
+    // fail now rather than after the session has been recorded
+    if (!std::ofstream {path, std::ios::binary | std::ios::trunc}) {
+        return std::unexpected(std::format("Failed to open '{}' for writing", path.string()));
+    }
+    return std::shared_ptr<InputRecorder>(new InputRecorder(path));
+}
+
+InputRecorder::InputRecorder(const fs::path& path) : path_(path) {
+    event_listener_ = EventDispatcher::Get().AddEventListener<MouseEvent>(
+        [this](const MouseEvent& event) {
+            events_.emplace_back(RecordedEvent {
+                .frame = frame_,
+                .type = static_cast<std::uint8_t>(event.type),
+                .button = static_cast<std::uint8_t>(event.button),
+                .reserved = 0,
+                .position = {event.position.x, event.position.y},
+                .delta = {event.delta.x, event.delta.y},
+                .scroll = {event.scroll.x, event.scroll.y}
+            });
+        }
+    );
+}
+
+InputRecorder::~InputRecorder() {
+    EventDispatcher::Get().RemoveEventListener(event_listener_);
+
+    const auto header = RecordingHeader {
+        .magic = kRecordingMagic,
+        .version = kRecordingVersion,
+        .event_count = static_cast<std::uint32_t>(events_.size()),
+        .frame_count = frame_ + 1
+    };
+
+    auto stream = std::ofstream {path_, std::ios::binary | std::ios::trunc};
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(events_.data()), events_.size() * sizeof(RecordedEvent));
+    if (!stream) {
+        std::cerr << std::format("Failed to write recording '{}'\n", path_.string());
+    }
+}
+
+auto InputReplay::Open(const fs::path& path)
+    -> std::expected<std::shared_ptr<InputReplay>, std::string> {
+    auto stream = std::ifstream {path, std::ios::binary};
+    if (!stream) {
+        return std::unexpected(std::format("File not found '{}'", path.string()));
+    }
+
+    auto header = RecordingHeader {};
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!stream || header.magic != kRecordingMagic || header.version != kRecordingVersion) {
+        return std::unexpected(std::format("Invalid recording '{}'", path.string()));
+    }
+
+    auto replay = std::shared_ptr<InputReplay>(new InputReplay());
+    replay->events_.resize(header.event_count);
+    replay->frame_count_ = header.frame_count;
+    stream.read(
+        reinterpret_cast<char*>(replay->events_.data()),
+        replay->events_.size() * sizeof(RecordedEvent)
+    );
+    if (!stream) {
+        return std::unexpected(std::format("Truncated recording '{}'", path.string()));
+    }
+
+    return replay;
+}
+
+auto InputReplay::Dispatch(std::uint32_t frame) -> void {
+    for (; next_ < events_.size() && events_[next_].frame <= frame; ++next_) {
+        const auto& recorded = events_[next_];
+        auto event = MouseEvent {};
+        event.type = static_cast<MouseEvent::Type>(recorded.type);
+        event.button = static_cast<MouseButton>(recorded.button);
+        event.position = {recorded.position[0], recorded.position[1]};
+        event.delta = {recorded.delta[0], recorded.delta[1]};
+        event.scroll = {recorded.scroll[0], recorded.scroll[1]};
+
+        EventDispatcher::Get().Dispatch(event);
+    }
+}
\ No newline at end of file
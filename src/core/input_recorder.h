@@ -0,0 +1,98 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/event_dispatcher.h"
+#include "core/events.h"
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// On-disk layout of a recording:
+//
+//   RecordingHeader
+//   RecordedEvent[event_count]   in frame order
+//
+// All integers and floats are little-endian.
+
+constexpr auto kRecordingMagic = std::uint32_t {0x4345524F}; // "OREC"
+constexpr auto kRecordingVersion = std::uint32_t {1};
+
+struct RecordingHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t event_count;
+    std::uint32_t frame_count;
+};
+
+struct RecordedEvent {
+    std::uint32_t frame;
+    std::uint8_t type;
+    std::uint8_t button;
+    std::uint16_t reserved;
+    float position[2];
+    float delta[2];
+    float scroll[2];
+};
+
+static_assert(sizeof(RecordingHeader) == 16);
+static_assert(sizeof(RecordedEvent) == 32);
+
+// Captures every MouseEvent that goes through EventDispatcher, tagged with
+// the frame it was delivered on. Events are kept in memory and written out
+// when the recorder is destroyed, so recording adds no I/O to the frame.
+class InputRecorder {
+public:
+    [[nodiscard]] static auto Create(const fs::path& path)
+        -> std::expected<std::shared_ptr<InputRecorder>, std::string>;
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    auto SetFrame(std::uint32_t frame) { frame_ = frame; }
+
+    [[nodiscard]] auto Size() const { return events_.size(); }
+
+    ~InputRecorder();
+
+private:
+    explicit InputRecorder(const fs::path& path);
+
+    fs::path path_;
+
+    std::vector<RecordedEvent> events_ {};
+
+    std::uint32_t frame_ {0};
+
+    ListenerHandle event_listener_ {};
+};
+
+// Feeds a recording back through EventDispatcher, frame by frame.
+class InputReplay {
+public:
+    [[nodiscard]] static auto Open(const fs::path& path)
+        -> std::expected<std::shared_ptr<InputReplay>, std::string>;
+
+    // dispatches the events recorded for frame
+    auto Dispatch(std::uint32_t frame) -> void;
+
+    [[nodiscard]] auto IsFinished(std::uint32_t frame) const { return frame >= frame_count_; }
+
+    [[nodiscard]] auto FrameCount() const { return frame_count_; }
+
+private:
+    InputReplay() = default;
+
+    std::vector<RecordedEvent> events_ {};
+
+    std::size_t next_ {0};
+
+    std::uint32_t frame_count_ {0};
+};
\ No newline at end of file
@@ -0,0 +1,84 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/mpsc_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+
+using MainThreadTask = std::function<void()>;
+
+class MainThreadQueue {
+public:
+    struct Budget {
+        std::chrono::microseconds time {2000};
+        std::size_t items {std::numeric_limits<std::size_t>::max()};
+    };
+
+    MainThreadQueue(const MainThreadQueue&) = delete;
+    MainThreadQueue& operator=(const MainThreadQueue&) = delete;
+
+    static auto Get() -> MainThreadQueue& {
+        static auto instance = MainThreadQueue {};
+        return instance;
+    }
+
+    // safe to call from any thread
+    auto Post(MainThreadTask task) -> void {
+        tasks_.Push(std::move(task));
+        if (auto wake = wake_.load(std::memory_order_acquire)) wake();
+    }
+
+    // called after every Post so an idle render loop can wake up; must be
+    // safe to call from any thread
+    auto SetWakeCallback(void (*wake)()) {
+        wake_.store(wake, std::memory_order_release);
+    }
+
+    // runs queued tasks on the calling (render) thread until the queue is empty
+    // or the budget is exhausted; the time budget is checked after each task,
+    // so at least one task runs per call even if it overruns
+    auto Drain() -> std::size_t {
+        using namespace std::chrono;
+        const auto start = steady_clock::now();
+        auto drained = std::size_t {0};
+
+        while (drained < budget_.items) {
+            auto task = tasks_.TryPop();
+            if (!task) break;
+
+            (*task)();
+            ++drained;
+
+            if (steady_clock::now() - start >= budget_.time) break;
+        }
+
+        drained_last_frame_ = drained;
+        return drained;
+    }
+
+    auto SetBudget(const Budget& budget) { budget_ = budget; }
+
+    [[nodiscard]] auto GetBudget() const -> const Budget& { return budget_; }
+
+    [[nodiscard]] auto Depth() const { return tasks_.Size(); }
+
+    [[nodiscard]] auto DrainedLastFrame() const { return drained_last_frame_; }
+
+private:
+    MainThreadQueue() = default;
+    ~MainThreadQueue() = default;
+
+    MpscQueue<MainThreadTask> tasks_ {};
+
+    Budget budget_ {};
+
+    std::size_t drained_last_frame_ {0};
+
+    std::atomic<void (*)()> wake_ {nullptr};
+};
\ No newline at end of file
@@ -0,0 +1,148 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+// Unbounded multi-producer single-consumer queue (Vyukov's intrusive design).
+// Push is wait-free and may be called from any thread; TryPop must only be
+// called from the single consumer thread.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    auto Push(T value) -> void {
+        auto node = new Node {};
+        node->value.emplace(std::move(value));
+        size_.fetch_add(1, std::memory_order_relaxed);
+        auto prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    auto TryPop() -> std::optional<T> {
+        auto tail = tail_;
+        auto next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return std::nullopt;
+        }
+
+        auto value = std::move(next->value);
+        next->value.reset();
+        tail_ = next;
+        if (tail != &stub_) {
+            delete tail;
+        }
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return value;
+    }
+
+    // approximate while producers are active
+    [[nodiscard]] auto Size() const {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    ~MpscQueue() {
+        while (TryPop()) {}
+        if (tail_ != &stub_) {
+            delete tail_;
+        }
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next {nullptr};
+        std::optional<T> value {};
+    };
+
+    Node stub_ {};
+    std::atomic<Node*> head_;
+    Node* tail_;
+    std::atomic<std::size_t> size_ {0};
+};
+
+// Bounded multi-producer single-consumer ring (Vyukov's bounded design).
+// Cells carry a sequence number that tells producers whether a slot is free
+// and the consumer whether it has been published, so neither side locks.
+// TryPush fails instead of blocking when the ring is full.
+template <typename T>
+class BoundedMpscQueue {
+public:
+    explicit BoundedMpscQueue(std::size_t capacity)
+      : capacity_(std::bit_ceil(capacity)),
+        cells_(std::make_unique<Cell[]>(capacity_)) {
+        for (auto i = std::size_t {0}; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+    BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+    auto TryPush(T value) -> bool {
+        auto position = enqueue_.load(std::memory_order_relaxed);
+        while (true) {
+            auto& cell = cells_[position & (capacity_ - 1)];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value.emplace(std::move(value));
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // the consumer has not freed this cell yet
+            } else {
+                position = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    auto TryPop() -> std::optional<T> {
+        const auto position = dequeue_.load(std::memory_order_relaxed);
+        auto& cell = cells_[position & (capacity_ - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+            return std::nullopt;
+        }
+
+        auto value = std::move(cell.value);
+        cell.value.reset();
+        cell.sequence.store(position + capacity_, std::memory_order_release);
+        dequeue_.store(position + 1, std::memory_order_relaxed);
+        return value;
+    }
+
+    // approximate while producers are active
+    [[nodiscard]] auto Size() const -> std::size_t {
+        const auto enqueued = enqueue_.load(std::memory_order_relaxed);
+        const auto dequeued = dequeue_.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? std::min(enqueued - dequeued, capacity_) : 0;
+    }
+
+    [[nodiscard]] auto Capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence {0};
+        std::optional<T> value {};
+    };
+
+    std::size_t capacity_;
+    std::unique_ptr<Cell[]> cells_;
+
+    alignas(64) std::atomic<std::size_t> enqueue_ {0};
+    alignas(64) std::atomic<std::size_t> dequeue_ {0};
+};
\ No newline at end of file
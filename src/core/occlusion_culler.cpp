@@ -0,0 +1,278 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "core/occlusion_culler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/simd.h"
+#include "core/timer.h"
+#include "core/worker_pool.h"
+
+namespace {
+
+constexpr auto kTileSize = 32u; // pixels, a multiple of four
+
+// clip-space points outside this are skipped rather than clipped
+auto InFrontOfNear(const glm::vec4& p) {
+    return p.w > 0.0f && p.z >= -p.w;
+}
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller(const Parameters& params)
+  : tiles_x_((std::max(params.width, 1u) + kTileSize - 1) / kTileSize),
+    tiles_y_((std::max(params.height, 1u) + kTileSize - 1) / kTileSize) {
+    auto width = tiles_x_ * kTileSize;
+    auto height = tiles_y_ * kTileSize;
+    levels_.emplace_back(width, height, std::vector<float>(width * height, 1.0f));
+    while (width > 1 || height > 1) {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+        levels_.emplace_back(width, height, std::vector<float>(width * height, 1.0f));
+    }
+    bins_.resize(tiles_x_ * tiles_y_);
+}
+
+auto OcclusionCuller::BeginFrame(const glm::mat4& view_projection) -> void {
+    view_projection_ = view_projection;
+    occluders_.clear();
+    stats_ = {};
+}
+
+auto OcclusionCuller::AddOccluder(const GeometryData& data, const glm::mat4& model) -> void {
+    occluders_.emplace_back(&data, model);
+}
+
+auto OcclusionCuller::Rasterize() -> void {
+    const auto timer = Timer {};
+
+    triangles_.clear();
+    for (auto& bin : bins_) bin.clear();
+
+    for (const auto& occluder : occluders_) {
+        const auto& data = *occluder.data;
+        const auto vertex_count = data.vertex_data.size() / kVertexFloats;
+        const auto m = view_projection_ * occluder.model;
+
+        // four vertices at a time, one lane each; the stores run past the last
+        // vertex, so the buffer is rounded up
+        clip_.resize((vertex_count + 3) / 4 * 4);
+        const auto* v = data.vertex_data.data();
+        for (auto i = std::size_t {0}; i < vertex_count; i += 4) {
+            const auto lane = [&](std::size_t offset, std::size_t component) {
+                return v[std::min(i + offset, vertex_count - 1) * kVertexFloats + component];
+            };
+            const auto x = Float4::Set(lane(0, 0), lane(1, 0), lane(2, 0), lane(3, 0));
+            const auto y = Float4::Set(lane(0, 1), lane(1, 1), lane(2, 1), lane(3, 1));
+            const auto z = Float4::Set(lane(0, 2), lane(1, 2), lane(2, 2), lane(3, 2));
+            const auto row = [&](int r) {
+                return Float4::Broadcast(m[0][r]) * x + Float4::Broadcast(m[1][r]) * y +
+                       Float4::Broadcast(m[2][r]) * z + Float4::Broadcast(m[3][r]);
+            };
+            auto cx = row(0);
+            auto cy = row(1);
+            auto cz = row(2);
+            auto cw = row(3);
+            Transpose(cx, cy, cz, cw);
+            cx.Store(&clip_[i].x);
+            cy.Store(&clip_[i + 1].x);
+            cz.Store(&clip_[i + 2].x);
+            cw.Store(&clip_[i + 3].x);
+        }
+
+        const auto& indices = data.index_data;
+        const auto count = data.lods.empty() ? indices.size() : data.lods.front().index_count;
+        for (auto i = std::size_t {0}; i + 2 < count; i += 3) {
+            Setup(clip_[indices[i]], clip_[indices[i + 1]], clip_[indices[i + 2]]);
+        }
+    }
+    stats_.occluder_triangles = triangles_.size();
+
+    // tiles never share pixels, so each is rasterized by whichever thread
+    // takes it next
+    auto& depth = levels_.front().depth;
+    std::ranges::fill(depth, 1.0f);
+    WorkerPool::Get().Run(bins_.size(), [this](std::size_t tile) { RasterizeTile(tile); });
+
+    BuildHierarchy();
+    stats_.rasterize_ms = timer.GetSeconds() * 1000.0;
+}
+
+auto OcclusionCuller::Setup(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) -> void {
+    if (!InFrontOfNear(a) || !InFrontOfNear(b) || !InFrontOfNear(c)) return;
+
+    const auto& level = levels_.front();
+    const auto width = static_cast<float>(level.width);
+    const auto height = static_cast<float>(level.height);
+    const auto screen = [&](const glm::vec4& p) {
+        return glm::vec3 {
+            (p.x / p.w * 0.5f + 0.5f) * width,
+            (p.y / p.w * 0.5f + 0.5f) * height,
+            p.z / p.w * 0.5f + 0.5f
+        };
+    };
+    const auto p0 = screen(a);
+    const auto p1 = screen(b);
+    const auto p2 = screen(c);
+
+    // counter-clockwise faces the camera, as in GL
+    const auto area = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+    if (!(area > 0.0f)) return;
+    if (std::min({p0.z, p1.z, p2.z}) > 1.0f) return;
+
+    // pixels whose centres fall inside the bounds
+    const auto min_x = std::max(0, static_cast<int>(std::ceil(std::min({p0.x, p1.x, p2.x}) - 0.5f)));
+    const auto min_y = std::max(0, static_cast<int>(std::ceil(std::min({p0.y, p1.y, p2.y}) - 0.5f)));
+    const auto max_x = std::min(static_cast<int>(level.width) - 1, static_cast<int>(std::floor(std::max({p0.x, p1.x, p2.x}) - 0.5f)));
+    const auto max_y = std::min(static_cast<int>(level.height) - 1, static_cast<int>(std::floor(std::max({p0.y, p1.y, p2.y}) - 0.5f)));
+    if (min_x > max_x || min_y > max_y) return;
+
+    auto triangle = Triangle {};
+    triangle.min_x = min_x;
+    triangle.min_y = min_y;
+    triangle.max_x = max_x;
+    triangle.max_y = max_y;
+    const glm::vec3* points[] {&p0, &p1, &p2};
+    for (auto i = 0; i < 3; ++i) {
+        const auto& from = *points[i];
+        const auto& to = *points[(i + 1) % 3];
+        triangle.edge_x[i] = from.y - to.y;
+        triangle.edge_y[i] = to.x - from.x;
+        // moved in by half a pixel, so the edge is tested at the pixel's worst
+        // corner and only pixels the triangle covers entirely are written
+        triangle.edge_c[i] = -triangle.edge_x[i] * from.x - triangle.edge_y[i] * from.y -
+                             0.5f * (std::abs(triangle.edge_x[i]) + std::abs(triangle.edge_y[i]));
+    }
+    const auto d1 = p1 - p0;
+    const auto d2 = p2 - p0;
+    triangle.depth_x = (d1.z * d2.y - d2.z * d1.y) / area;
+    triangle.depth_y = (d2.z * d1.x - d1.z * d2.x) / area;
+    // the farthest depth anywhere in the pixel rather than at its centre, so
+    // a sloped occluder never reads nearer than it is
+    triangle.depth_c = p0.z - triangle.depth_x * p0.x - triangle.depth_y * p0.y +
+                       0.5f * (std::abs(triangle.depth_x) + std::abs(triangle.depth_y));
+
+    const auto index = static_cast<unsigned>(triangles_.size());
+    triangles_.emplace_back(triangle);
+    for (auto ty = static_cast<unsigned>(min_y) / kTileSize; ty <= static_cast<unsigned>(max_y) / kTileSize; ++ty) {
+        for (auto tx = static_cast<unsigned>(min_x) / kTileSize; tx <= static_cast<unsigned>(max_x) / kTileSize; ++tx) {
+            bins_[ty * tiles_x_ + tx].emplace_back(index);
+        }
+    }
+}
+
+auto OcclusionCuller::RasterizeTile(std::size_t tile) -> void {
+    auto& level = levels_.front();
+    const auto tile_x = static_cast<int>(tile % tiles_x_ * kTileSize);
+    const auto tile_y = static_cast<int>(tile / tiles_x_ * kTileSize);
+    const auto offsets = Float4::Set(0.5f, 1.5f, 2.5f, 3.5f);
+    const auto zero = Float4::Broadcast(0.0f);
+
+    for (const auto index : bins_[tile]) {
+        const auto& t = triangles_[index];
+        // whole groups of four, which stay inside the tile since it is
+        // a multiple of four wide
+        const auto x0 = std::max(t.min_x, tile_x) & ~3;
+        const auto x1 = std::min(t.max_x + 1, tile_x + static_cast<int>(kTileSize));
+        const auto y0 = std::max(t.min_y, tile_y);
+        const auto y1 = std::min(t.max_y + 1, tile_y + static_cast<int>(kTileSize));
+
+        const auto px = Float4::Broadcast(static_cast<float>(x0)) + offsets;
+        Float4 edge_step[3];
+        for (auto i = 0; i < 3; ++i) edge_step[i] = Float4::Broadcast(t.edge_x[i] * 4.0f);
+        const auto depth_step = Float4::Broadcast(t.depth_x * 4.0f);
+
+        for (auto y = y0; y < y1; ++y) {
+            const auto py = static_cast<float>(y) + 0.5f;
+            Float4 edge[3];
+            for (auto i = 0; i < 3; ++i) {
+                edge[i] = Float4::Broadcast(t.edge_x[i]) * px + Float4::Broadcast(t.edge_y[i] * py + t.edge_c[i]);
+            }
+            auto depth = Float4::Broadcast(t.depth_x) * px + Float4::Broadcast(t.depth_y * py + t.depth_c);
+
+            auto* row = level.depth.data() + static_cast<std::size_t>(y) * level.width;
+            for (auto x = x0; x < x1; x += 4) {
+                const auto outside = LessThan(Min(edge[0], Min(edge[1], edge[2])), zero);
+                const auto current = Float4::Load(row + x);
+                Select(outside, current, Min(current, depth)).Store(row + x);
+                for (auto i = 0; i < 3; ++i) edge[i] = edge[i] + edge_step[i];
+                depth = depth + depth_step;
+            }
+        }
+    }
+}
+
+auto OcclusionCuller::BuildHierarchy() -> void {
+    for (auto l = std::size_t {1}; l < levels_.size(); ++l) {
+        const auto& fine = levels_[l - 1];
+        auto& coarse = levels_[l];
+        for (auto y = 0u; y < coarse.height; ++y) {
+            const auto y0 = y * 2;
+            const auto y1 = std::min(y0 + 1, fine.height - 1);
+            for (auto x = 0u; x < coarse.width; ++x) {
+                const auto x0 = x * 2;
+                const auto x1 = std::min(x0 + 1, fine.width - 1);
+                coarse.depth[y * coarse.width + x] = std::max({
+                    fine.depth[y0 * fine.width + x0],
+                    fine.depth[y0 * fine.width + x1],
+                    fine.depth[y1 * fine.width + x0],
+                    fine.depth[y1 * fine.width + x1]
+                });
+            }
+        }
+    }
+}
+
+auto OcclusionCuller::IsOccluded(const glm::vec3& min, const glm::vec3& max) -> bool {
+    const auto timer = Timer {};
+    ++stats_.tested;
+    const auto occluded = [&] {
+        const auto& base = levels_.front();
+        auto low = glm::vec2 {std::numeric_limits<float>::max()};
+        auto high = -low;
+        auto nearest = std::numeric_limits<float>::max();
+        for (auto corner = 0; corner < 8; ++corner) {
+            const auto p = view_projection_ * glm::vec4 {
+                corner & 1 ? max.x : min.x,
+                corner & 2 ? max.y : min.y,
+                corner & 4 ? max.z : min.z,
+                1.0f
+            };
+            // the box reaches the camera, so nothing can be in front of it
+            if (!InFrontOfNear(p)) return false;
+            const auto screen = glm::vec2 {
+                (p.x / p.w * 0.5f + 0.5f) * static_cast<float>(base.width),
+                (p.y / p.w * 0.5f + 0.5f) * static_cast<float>(base.height)
+            };
+            low = glm::min(low, screen);
+            high = glm::max(high, screen);
+            nearest = std::min(nearest, p.z / p.w * 0.5f + 0.5f);
+        }
+        // off-screen boxes are left to frustum culling
+        if (high.x < 0.0f || high.y < 0.0f || low.x >= static_cast<float>(base.width) || low.y >= static_cast<float>(base.height)) {
+            return false;
+        }
+
+        const auto x0 = static_cast<unsigned>(std::max(low.x, 0.0f));
+        const auto y0 = static_cast<unsigned>(std::max(low.y, 0.0f));
+        const auto x1 = std::min(static_cast<unsigned>(high.x), base.width - 1);
+        const auto y1 = std::min(static_cast<unsigned>(high.y), base.height - 1);
+
+        // the level where the box spans two or three texels each way
+        auto l = std::size_t {0};
+        while (l + 1 < levels_.size() && std::max(x1 - x0, y1 - y0) >> l > 1) ++l;
+        const auto& level = levels_[l];
+        for (auto y = y0 >> l; y <= y1 >> l; ++y) {
+            for (auto x = x0 >> l; x <= x1 >> l; ++x) {
+                if (level.depth[y * level.width + x] >= nearest) return false;
+            }
+        }
+        return true;
+    }();
+    if (occluded) ++stats_.occluded;
+    stats_.test_ms += timer.GetSeconds() * 1000.0;
+    return occluded;
+}
\ No newline at end of file
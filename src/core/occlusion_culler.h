@@ -0,0 +1,108 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "core/geometry.h"
+
+// Occlusion culling on the CPU. Large occluders, such as walls or big boxes,
+// are rasterized into a small depth buffer, and bounding boxes are tested
+// against a hierarchy of its farthest depths before they are submitted:
+//
+//   culler.BeginFrame(camera.Projection() * camera.View());
+//   culler.AddOccluder(wall_data, wall_model);
+//   culler.Rasterize();
+//   if (!culler.IsOccluded(box_min, box_max)) commands.AddDraw(...);
+//
+// The buffer is split into tiles rasterized on the shared worker pool, four
+// pixels at a time (see core/simd.h). Triangles facing away or crossing the
+// near plane are skipped. A triangle writes only the pixels it covers
+// entirely, each with the farthest depth it reaches inside them, so the test
+// is conservative: a box is reported hidden only if every pixel it projects to
+// is behind an occluder. Pixels along the shared edges of an occluder's
+// triangles are covered by neither, which leaves thin gaps that let boxes
+// behind them through.
+class OcclusionCuller {
+public:
+    struct Parameters {
+        unsigned width {256}; // rounded up to whole tiles
+        unsigned height {128};
+    };
+
+    struct Stats {
+        std::size_t occluder_triangles {0}; // rasterized this frame
+        std::size_t tested {0};
+        std::size_t occluded {0};
+        double rasterize_ms {0.0};
+        double test_ms {0.0};
+    };
+
+    // farthest depth of each texel, 0 to 1 as in the GL depth buffer, row by
+    // row from the bottom; level 0 is the depth buffer itself
+    struct Level {
+        unsigned width;
+        unsigned height;
+        std::vector<float> depth;
+    };
+
+    explicit OcclusionCuller(const Parameters& params);
+
+    // clears the depth buffer and the occluders of the last frame
+    auto BeginFrame(const glm::mat4& view_projection) -> void;
+
+    // only positions and indices are read; the data must outlive Rasterize
+    auto AddOccluder(const GeometryData& data, const glm::mat4& model) -> void;
+
+    auto Rasterize() -> void;
+
+    // true when the world-space box is behind the occluders everywhere it
+    // appears on screen
+    [[nodiscard]] auto IsOccluded(const glm::vec3& min, const glm::vec3& max) -> bool;
+
+    [[nodiscard]] auto GetStats() const -> const Stats& { return stats_; }
+
+    [[nodiscard]] auto Levels() const -> const std::vector<Level>& { return levels_; }
+
+private:
+    struct Occluder {
+        const GeometryData* data;
+        glm::mat4 model;
+    };
+
+    // edge functions, positive inside, and the depth plane, in pixels
+    struct Triangle {
+        float edge_x[3];
+        float edge_y[3];
+        float edge_c[3];
+        float depth_x;
+        float depth_y;
+        float depth_c;
+        int min_x;
+        int min_y;
+        int max_x;
+        int max_y;
+    };
+
+    unsigned tiles_x_;
+    unsigned tiles_y_;
+
+    glm::mat4 view_projection_ {1.0f};
+    std::vector<Occluder> occluders_ {};
+    std::vector<Level> levels_ {};
+
+    // rebuilt every frame, keeping their capacity
+    std::vector<glm::vec4> clip_ {};
+    std::vector<Triangle> triangles_ {};
+    std::vector<std::vector<unsigned>> bins_ {}; // triangles overlapping each tile
+
+    Stats stats_ {};
+
+    auto Setup(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) -> void;
+    auto RasterizeTile(std::size_t tile) -> void;
+    auto BuildHierarchy() -> void;
+};
\ No newline at end of file
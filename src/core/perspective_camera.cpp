@@ -21,4 +21,21 @@ PerspectiveCamera::PerspectiveCamera(
 
 auto PerspectiveCamera::OnUpdate() -> void {
     view_ = glm::inverse(transform);
+}
+
+auto PerspectiveCamera::SetAspect(float aspect) -> void {
+    // the horizontal focal length is the vertical one over the aspect
+    projection_[0][0] = projection_[1][1] / aspect;
+}
+
+auto PerspectiveCamera::CursorRay(const glm::vec2& cursor, const glm::vec2& viewport) const -> Ray {
+    const auto ndc = glm::vec2 {
+        cursor.x / viewport.x * 2.0f - 1.0f,
+        1.0f - cursor.y / viewport.y * 2.0f
+    };
+    const auto inverse = glm::inverse(projection_ * view_);
+    const auto near_point = inverse * glm::vec4 {ndc.x, ndc.y, -1.0f, 1.0f};
+    const auto far_point = inverse * glm::vec4 {ndc.x, ndc.y, 1.0f, 1.0f};
+    const auto origin = glm::vec3 {near_point} / near_point.w;
+    return {origin, glm::normalize(glm::vec3 {far_point} / far_point.w - origin)};
 }
\ No newline at end of file
@@ -4,6 +4,9 @@
 #pragma once
 
 #include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+
+#include "core/ray.h"
 
 class PerspectiveCamera {
 public:
@@ -26,6 +29,14 @@ public:
 
     auto OnUpdate() -> void;
 
+    // keeps the vertical field of view, e.g. after the window is resized
+    auto SetAspect(float aspect) -> void;
+
+    // from the camera through a cursor position in window coordinates, with
+    // the origin at the top left as in mouse events; the direction is unit
+    // length, so hit distances are in world units
+    [[nodiscard]] auto CursorRay(const glm::vec2& cursor, const glm::vec2& viewport) const -> Ray;
+
 private:
     glm::mat4 projection_ {1.0f};
     glm::mat4 view_ {1.0f};
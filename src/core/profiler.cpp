@@ -0,0 +1,303 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+#include <imgui.h>
+
+namespace {
+
+const auto kEpoch = std::chrono::steady_clock::now();
+
+// marks the buffer for removal when its thread exits, so short-lived
+// loader threads do not leave buffers behind
+struct ThreadBufferOwner {
+    std::atomic<bool>* retired {nullptr};
+
+    ~ThreadBufferOwner() {
+        if (retired) retired->store(true, std::memory_order_release);
+    }
+};
+
+auto EscapeJson(std::string_view text) {
+    auto output = std::string {};
+    for (const auto c : text) {
+        if (c == '"' || c == '\\') output += '\\';
+        output += c;
+    }
+    return output;
+}
+
+} // namespace
+
+auto Profiler::Now() -> std::uint64_t {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - kEpoch
+    ).count());
+}
+
+auto Profiler::LocalBuffer() -> ThreadBuffer& {
+    thread_local auto owner = ThreadBufferOwner {};
+    thread_local auto buffer = static_cast<ThreadBuffer*>(nullptr);
+    if (buffer == nullptr) {
+        auto lock = std::lock_guard {threads_mutex_};
+        auto& added = threads_.emplace_back(std::make_unique<ThreadBuffer>());
+        added->id = next_thread_++;
+        added->name = added->id == 0 ? "Main" : std::format("Thread {}", added->id);
+        buffer = added.get();
+        owner.retired = &buffer->retired;
+    }
+    return *buffer;
+}
+
+auto Profiler::SetThreadName(std::string name) -> void {
+    auto& buffer = LocalBuffer();
+    auto lock = std::lock_guard {threads_mutex_};
+    buffer.name = std::move(name);
+}
+
+auto Profiler::BeginZone() -> std::uint32_t {
+    return LocalBuffer().depth++;
+}
+
+auto Profiler::EndZone(const char* name, std::uint64_t start, std::uint32_t depth) -> void {
+    auto& buffer = LocalBuffer();
+    buffer.depth = depth;
+
+    const auto head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= kBufferSize) {
+        ++buffer.dropped; // EndFrame has not caught up; keep the thread running
+        return;
+    }
+    buffer.records[head % kBufferSize] = {name, start, Now(), depth, buffer.id};
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+auto Profiler::BeginGpuZone(const char* name) -> std::size_t {
+    auto& zones = gpu_frames_[frame_index_ % gpu_frames_.size()].zones;
+    while (free_queries_.size() < 2) {
+        auto query = GLuint {0};
+        glGenQueries(1, &query);
+        free_queries_.emplace_back(query);
+    }
+
+    auto& zone = zones.emplace_back(name, free_queries_.back(), 0, gpu_depth_++);
+    free_queries_.pop_back();
+    zone.end = free_queries_.back();
+    free_queries_.pop_back();
+
+    // timestamps rather than GL_TIME_ELAPSED, which cannot be nested
+    glQueryCounter(zone.begin, GL_TIMESTAMP);
+    return zones.size() - 1;
+}
+
+auto Profiler::EndGpuZone(std::size_t zone) -> void {
+    --gpu_depth_;
+    glQueryCounter(gpu_frames_[frame_index_ % gpu_frames_.size()].zones[zone].end, GL_TIMESTAMP);
+}
+
+auto Profiler::EndFrame() -> void {
+    const auto now = Now();
+
+    auto frame = ProfileFrame {
+        .index = frame_index_,
+        .start = frame_start_,
+        .end = now,
+        .cpu = {},
+        .gpu = {}
+    };
+    Collect(frame);
+
+    auto& gpu_frame = gpu_frames_[frame_index_ % gpu_frames_.size()];
+    auto gpu_now = GLint64 {0};
+    glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+    gpu_frame.index = frame_index_;
+    gpu_frame.clock_offset = static_cast<std::int64_t>(now) - gpu_now;
+
+    // the slot about to be reused holds the frame issued kGpuLatency ago
+    auto& next_gpu_frame = gpu_frames_[(frame_index_ + 1) % gpu_frames_.size()];
+    ResolveGpuFrame(next_gpu_frame);
+
+    if (!paused_) {
+        frames_.emplace_back(std::move(frame));
+        if (frames_.size() > kHistory) frames_.pop_front();
+    }
+
+    ++frame_index_;
+    frame_start_ = now;
+}
+
+auto Profiler::Collect(ProfileFrame& frame) -> void {
+    auto lock = std::lock_guard {threads_mutex_};
+    for (auto& buffer : threads_) {
+        // read retired first; a thread that has exited cannot add records
+        // after its buffer has been drained below
+        const auto retired = buffer->retired.load(std::memory_order_acquire);
+        const auto head = buffer->head.load(std::memory_order_acquire);
+        auto tail = buffer->tail.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            frame.cpu.emplace_back(buffer->records[tail % kBufferSize]);
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+
+        if (retired) buffer.reset();
+    }
+    std::erase(threads_, nullptr);
+}
+
+auto Profiler::ResolveGpuFrame(GpuFrame& gpu_frame) -> void {
+    if (gpu_frame.zones.empty()) return;
+
+    auto available = GLint {0};
+    glGetQueryObjectiv(gpu_frame.zones.back().end, GL_QUERY_RESULT_AVAILABLE, &available);
+
+    auto target = std::ranges::find(frames_, gpu_frame.index, &ProfileFrame::index);
+    for (const auto& zone : gpu_frame.zones) {
+        // results that are still not ready are dropped rather than waited on
+        if (available && target != end(frames_)) {
+            auto begin = GLuint64 {0};
+            auto end = GLuint64 {0};
+            glGetQueryObjectui64v(zone.begin, GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(zone.end, GL_QUERY_RESULT, &end);
+            target->gpu.emplace_back(
+                zone.name,
+                static_cast<std::uint64_t>(static_cast<std::int64_t>(begin) + gpu_frame.clock_offset),
+                static_cast<std::uint64_t>(static_cast<std::int64_t>(end) + gpu_frame.clock_offset),
+                zone.depth,
+                0
+            );
+        }
+        free_queries_.emplace_back(zone.begin);
+        free_queries_.emplace_back(zone.end);
+    }
+    gpu_frame.zones.clear();
+}
+
+auto Profiler::DrawPanel() -> void {
+    if (!ImGui::Begin("Profiler")) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Checkbox("Pause", &paused_);
+    if (frames_.empty()) {
+        ImGui::End();
+        return;
+    }
+
+    auto frame_times = std::vector<float> {};
+    for (const auto& frame : frames_) {
+        frame_times.emplace_back(static_cast<float>(frame.end - frame.start) / 1e6f);
+    }
+    ImGui::PlotLines("Frame (ms)", frame_times.data(), static_cast<int>(frame_times.size()));
+
+    // the newest frame whose GPU zones have had time to arrive
+    const auto& frame = frames_.size() > kGpuLatency
+        ? frames_[frames_.size() - 1 - kGpuLatency]
+        : frames_.front();
+    const auto duration = static_cast<float>(std::max<std::uint64_t>(frame.end - frame.start, 1));
+
+    auto lanes = std::vector<std::pair<std::string, std::vector<const ZoneRecord*>>> {};
+    {
+        auto lock = std::lock_guard {threads_mutex_};
+        for (const auto& buffer : threads_) {
+            lanes.emplace_back(buffer->name, std::vector<const ZoneRecord*> {});
+            for (const auto& zone : frame.cpu) {
+                if (zone.thread == buffer->id) lanes.back().second.emplace_back(&zone);
+            }
+        }
+    }
+    lanes.emplace_back("GPU", std::vector<const ZoneRecord*> {});
+    for (const auto& zone : frame.gpu) lanes.back().second.emplace_back(&zone);
+
+    const auto row = ImGui::GetTextLineHeight() + 4.0f;
+    const auto width = ImGui::GetContentRegionAvail().x;
+    auto draw_list = ImGui::GetWindowDrawList();
+
+    for (const auto& [name, zones] : lanes) {
+        if (zones.empty()) continue;
+        ImGui::TextUnformatted(name.c_str());
+
+        auto depth = std::uint32_t {0};
+        for (const auto zone : zones) depth = std::max(depth, zone->depth + 1);
+
+        const auto origin = ImGui::GetCursorScreenPos();
+        for (const auto zone : zones) {
+            const auto start = static_cast<float>(zone->start - std::min(zone->start, frame.start));
+            const auto end = static_cast<float>(zone->end - std::min(zone->end, frame.start));
+            const auto min = ImVec2 {origin.x + start / duration * width, origin.y + static_cast<float>(zone->depth) * row};
+            const auto max = ImVec2 {origin.x + std::max(end / duration * width, start / duration * width + 1.0f), min.y + row - 1.0f};
+
+            // a stable colour per zone name
+            const auto hash = static_cast<ImU32>(std::hash<std::string_view> {}(zone->name));
+            draw_list->AddRectFilled(min, max, IM_COL32(80 + hash % 120, 80 + (hash >> 8) % 120, 160, 255));
+            if (ImGui::CalcTextSize(zone->name).x < max.x - min.x) {
+                draw_list->AddText(ImVec2 {min.x + 2.0f, min.y + 2.0f}, IM_COL32(255, 255, 255, 255), zone->name);
+            }
+            if (ImGui::IsMouseHoveringRect(min, max)) {
+                ImGui::SetTooltip("%s: %.3f ms", zone->name, static_cast<double>(zone->end - zone->start) / 1e6);
+            }
+        }
+        ImGui::Dummy(ImVec2 {width, static_cast<float>(depth) * row});
+    }
+
+    ImGui::End();
+}
+
+auto Profiler::ExportChromeTrace(const fs::path& path) const -> bool {
+    auto stream = std::ofstream {path, std::ios::trunc};
+    if (!stream) {
+        std::cerr << std::format("Failed to open '{}' for writing\n", path.string());
+        return false;
+    }
+
+    constexpr auto kGpuThread = 1000u;
+    auto separator = "";
+    const auto write = [&](const ZoneRecord& zone, std::uint32_t thread) {
+        stream << std::format(
+            "{}{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+            separator, EscapeJson(zone.name), thread,
+            static_cast<double>(zone.start) / 1e3,
+            static_cast<double>(zone.end - zone.start) / 1e3
+        );
+        separator = ",\n";
+    };
+
+    // timestamps are in microseconds in the trace event format
+    stream << "{\"traceEvents\":[\n";
+    for (const auto& frame : frames_) {
+        for (const auto& zone : frame.cpu) write(zone, zone.thread);
+        for (const auto& zone : frame.gpu) write(zone, kGpuThread);
+    }
+    stream << std::format(
+        "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"GPU\"}}}}",
+        separator, kGpuThread
+    );
+    stream << "\n]}\n";
+    return static_cast<bool>(stream);
+}
+
+auto Profiler::ReleaseGpu() -> void {
+    auto queries = std::move(free_queries_);
+    free_queries_.clear();
+    for (auto& gpu_frame : gpu_frames_) {
+        for (const auto& zone : gpu_frame.zones) {
+            queries.emplace_back(zone.begin);
+            queries.emplace_back(zone.end);
+        }
+        gpu_frame.zones.clear();
+    }
+    if (!queries.empty()) {
+        glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,192 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+// Scoped CPU and GPU zones. Build with PROFILER_ENABLED (the ENABLE_PROFILER
+// CMake option) to record them; otherwise the macros expand to nothing.
+//
+//   PROFILE_ZONE("Name");       times the enclosing scope on this thread
+//   PROFILE_GPU_ZONE("Name");   times the GL commands issued in the scope;
+//                               render thread only
+//   PROFILE_FRAME();            closes the frame; once per frame, after
+//                               the buffer swap
+
+#ifdef PROFILER_ENABLED
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace fs = std::filesystem;
+
+// zone names are stored by pointer, so they have to be string literals
+struct ZoneName {
+    consteval ZoneName(const char* name) : value(name) {}
+
+    const char* value;
+};
+
+struct ZoneRecord {
+    const char* name;
+    std::uint64_t start; // nanoseconds since the profiler started
+    std::uint64_t end;
+    std::uint32_t depth;
+    std::uint32_t thread;
+};
+
+struct ProfileFrame {
+    std::uint64_t index {0};
+    std::uint64_t start {0};
+    std::uint64_t end {0};
+    std::vector<ZoneRecord> cpu {};
+    std::vector<ZoneRecord> gpu {}; // arrives a few frames late
+};
+
+class Profiler {
+public:
+    static constexpr auto kHistory = std::size_t {240};
+
+    // GPU results are read this many frames after they were issued, by
+    // which point they are (almost) always available without a stall
+    static constexpr auto kGpuLatency = std::size_t {4};
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static auto Get() -> Profiler& {
+        static auto instance = Profiler {};
+        return instance;
+    }
+
+    [[nodiscard]] static auto Now() -> std::uint64_t;
+
+    // names the calling thread in the panel and in exported traces
+    auto SetThreadName(std::string name) -> void;
+
+    auto BeginZone() -> std::uint32_t;
+    auto EndZone(const char* name, std::uint64_t start, std::uint32_t depth) -> void;
+
+    auto BeginGpuZone(const char* name) -> std::size_t;
+    auto EndGpuZone(std::size_t zone) -> void;
+
+    auto EndFrame() -> void;
+
+    auto DrawPanel() -> void;
+
+    auto ExportChromeTrace(const fs::path& path) const -> bool;
+
+    [[nodiscard]] auto Frames() const -> const std::deque<ProfileFrame>& { return frames_; }
+
+    // deletes the GPU queries; the windows call this before destroying
+    // their context, since the instance itself outlives main
+    auto ReleaseGpu() -> void;
+
+private:
+    static constexpr auto kBufferSize = std::size_t {1024};
+
+    // Written by its thread, drained by EndFrame; single producer and single
+    // consumer, so the indices are all the synchronisation it needs.
+    struct ThreadBuffer {
+        std::array<ZoneRecord, kBufferSize> records {};
+        std::atomic<std::size_t> head {0};
+        std::atomic<std::size_t> tail {0};
+        std::atomic<bool> retired {false};
+        std::uint32_t id {0};
+        std::uint32_t depth {0};
+        std::uint64_t dropped {0};
+        std::string name {};
+    };
+
+    struct GpuZone {
+        const char* name;
+        GLuint begin;
+        GLuint end;
+        std::uint32_t depth;
+    };
+
+    struct GpuFrame {
+        std::uint64_t index {0};
+        std::int64_t clock_offset {0}; // CPU minus GPU timestamp
+        std::vector<GpuZone> zones {};
+    };
+
+    std::mutex threads_mutex_ {};
+    std::vector<std::unique_ptr<ThreadBuffer>> threads_ {};
+    std::uint32_t next_thread_ {0};
+
+    // the frame being recorded plus the kGpuLatency frames still in flight
+    std::array<GpuFrame, kGpuLatency + 1> gpu_frames_ {};
+    std::vector<GLuint> free_queries_ {};
+    std::uint32_t gpu_depth_ {0};
+
+    std::deque<ProfileFrame> frames_ {};
+    std::uint64_t frame_index_ {0};
+    std::uint64_t frame_start_ {0};
+
+    bool paused_ {false};
+
+    Profiler() = default;
+
+    auto LocalBuffer() -> ThreadBuffer&;
+
+    auto Collect(ProfileFrame& frame) -> void;
+
+    auto ResolveGpuFrame(GpuFrame& gpu_frame) -> void;
+};
+
+class ProfileZone {
+public:
+    explicit ProfileZone(ZoneName name)
+      : name_(name.value),
+        depth_(Profiler::Get().BeginZone()),
+        start_(Profiler::Now()) {}
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+    ~ProfileZone() { Profiler::Get().EndZone(name_, start_, depth_); }
+
+private:
+    const char* name_;
+    std::uint32_t depth_;
+    std::uint64_t start_;
+};
+
+class GpuProfileZone {
+public:
+    explicit GpuProfileZone(ZoneName name) : zone_(Profiler::Get().BeginGpuZone(name.value)) {}
+
+    GpuProfileZone(const GpuProfileZone&) = delete;
+    GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+
+    ~GpuProfileZone() { Profiler::Get().EndGpuZone(zone_); }
+
+private:
+    std::size_t zone_;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) const auto PROFILE_CONCAT(profile_zone_, __LINE__) = ProfileZone {name}
+#define PROFILE_GPU_ZONE(name) const auto PROFILE_CONCAT(profile_gpu_zone_, __LINE__) = GpuProfileZone {name}
+#define PROFILE_FRAME() Profiler::Get().EndFrame()
+#define PROFILE_RELEASE_GPU() Profiler::Get().ReleaseGpu()
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_GPU_ZONE(name)
+#define PROFILE_FRAME()
+#define PROFILE_RELEASE_GPU()
+
+#endif
\ No newline at end of file
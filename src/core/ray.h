@@ -0,0 +1,21 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <glm/vec3.hpp>
+
+// The direction need not be unit length; distances along the ray are in
+// multiples of it, so a ray moved into model space keeps them.
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+
+    [[nodiscard]] auto At(float distance) const { return origin + direction * distance; }
+};
+
+struct RayHit {
+    float distance;
+    glm::vec3 point;
+    unsigned index; // of the triangle or object that was hit
+};
\ No newline at end of file
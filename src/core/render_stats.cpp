@@ -0,0 +1,79 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "render_stats.h"
+
+#ifdef RENDER_STATS_ENABLED
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+#include <imgui.h>
+
+auto RenderStats::EndFrame(double frame_ms) -> void {
+    auto& counters = Local();
+    frames_.emplace_back(frame_index_++, frame_ms, counters);
+    if (frames_.size() > kHistory) frames_.pop_front();
+    if (log_path_) log_.emplace_back(frames_.back());
+    counters = {};
+}
+
+auto RenderStats::Percentiles() const -> FrameTimePercentiles {
+    if (frames_.empty()) return {};
+
+    auto times = std::vector<double> {};
+    times.reserve(frames_.size());
+    for (const auto& frame : frames_) times.emplace_back(frame.frame_ms);
+    std::ranges::sort(times);
+
+    // nearest rank
+    const auto rank = [&](double percentile) {
+        return times[static_cast<std::size_t>(percentile * static_cast<double>(times.size() - 1) + 0.5)];
+    };
+    return {.p50 = rank(0.50), .p95 = rank(0.95), .p99 = rank(0.99)};
+}
+
+auto RenderStats::LogFrames(const fs::path& path) -> void {
+    log_path_ = path;
+}
+
+auto RenderStats::DrawOverlay() const -> void {
+    if (frames_.empty()) return;
+
+    const auto& counters = frames_.back().counters;
+    const auto percentiles = Percentiles();
+
+    ImGui::Begin("Render Stats");
+    ImGui::Text("Frame time p50 %.2f / p95 %.2f / p99 %.2f ms", percentiles.p50, percentiles.p95, percentiles.p99);
+    ImGui::Text("Draw calls: %llu", static_cast<unsigned long long>(counters.draw_calls));
+    ImGui::Text("Triangles: %llu", static_cast<unsigned long long>(counters.triangles));
+    ImGui::Text("Program binds: %llu", static_cast<unsigned long long>(counters.program_binds));
+    ImGui::Text("Texture binds: %llu", static_cast<unsigned long long>(counters.texture_binds));
+    ImGui::Text("VAO binds: %llu", static_cast<unsigned long long>(counters.vao_binds));
+    ImGui::Text("Uniform uploads: %llu", static_cast<unsigned long long>(counters.uniform_uploads));
+    ImGui::Text("Buffer and texture uploads: %llu bytes", static_cast<unsigned long long>(counters.buffer_bytes));
+    ImGui::End();
+}
+
+RenderStats::~RenderStats() {
+    if (!log_path_) return;
+
+    auto stream = std::ofstream {log_path_.value(), std::ios::trunc};
+    stream << "frame,frame_ms,draw_calls,triangles,program_binds,texture_binds,"
+              "vao_binds,uniform_uploads,buffer_bytes\n";
+    for (const auto& [index, frame_ms, counters] : log_) {
+        stream << std::format(
+            "{},{:.4f},{},{},{},{},{},{},{}\n",
+            index, frame_ms, counters.draw_calls, counters.triangles,
+            counters.program_binds, counters.texture_binds, counters.vao_binds,
+            counters.uniform_uploads, counters.buffer_bytes
+        );
+    }
+    if (!stream) {
+        std::cerr << std::format("Failed to write render stats '{}'\n", log_path_->string());
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,99 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+// What each frame costs the GL driver: draw calls, triangles, binds, uniform
+// uploads and the bytes uploaded to buffers and textures. Build with
+// RENDER_STATS_ENABLED (the ENABLE_RENDER_STATS CMake option) to count them;
+// otherwise the macros expand to nothing.
+//
+//   RENDER_STATS_ADD(field, n);        adds n to a RenderCounters field
+//   RENDER_STATS_FRAME(frame_ms);      closes the frame; once per frame
+
+#ifdef RENDER_STATS_ENABLED
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct RenderCounters {
+    std::uint64_t draw_calls {0};
+    std::uint64_t triangles {0};
+    std::uint64_t program_binds {0};
+    std::uint64_t texture_binds {0};
+    std::uint64_t vao_binds {0};
+    std::uint64_t uniform_uploads {0};
+    std::uint64_t buffer_bytes {0}; // buffer and texture uploads
+};
+
+struct RenderFrameStats {
+    std::uint64_t index {0};
+    double frame_ms {0.0};
+    RenderCounters counters {};
+};
+
+struct FrameTimePercentiles {
+    double p50 {0.0};
+    double p95 {0.0};
+    double p99 {0.0};
+};
+
+class RenderStats {
+public:
+    static constexpr auto kHistory = std::size_t {600};
+
+    RenderStats(const RenderStats&) = delete;
+    RenderStats& operator=(const RenderStats&) = delete;
+
+    static auto Get() -> RenderStats& {
+        static auto instance = RenderStats {};
+        return instance;
+    }
+
+    // plain per-thread counters, so counting is an add with no atomics;
+    // only the render thread's are collected, as it owns the GL context
+    static auto Local() -> RenderCounters& {
+        thread_local auto counters = RenderCounters {};
+        return counters;
+    }
+
+    // call on the render thread after the buffer swap
+    auto EndFrame(double frame_ms) -> void;
+
+    // frame time percentiles over the history
+    [[nodiscard]] auto Percentiles() const -> FrameTimePercentiles;
+
+    [[nodiscard]] auto Frames() const -> const std::deque<RenderFrameStats>& { return frames_; }
+
+    // keeps every frame from now on and writes them as CSV on exit
+    auto LogFrames(const fs::path& path) -> void;
+
+    auto DrawOverlay() const -> void;
+
+    ~RenderStats();
+
+private:
+    std::deque<RenderFrameStats> frames_ {};
+    std::uint64_t frame_index_ {0};
+
+    std::optional<fs::path> log_path_ {};
+    std::vector<RenderFrameStats> log_ {};
+
+    RenderStats() = default;
+};
+
+#define RENDER_STATS_ADD(field, value) RenderStats::Local().field += (value)
+#define RENDER_STATS_FRAME(frame_ms) RenderStats::Get().EndFrame(frame_ms)
+
+#else
+
+#define RENDER_STATS_ADD(field, value)
+#define RENDER_STATS_FRAME(frame_ms)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "core/render_target.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+auto RoundUp(int size) {
+    return (size + RenderTarget::kGranularity - 1) / RenderTarget::kGranularity * RenderTarget::kGranularity;
+}
+
+} // namespace
+
+auto RenderTarget::Resize(int width, int height) -> void {
+    width_ = std::max(width, 1);
+    height_ = std::max(height, 1);
+}
+
+auto RenderTarget::Bind() -> void {
+    if (framebuffer_ == 0) {
+        glGenFramebuffers(1, &framebuffer_);
+        glGenRenderbuffers(1, &color_buffer_);
+        glGenRenderbuffers(1, &depth_buffer_);
+    }
+    if (width_ > storage_width_ || height_ > storage_height_) {
+        Allocate();
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, width_, height_);
+}
+
+auto RenderTarget::BlitTo(GLuint framebuffer, int width, int height) const -> void {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    const auto filter = width == width_ && height == height_ ? GL_NEAREST : GL_LINEAR;
+    glBlitFramebuffer(0, 0, width_, height_, 0, 0, width, height, GL_COLOR_BUFFER_BIT, filter);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+auto RenderTarget::Allocate() -> void {
+    // both dimensions grow together, so the storage is never narrower than
+    // before in either
+    storage_width_ = std::max(RoundUp(width_), storage_width_);
+    storage_height_ = std::max(RoundUp(height_), storage_height_);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, storage_width_, storage_height_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, storage_width_, storage_height_);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_buffer_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Render target framebuffer is incomplete\n";
+    }
+
+    ++allocations_;
+}
+
+auto RenderTarget::Release() -> void {
+    if (framebuffer_ == 0) return;
+    glDeleteFramebuffers(1, &framebuffer_);
+    glDeleteRenderbuffers(1, &color_buffer_);
+    glDeleteRenderbuffers(1, &depth_buffer_);
+    framebuffer_ = 0;
+    color_buffer_ = 0;
+    depth_buffer_ = 0;
+    storage_width_ = 0;
+    storage_height_ = 0;
+}
+
+RenderTarget::~RenderTarget() {
+    Release();
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <glad/glad.h>
+
+// An offscreen colour and depth-stencil framebuffer that is drawn at a size
+// up to its storage. Resizing below the storage only changes the viewport;
+// storage grows in steps of kGranularity pixels and never shrinks, so a
+// window dragged larger reallocates a few times rather than every event:
+//
+//   target.Resize(width * scale, height * scale);
+//   target.Bind();
+//   ... draw the scene
+//   target.BlitTo(0, width, height);
+//
+// GL objects are created by the first Bind.
+class RenderTarget {
+public:
+    static constexpr auto kGranularity = 256;
+
+    RenderTarget() = default;
+
+    // deleted copy constructors and assignment operators
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    // sizes below one pixel are drawn at one
+    auto Resize(int width, int height) -> void;
+
+    // binds the framebuffer with the viewport over the size drawn at
+    auto Bind() -> void;
+
+    // stretches the colour drawn to a framebuffer of the given size, 0 for
+    // the window's, and leaves that framebuffer bound with its viewport
+    auto BlitTo(GLuint framebuffer, int width, int height) const -> void;
+
+    [[nodiscard]] auto Width() const { return width_; }
+
+    [[nodiscard]] auto Height() const { return height_; }
+
+    // reallocations so far, for checking that resizing stays cheap
+    [[nodiscard]] auto Allocations() const { return allocations_; }
+
+    // deletes the GL objects while the context is still current; the next
+    // Bind creates them again
+    auto Release() -> void;
+
+    ~RenderTarget();
+
+private:
+    GLuint framebuffer_ {0};
+    GLuint color_buffer_ {0};
+    GLuint depth_buffer_ {0};
+
+    int width_ {1};
+    int height_ {1};
+    int storage_width_ {0};
+    int storage_height_ {0};
+
+    unsigned allocations_ {0};
+
+    auto Allocate() -> void;
+};
\ No newline at end of file
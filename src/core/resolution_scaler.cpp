@@ -0,0 +1,88 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "core/resolution_scaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+ResolutionScaler::ResolutionScaler() : ResolutionScaler(Parameters {}) {}
+
+ResolutionScaler::ResolutionScaler(const Parameters& params) : params_(params) {
+    stats_.scale = params_.max_scale;
+}
+
+auto ResolutionScaler::BeginFrame() -> void {
+    if (queries_.front() == 0) {
+        glGenQueries(static_cast<GLsizei>(kLatency), queries_.data());
+    }
+
+    // the slot about to be reused holds the frame issued kLatency ago;
+    // results that are still not ready are dropped rather than waited on
+    const auto slot = frame_ % kLatency;
+    if (issued_[slot]) {
+        auto available = GLint {0};
+        glGetQueryObjectiv(queries_[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            auto elapsed = GLuint64 {0};
+            glGetQueryObjectui64v(queries_[slot], GL_QUERY_RESULT, &elapsed);
+            AddSample(static_cast<double>(elapsed) / 1e6);
+        }
+        issued_[slot] = false;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, queries_[slot]);
+}
+
+auto ResolutionScaler::EndFrame() -> void {
+    glEndQuery(GL_TIME_ELAPSED);
+    issued_[frame_ % kLatency] = true;
+    ++frame_;
+}
+
+auto ResolutionScaler::AddSample(double gpu_ms) -> void {
+    // frames that were in flight during a change were drawn at the old scale
+    if (skip_ > 0) {
+        --skip_;
+        return;
+    }
+
+    sum_ms_ += gpu_ms;
+    if (++samples_ < params_.window) return;
+
+    const auto average = sum_ms_ / samples_;
+    sum_ms_ = 0.0;
+    samples_ = 0;
+    stats_.gpu_ms = average;
+
+    auto scale = stats_.scale;
+    if (average > params_.budget_ms) {
+        scale = std::min(Fit(average), stats_.scale - params_.step);
+    } else if (average < params_.budget_ms * params_.grow_below) {
+        // one step up, unless that alone would go over the budget
+        const auto grown = stats_.scale + params_.step;
+        const auto ratio = grown / stats_.scale;
+        if (average * ratio * ratio <= params_.budget_ms) scale = grown;
+    }
+    scale = std::clamp(Snap(scale), params_.min_scale, params_.max_scale);
+
+    if (scale != stats_.scale) {
+        stats_.scale = scale;
+        ++stats_.changes;
+        skip_ = kLatency;
+    }
+}
+
+auto ResolutionScaler::Fit(double gpu_ms) const -> float {
+    const auto fit = stats_.scale * static_cast<float>(std::sqrt(params_.budget_ms / gpu_ms));
+    // down to a step, so the next window lands under the budget
+    return std::floor(fit / params_.step + 1e-3f) * params_.step;
+}
+
+auto ResolutionScaler::Snap(float scale) const -> float {
+    return std::round(scale / params_.step) * params_.step;
+}
+
+ResolutionScaler::~ResolutionScaler() {
+    if (queries_.front() == 0) return;
+    glDeleteQueries(static_cast<GLsizei>(kLatency), queries_.data());
+}
\ No newline at end of file
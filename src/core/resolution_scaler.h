@@ -0,0 +1,77 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+// Picks the scale the scene is rendered at from its GPU time, measured with
+// GL_TIME_ELAPSED queries around it. Samples are averaged over a window of
+// frames; over budget the scale drops to where the average would have fit,
+// and only well under budget does it rise, one step at a time, so it does
+// not flip between two sizes. Pixel cost goes with the square of the scale.
+class ResolutionScaler {
+public:
+    // results are read this many frames after they were issued
+    static constexpr auto kLatency = std::size_t {4};
+
+    struct Parameters {
+        double budget_ms {14.0}; // GPU time of the scene per frame
+        float min_scale {0.5f};
+        float max_scale {1.0f};
+        float step {0.05f};      // scales are multiples of this
+        double grow_below {0.7}; // share of the budget under which to grow
+        unsigned window {16};    // frames averaged between changes
+    };
+
+    struct Stats {
+        float scale {1.0f};
+        double gpu_ms {0.0}; // the last average
+        unsigned changes {0};
+    };
+
+    ResolutionScaler();
+
+    explicit ResolutionScaler(const Parameters& params);
+
+    // deleted copy constructors and assignment operators
+    ResolutionScaler(const ResolutionScaler&) = delete;
+    ResolutionScaler& operator=(const ResolutionScaler&) = delete;
+
+    // time the GL commands in between; render thread only, once per frame
+    auto BeginFrame() -> void;
+    auto EndFrame() -> void;
+
+    // feeds one frame's GPU time; EndFrame does so for its queries
+    auto AddSample(double gpu_ms) -> void;
+
+    [[nodiscard]] auto Scale() const { return stats_.scale; }
+
+    [[nodiscard]] auto GetParameters() const -> const Parameters& { return params_; }
+
+    [[nodiscard]] auto GetStats() const -> const Stats& { return stats_; }
+
+    ~ResolutionScaler();
+
+private:
+    Parameters params_;
+
+    Stats stats_ {};
+
+    double sum_ms_ {0.0};
+    unsigned samples_ {0};
+    std::size_t skip_ {0};
+
+    std::array<GLuint, kLatency> queries_ {};
+    std::array<bool, kLatency> issued_ {};
+    std::size_t frame_ {0};
+
+    // the scale the averaged frames would have fit the budget at
+    [[nodiscard]] auto Fit(double gpu_ms) const -> float;
+
+    // rounds away the error of adding steps
+    [[nodiscard]] auto Snap(float scale) const -> float;
+};
\ No newline at end of file
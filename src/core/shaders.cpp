@@ -7,6 +7,15 @@
 #include <iostream>
 #include <string>
 
+#include "core/render_stats.h"
+
+namespace {
+
+// the program last made current; GL state belongs to the render thread
+auto bound_program = GLuint {0};
+
+} // namespace
+
 Shaders::Shaders(const std::vector<ShaderInfo>& shaders) {
     program_ = glCreateProgram();
 
@@ -28,7 +37,12 @@ Shaders::Shaders(const std::vector<ShaderInfo>& shaders) {
 }
 
 auto Shaders::Use() const -> void {
+    // every SetUniform comes through here, so only a change of program
+    // reaches GL and the stats
+    if (bound_program == program_) return;
     glUseProgram(program_);
+    bound_program = program_;
+    RENDER_STATS_ADD(program_binds, 1);
 }
 
 auto Shaders::GetShaderType(ShaderType type) const -> unsigned int {
@@ -102,26 +116,32 @@ auto Shaders::GetUniform(std::string_view name) const -> GLint {
 
 auto Shaders::SetUniform(std::string_view uniform, int i) const -> void {
     glUniform1i(GetUniform(uniform), i);
+    RENDER_STATS_ADD(uniform_uploads, 1);
 }
 
 auto Shaders::SetUniform(std::string_view uniform, const float f) const -> void {
     glUniform1f(GetUniform(uniform), f);
+    RENDER_STATS_ADD(uniform_uploads, 1);
 }
 
 auto Shaders::SetUniform(std::string_view uniform, const glm::vec3& vec) const -> void {
     glUniform3fv(GetUniform(uniform), 1, &vec[0]);
+    RENDER_STATS_ADD(uniform_uploads, 1);
 }
 
 auto Shaders::SetUniform(std::string_view uniform, const glm::mat3& matrix) const -> void {
     glUniformMatrix3fv(GetUniform(uniform), 1, GL_FALSE, &matrix[0][0]);
+    RENDER_STATS_ADD(uniform_uploads, 1);
 }
 
 auto Shaders::SetUniform(std::string_view uniform, const glm::mat4& matrix) const -> void {
     glUniformMatrix4fv(GetUniform(uniform), 1, GL_FALSE, &matrix[0][0]);
+    RENDER_STATS_ADD(uniform_uploads, 1);
 }
 
 Shaders::~Shaders() {
     if (program_) {
         glDeleteProgram(program_);
+        if (bound_program == program_) bound_program = 0;
     }
 }
\ No newline at end of file
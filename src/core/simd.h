@@ -0,0 +1,203 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+// Four floats processed together: SSE2 on x86-64, NEON on ARM64 and plain
+// loops elsewhere. Both instruction sets are part of the base ABI, so no
+// compiler flags are needed. Comparisons return all-ones or all-zero lanes
+// for Select.
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_NEON
+#include <arm_neon.h>
+#else
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#endif
+
+struct Float4 {
+#if defined(SIMD_SSE2)
+    __m128 v;
+
+    [[nodiscard]] static auto Load(const float* p) -> Float4 { return {_mm_loadu_ps(p)}; }
+
+    [[nodiscard]] static auto Broadcast(float x) -> Float4 { return {_mm_set1_ps(x)}; }
+
+    [[nodiscard]] static auto Set(float a, float b, float c, float d) -> Float4 {
+        return {_mm_setr_ps(a, b, c, d)};
+    }
+
+    // converts four integers at once
+    [[nodiscard]] static auto Convert(int a, int b, int c, int d) -> Float4 {
+        return {_mm_cvtepi32_ps(_mm_setr_epi32(a, b, c, d))};
+    }
+
+    auto Store(float* p) const -> void { _mm_storeu_ps(p, v); }
+
+    friend auto operator+(Float4 a, Float4 b) -> Float4 { return {_mm_add_ps(a.v, b.v)}; }
+    friend auto operator-(Float4 a, Float4 b) -> Float4 { return {_mm_sub_ps(a.v, b.v)}; }
+    friend auto operator*(Float4 a, Float4 b) -> Float4 { return {_mm_mul_ps(a.v, b.v)}; }
+    friend auto operator/(Float4 a, Float4 b) -> Float4 { return {_mm_div_ps(a.v, b.v)}; }
+
+    friend auto Min(Float4 a, Float4 b) -> Float4 { return {_mm_min_ps(a.v, b.v)}; }
+    friend auto Max(Float4 a, Float4 b) -> Float4 { return {_mm_max_ps(a.v, b.v)}; }
+    friend auto Sqrt(Float4 a) -> Float4 { return {_mm_sqrt_ps(a.v)}; }
+
+    // rounds towards zero
+    friend auto Truncate(Float4 a) -> Float4 { return {_mm_cvtepi32_ps(_mm_cvttps_epi32(a.v))}; }
+
+    friend auto LessThan(Float4 a, Float4 b) -> Float4 { return {_mm_cmplt_ps(a.v, b.v)}; }
+
+    // one bit per lane of a comparison, the first lane lowest
+    friend auto Mask(Float4 mask) -> int { return _mm_movemask_ps(mask.v); }
+
+    // lanes of a where mask is set, of b elsewhere
+    friend auto Select(Float4 mask, Float4 a, Float4 b) -> Float4 {
+        return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+    }
+
+    // rows become columns: a holds the first lane of each afterwards
+    friend auto Transpose(Float4& a, Float4& b, Float4& c, Float4& d) -> void {
+        _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+    }
+#elif defined(SIMD_NEON)
+    float32x4_t v;
+
+    [[nodiscard]] static auto Load(const float* p) -> Float4 { return {vld1q_f32(p)}; }
+
+    [[nodiscard]] static auto Broadcast(float x) -> Float4 { return {vdupq_n_f32(x)}; }
+
+    [[nodiscard]] static auto Set(float a, float b, float c, float d) -> Float4 {
+        const float lanes[4] {a, b, c, d};
+        return {vld1q_f32(lanes)};
+    }
+
+    // converts four integers at once
+    [[nodiscard]] static auto Convert(int a, int b, int c, int d) -> Float4 {
+        const int lanes[4] {a, b, c, d};
+        return {vcvtq_f32_s32(vld1q_s32(lanes))};
+    }
+
+    auto Store(float* p) const -> void { vst1q_f32(p, v); }
+
+    friend auto operator+(Float4 a, Float4 b) -> Float4 { return {vaddq_f32(a.v, b.v)}; }
+    friend auto operator-(Float4 a, Float4 b) -> Float4 { return {vsubq_f32(a.v, b.v)}; }
+    friend auto operator*(Float4 a, Float4 b) -> Float4 { return {vmulq_f32(a.v, b.v)}; }
+    friend auto operator/(Float4 a, Float4 b) -> Float4 { return {vdivq_f32(a.v, b.v)}; }
+
+    friend auto Min(Float4 a, Float4 b) -> Float4 { return {vminq_f32(a.v, b.v)}; }
+    friend auto Max(Float4 a, Float4 b) -> Float4 { return {vmaxq_f32(a.v, b.v)}; }
+    friend auto Sqrt(Float4 a) -> Float4 { return {vsqrtq_f32(a.v)}; }
+
+    // rounds towards zero
+    friend auto Truncate(Float4 a) -> Float4 { return {vcvtq_f32_s32(vcvtq_s32_f32(a.v))}; }
+
+    friend auto LessThan(Float4 a, Float4 b) -> Float4 {
+        return {vreinterpretq_f32_u32(vcltq_f32(a.v, b.v))};
+    }
+
+    // one bit per lane of a comparison, the first lane lowest
+    friend auto Mask(Float4 mask) -> int {
+        const uint32_t weights[4] {1, 2, 4, 8};
+        const auto bits = vshrq_n_u32(vreinterpretq_u32_f32(mask.v), 31);
+        return static_cast<int>(vaddvq_u32(vmulq_u32(bits, vld1q_u32(weights))));
+    }
+
+    // lanes of a where mask is set, of b elsewhere
+    friend auto Select(Float4 mask, Float4 a, Float4 b) -> Float4 {
+        return {vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v)};
+    }
+
+    // rows become columns: a holds the first lane of each afterwards
+    friend auto Transpose(Float4& a, Float4& b, Float4& c, Float4& d) -> void {
+        const auto ab = vtrnq_f32(a.v, b.v);
+        const auto cd = vtrnq_f32(c.v, d.v);
+        a.v = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        b.v = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        c.v = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        d.v = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+#else
+    std::array<float, 4> v;
+
+    [[nodiscard]] static auto Load(const float* p) -> Float4 { return {{p[0], p[1], p[2], p[3]}}; }
+
+    [[nodiscard]] static auto Broadcast(float x) -> Float4 { return {{x, x, x, x}}; }
+
+    [[nodiscard]] static auto Set(float a, float b, float c, float d) -> Float4 { return {{a, b, c, d}}; }
+
+    // converts four integers at once
+    [[nodiscard]] static auto Convert(int a, int b, int c, int d) -> Float4 {
+        return {{static_cast<float>(a), static_cast<float>(b), static_cast<float>(c), static_cast<float>(d)}};
+    }
+
+    auto Store(float* p) const -> void { for (auto i = 0; i < 4; ++i) p[i] = v[i]; }
+
+    template <typename Op>
+    [[nodiscard]] static auto Map(Float4 a, Float4 b, Op op) -> Float4 {
+        return {{op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3])}};
+    }
+
+    friend auto operator+(Float4 a, Float4 b) -> Float4 { return Map(a, b, [](float x, float y) { return x + y; }); }
+    friend auto operator-(Float4 a, Float4 b) -> Float4 { return Map(a, b, [](float x, float y) { return x - y; }); }
+    friend auto operator*(Float4 a, Float4 b) -> Float4 { return Map(a, b, [](float x, float y) { return x * y; }); }
+    friend auto operator/(Float4 a, Float4 b) -> Float4 { return Map(a, b, [](float x, float y) { return x / y; }); }
+
+    friend auto Min(Float4 a, Float4 b) -> Float4 { return Map(a, b, [](float x, float y) { return y < x ? y : x; }); }
+    friend auto Max(Float4 a, Float4 b) -> Float4 { return Map(a, b, [](float x, float y) { return x < y ? y : x; }); }
+    friend auto Sqrt(Float4 a) -> Float4 { return Map(a, a, [](float x, float) { return std::sqrt(x); }); }
+
+    // rounds towards zero
+    friend auto Truncate(Float4 a) -> Float4 { return Map(a, a, [](float x, float) { return std::trunc(x); }); }
+
+    friend auto LessThan(Float4 a, Float4 b) -> Float4 {
+        return Map(a, b, [](float x, float y) {
+            const auto bits = x < y ? ~std::uint32_t {0} : std::uint32_t {0};
+            auto mask = 0.0f;
+            std::memcpy(&mask, &bits, sizeof(mask));
+            return mask;
+        });
+    }
+
+    // one bit per lane of a comparison, the first lane lowest
+    friend auto Mask(Float4 mask) -> int {
+        auto result = 0;
+        for (auto i = 0; i < 4; ++i) {
+            auto bits = std::uint32_t {0};
+            std::memcpy(&bits, &mask.v[i], sizeof(bits));
+            if (bits) result |= 1 << i;
+        }
+        return result;
+    }
+
+    // lanes of a where mask is set, of b elsewhere
+    friend auto Select(Float4 mask, Float4 a, Float4 b) -> Float4 {
+        auto result = Float4 {};
+        for (auto i = 0; i < 4; ++i) {
+            auto bits = std::uint32_t {0};
+            std::memcpy(&bits, &mask.v[i], sizeof(bits));
+            result.v[i] = bits ? a.v[i] : b.v[i];
+        }
+        return result;
+    }
+
+    // rows become columns: a holds the first lane of each afterwards
+    friend auto Transpose(Float4& a, Float4& b, Float4& c, Float4& d) -> void {
+        auto rows = std::array {a.v, b.v, c.v, d.v};
+        for (auto i = 0; i < 4; ++i) {
+            a.v[i] = rows[i][0];
+            b.v[i] = rows[i][1];
+            c.v[i] = rows[i][2];
+            d.v[i] = rows[i][3];
+        }
+    }
+#endif
+
+    friend auto operator-(Float4 a) -> Float4 { return Broadcast(0.0f) - a; }
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "simulation_thread.h"
+
+#include "core/profiler.h"
+#include "core/timer.h"
+
+SimulationThread::SimulationThread(SimulationCallback simulate, Latency latency)
+  : simulate_(std::move(simulate)), latency_(latency) {
+    thread_ = std::jthread {[this](std::stop_token stop) { Run(stop); }};
+}
+
+auto SimulationThread::Sync() -> void {
+    const auto timer = Timer {};
+    Wait();
+    stats_.wait_ms = timer.GetSeconds() * 1000.0;
+}
+
+auto SimulationThread::Kick(double delta) -> void {
+    {
+        auto lock = std::lock_guard {mutex_};
+        delta_ = delta;
+        kicked_ = true;
+    }
+    changed_.notify_all();
+
+    if (latency_ == Latency::kNone) Wait();
+}
+
+auto SimulationThread::Wait() -> void {
+    auto lock = std::unique_lock {mutex_};
+    changed_.wait(lock, [this] { return !kicked_; });
+
+    if (recorded_) {
+        front_ = 1 - front_;
+        recorded_ = false;
+        stats_.simulate_ms = simulate_ms_;
+    }
+}
+
+auto SimulationThread::Run(std::stop_token stop) -> void {
+#ifdef PROFILER_ENABLED
+    Profiler::Get().SetThreadName("Simulation");
+#endif
+
+    while (true) {
+        auto delta = 0.0;
+        {
+            auto lock = std::unique_lock {mutex_};
+            if (!changed_.wait(lock, stop, [this] { return kicked_; })) return;
+            delta = delta_;
+        }
+
+        // the render thread only reads the front list until the next Wait
+        auto& commands = lists_[1 - front_];
+        const auto timer = Timer {};
+        commands.Reset();
+        {
+            PROFILE_ZONE("Simulate");
+            simulate_(delta, commands);
+        }
+        const auto simulate_ms = timer.GetSeconds() * 1000.0;
+
+        {
+            auto lock = std::lock_guard {mutex_};
+            simulate_ms_ = simulate_ms;
+            recorded_ = true;
+            kicked_ = false;
+        }
+        changed_.notify_all();
+    }
+}
+
+SimulationThread::~SimulationThread() {
+    // a frame still being recorded may use state owned by the caller
+    Wait();
+    thread_.request_stop();
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/command_list.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using SimulationCallback = std::function<void(const double delta, CommandList& commands)>;
+
+// Runs the simulation on its own thread. Each frame the callback records
+// into one of two command lists while the render thread executes the other.
+//
+// The render thread drives it in three steps (Window::Start does this):
+//
+//   Sync()       waits for the frame being recorded and makes it current;
+//                the simulation is idle until Kick, so this is where input
+//                and main-thread work may touch simulation state
+//   Kick(delta)  starts recording the next frame
+//   Commands()   the current list, for the render thread to execute
+//
+// With one frame of latency the render thread draws frame N while frame
+// N + 1 is recorded. Without latency Kick waits for the recording, which
+// keeps the threads in lockstep but shows input on the same frame.
+class SimulationThread {
+public:
+    enum class Latency {
+        kNone,
+        kOneFrame
+    };
+
+    struct Stats {
+        double simulate_ms {0.0}; // time spent recording the last frame
+        double wait_ms {0.0};     // time the render thread waited in Sync
+    };
+
+    explicit SimulationThread(SimulationCallback simulate, Latency latency = Latency::kOneFrame);
+
+    // deleted copy constructors and assignment operators
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    auto Sync() -> void;
+
+    auto Kick(double delta) -> void;
+
+    [[nodiscard]] auto Commands() const -> const CommandList& { return lists_[front_]; }
+
+    [[nodiscard]] auto GetStats() const -> const Stats& { return stats_; }
+
+    ~SimulationThread();
+
+private:
+    SimulationCallback simulate_;
+
+    Latency latency_;
+
+    std::array<CommandList, 2> lists_ {};
+    std::size_t front_ {0};
+
+    std::mutex mutex_ {};
+    std::condition_variable_any changed_ {};
+
+    double delta_ {0.0};
+    double simulate_ms_ {0.0};
+    bool kicked_ {false};
+    bool recorded_ {false};
+
+    Stats stats_ {};
+
+    std::jthread thread_ {};
+
+    auto Run(std::stop_token stop) -> void;
+
+    auto Wait() -> void;
+};
\ No newline at end of file
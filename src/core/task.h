@@ -0,0 +1,293 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/main_thread_queue.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Coroutine primitives for asset loading. Continuations are resumed on the
+// render thread: loader completions are delivered through MainThreadQueue,
+// which Window::Start drains every frame, so code after a co_await is free
+// to make GL calls.
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation {};
+    std::exception_ptr exception {};
+
+    struct FinalAwaiter {
+        auto await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        auto await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+            -> std::coroutine_handle<> {
+            if (auto continuation = handle.promise().continuation) {
+                return continuation;
+            }
+            return std::noop_coroutine();
+        }
+
+        auto await_resume() const noexcept {}
+    };
+
+    auto initial_suspend() const noexcept { return std::suspend_always {}; }
+
+    auto final_suspend() const noexcept { return FinalAwaiter {}; }
+
+    auto unhandled_exception() noexcept { exception = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : PromiseBase {
+    std::optional<T> value {};
+
+    auto get_return_object() -> Task<T>;
+
+    auto return_value(T result) { value.emplace(std::move(result)); }
+
+    auto Result() -> T {
+        if (exception) std::rethrow_exception(exception);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : PromiseBase {
+    auto get_return_object() -> Task<void>;
+
+    auto return_void() const noexcept {}
+
+    auto Result() const {
+        if (exception) std::rethrow_exception(exception);
+    }
+};
+
+} // namespace detail
+
+// Lazily started coroutine; runs when awaited or passed to Spawn.
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+    auto operator=(Task&& other) noexcept -> Task& {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    // deleted copy constructors and assignment operators
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            auto await_ready() const noexcept { return !handle || handle.done(); }
+
+            auto await_suspend(std::coroutine_handle<> continuation) noexcept {
+                handle.promise().continuation = continuation;
+                return handle;
+            }
+
+            auto await_resume() -> T { return handle.promise().Result(); }
+        };
+        return Awaiter {handle_};
+    }
+
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename T>
+auto detail::TaskPromise<T>::get_return_object() -> Task<T> {
+    return Task<T> {std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+
+inline auto detail::TaskPromise<void>::get_return_object() -> Task<void> {
+    return Task<void> {std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+
+// Eagerly started operation whose result is set exactly once, on the render
+// thread. Copies share the same state.
+template <typename T>
+class Future {
+public:
+    Future() : state_(std::make_shared<State>()) {}
+
+    auto Set(T value) {
+        state_->value.emplace(std::move(value));
+        if (auto continuation = std::exchange(state_->continuation, {})) {
+            continuation.resume();
+        }
+    }
+
+    [[nodiscard]] auto IsReady() const { return state_->value.has_value(); }
+
+    auto await_ready() const noexcept { return IsReady(); }
+
+    auto await_suspend(std::coroutine_handle<> continuation) noexcept {
+        state_->continuation = continuation;
+    }
+
+    auto await_resume() -> T { return std::move(*state_->value); }
+
+private:
+    struct State {
+        std::optional<T> value {};
+        std::coroutine_handle<> continuation {};
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+// Suspends until the next MainThreadQueue drain; can also be used to hop
+// from a worker thread back onto the render thread.
+inline auto NextFrame() noexcept {
+    struct Awaiter {
+        auto await_ready() const noexcept { return false; }
+
+        auto await_suspend(std::coroutine_handle<> handle) const {
+            MainThreadQueue::Get().Post([handle]() { handle.resume(); });
+        }
+
+        auto await_resume() const noexcept {}
+    };
+    return Awaiter {};
+}
+
+namespace detail {
+
+struct Detached {
+    struct promise_type {
+        auto get_return_object() const noexcept { return Detached {}; }
+        auto initial_suspend() const noexcept { return std::suspend_never {}; }
+        auto final_suspend() const noexcept { return std::suspend_never {}; }
+        auto return_void() const noexcept {}
+        auto unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+template <typename Awaitable>
+struct AwaitTraits {};
+
+template <typename Awaitable> requires requires(Awaitable a) { a.await_resume(); }
+struct AwaitTraits<Awaitable> {
+    using Result = decltype(std::declval<Awaitable>().await_resume());
+};
+
+template <typename T>
+struct AwaitTraits<Task<T>> {
+    using Result = T;
+};
+
+// what WhenAll collects for an awaitable; void ones yield std::monostate
+template <typename Awaitable>
+using WhenAllResult = std::conditional_t<
+    std::is_void_v<typename AwaitTraits<Awaitable>::Result>,
+    std::monostate,
+    typename AwaitTraits<Awaitable>::Result
+>;
+
+// single-threaded latch; all participants resume on the render thread
+struct WhenAllLatch {
+    std::size_t remaining {0};
+    std::coroutine_handle<> waiter {};
+
+    auto Arrive() {
+        if (--remaining == 0 && waiter) {
+            std::exchange(waiter, {}).resume();
+        }
+    }
+
+    auto await_ready() const noexcept { return remaining == 0; }
+
+    auto await_suspend(std::coroutine_handle<> handle) noexcept { waiter = handle; }
+
+    auto await_resume() const noexcept {}
+};
+
+template <typename Awaitable, typename Result>
+auto WhenAllItem(Awaitable awaitable, std::optional<Result>& result, WhenAllLatch& latch) -> Detached {
+    if constexpr (std::is_void_v<typename AwaitTraits<Awaitable>::Result>) {
+        co_await std::move(awaitable);
+        result.emplace();
+    } else {
+        result.emplace(co_await std::move(awaitable));
+    }
+    latch.Arrive();
+}
+
+} // namespace detail
+
+// Starts a task without awaiting it. The coroutine frame frees itself when
+// the task completes; exceptions escaping the task terminate the program.
+inline auto Spawn(Task<void> task) -> void {
+    [](Task<void> task) -> detail::Detached {
+        co_await std::move(task);
+    }(std::move(task));
+}
+
+// Starts every awaitable before suspending, so independent loads run in
+// parallel; resumes once all of them have completed. Awaitables without a
+// result, such as Task<>, yield std::monostate.
+template <typename Awaitable>
+auto WhenAll(std::vector<Awaitable> awaitables)
+    -> Task<std::vector<detail::WhenAllResult<Awaitable>>> {
+    using Result = detail::WhenAllResult<Awaitable>;
+
+    auto results = std::vector<std::optional<Result>>(awaitables.size());
+    auto latch = detail::WhenAllLatch {awaitables.size()};
+    for (auto i = std::size_t {0}; i < awaitables.size(); ++i) {
+        detail::WhenAllItem(std::move(awaitables[i]), results[i], latch);
+    }
+    co_await latch;
+
+    auto output = std::vector<Result> {};
+    output.reserve(results.size());
+    for (auto& result : results) {
+        output.emplace_back(std::move(*result));
+    }
+    co_return output;
+}
+
+template <typename... Awaitables>
+auto WhenAll(Awaitables... awaitables)
+    -> Task<std::tuple<detail::WhenAllResult<Awaitables>...>> {
+    auto results = std::tuple<std::optional<detail::WhenAllResult<Awaitables>>...> {};
+    auto latch = detail::WhenAllLatch {sizeof...(Awaitables)};
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (detail::WhenAllItem(std::move(awaitables), std::get<I>(results), latch), ...);
+    }(std::index_sequence_for<Awaitables...> {});
+    co_await latch;
+
+    co_return std::apply([](auto&... result) {
+        return std::tuple {std::move(*result)...};
+    }, results);
+}
\ No newline at end of file
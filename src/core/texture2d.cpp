@@ -7,6 +7,8 @@
 
 #include <iostream>
 
+#include "core/render_stats.h"
+
 Texture2D::Texture2D(std::shared_ptr<Image> image) {
     InitTexture(image);
 }
@@ -26,6 +28,7 @@ auto Texture2D::InitTexture(std::shared_ptr<Image> image) -> void {
         GL_UNSIGNED_BYTE,
         image->Data()
     );
+    RENDER_STATS_ADD(buffer_bytes, static_cast<std::uint64_t>(image->width) * image->height * 4);
     is_loaded_ = true;
 }
 
@@ -51,6 +54,7 @@ auto Texture2D::Bind() -> void {
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, texture_id_);
+    RENDER_STATS_ADD(texture_binds, 1);
 }
 
 Texture2D::~Texture2D() {
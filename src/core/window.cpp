@@ -3,6 +3,7 @@
 
 #include "window.h"
 
+#include <cmath>
 #include <format>
 #include <iostream>
 
@@ -12,12 +13,19 @@
 #include <imgui/imgui_impl_opengl3.h>
 
 #include "events.h"
-#include "event_dispatcher.h"
+#include "event_bus.h"
+#include "main_thread_queue.h"
+#include "profiler.h"
+#include "render_stats.h"
 
 static auto glfwMouseButtonMap(int button) -> MouseButton;
 static auto glfwCursorPosCallback(GLFWwindow*, double x, double y) -> void;
 static auto glfwMouseButtonCallback(GLFWwindow*, int button, int action, int mods) -> void;
 static auto glfwScrollCallback(GLFWwindow*, double x, double y) -> void;
+static auto glfwKeyCallback(GLFWwindow*, int key, int scancode, int action, int mods) -> void;
+static auto glfwCharCallback(GLFWwindow*, unsigned int codepoint) -> void;
+static auto glfwRefreshCallback(GLFWwindow*) -> void;
+static auto glfwFramebufferSizeCallback(GLFWwindow*, int width, int height) -> void;
 
 static auto imguiInitialize(GLFWwindow* window) -> void;
 static auto imguiBeforeRender() -> void;
@@ -45,7 +53,7 @@ Window::Window(int width, int height, std::string_view title) {
     glfwWindowHint(GLFW_STENCIL_BITS, 8);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
     #ifdef __APPLE__
         glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_TRUE);
@@ -62,37 +70,169 @@ Window::Window(int width, int height, std::string_view title) {
         return;
     }
 
-    glfwSwapInterval(0); // disable vsync
+    glfwSwapInterval(pacer_.SwapInterval()); // unlimited until SetFramePacer
     glfwSetWindowUserPointer(window_, this);
     glfwSetCursorPosCallback(window_, glfwCursorPosCallback);
     glfwSetMouseButtonCallback(window_, glfwMouseButtonCallback);
     glfwSetScrollCallback(window_, glfwScrollCallback);
+    glfwSetKeyCallback(window_, glfwKeyCallback);
+    glfwSetCharCallback(window_, glfwCharCallback);
+    glfwSetWindowRefreshCallback(window_, glfwRefreshCallback);
+    glfwSetFramebufferSizeCallback(window_, glfwFramebufferSizeCallback);
+
+    // posted work has to wake a loop that is idle in glfwWaitEventsTimeout
+    MainThreadQueue::Get().SetWakeCallback(glfwPostEmptyEvent);
+    EventBus::Get().SetWakeCallback(glfwPostEmptyEvent);
 
     imguiInitialize(window_);
 
-    auto buffer_width {0}, buffer_height {0};
-    glfwGetFramebufferSize(window_, &buffer_width, &buffer_height);
-    glViewport(0, 0, buffer_width, buffer_height);
+    glfwGetFramebufferSize(window_, &framebuffer_width_, &framebuffer_height_);
+    glViewport(0, 0, framebuffer_width_, framebuffer_height_);
 }
 
 auto Window::Start(const std::function<void(const double delta)> &program) -> void {
     timer_.Reset();
 
     while(!glfwWindowShouldClose(window_)) {
+        if (!ShouldRender()) {
+            // checking again after publishing idle_ means a RequestRedraw
+            // from another thread either is seen here or posts a wake-up
+            idle_.store(true);
+            if (!ShouldRender()) glfwWaitEventsTimeout(0.5);
+            idle_.store(false);
+
+            // time spent idle is not part of the next frame's delta
+            timer_.Reset();
+            continue;
+        }
+        if (pending_frames_.load() > 0) --pending_frames_;
+
         imguiBeforeRender();
 
-        auto delta = timer_.GetSeconds();
+        const auto elapsed = timer_.GetSeconds();
+        const auto delta = replay_ ? replay_timestep_ : elapsed;
         timer_.Reset();
 
-        program(delta);
-
-        imguiAfterRender();
-        glfwSwapBuffers(window_);
+        if (simulation_thread_) {
+            PROFILE_ZONE("Sync");
+            simulation_thread_->Sync();
+        }
+
+        if (resized_) ApplyResize();
+
+        {
+            PROFILE_ZONE("Drain");
+            MainThreadQueue::Get().Drain();
+            EventBus::Get().Drain();
+        }
+
+        {
+            PROFILE_ZONE("Events");
+            if (replay_) {
+                event_queue.Clear(); // live input is ignored while replaying
+                replay_->Dispatch(frame_);
+            } else {
+                if (recorder_) recorder_->SetFrame(frame_);
+                event_queue.Dispatch();
+            }
+        }
+
+        if (simulation_) simulation_->Advance(delta);
+        if (simulation_thread_) simulation_thread_->Kick(delta);
+
+        if (scaler_) {
+            scaler_->BeginFrame();
+            const auto scale = scaler_->Scale();
+            target_.Resize(
+                static_cast<int>(std::lround(framebuffer_width_ * scale)),
+                static_cast<int>(std::lround(framebuffer_height_ * scale))
+            );
+            target_.Bind();
+        }
+
+        {
+            PROFILE_ZONE("Program");
+            PROFILE_GPU_ZONE("Program");
+            program(delta);
+        }
+
+        if (scaler_) {
+            scaler_->EndFrame();
+            PROFILE_GPU_ZONE("Upscale");
+            target_.BlitTo(0, framebuffer_width_, framebuffer_height_);
+        }
+
+        {
+            PROFILE_ZONE("ImGui");
+            PROFILE_GPU_ZONE("ImGui");
+            imguiAfterRender();
+        }
+        if (frame_log_) {
+            frame_log_->Add(frame_, elapsed * 1000.0, timer_.GetSeconds() * 1000.0);
+        }
+        {
+            PROFILE_ZONE("Swap");
+            glfwSwapBuffers(window_);
+            pacer_.Wait();
+        }
+        PROFILE_FRAME();
+        RENDER_STATS_FRAME(elapsed * 1000.0);
         glfwPollEvents();
+
+        ++frame_;
+        if (replay_ && replay_->IsFinished(frame_)) {
+            glfwSetWindowShouldClose(window_, GLFW_TRUE);
+        }
     }
+
+    // state the simulation uses may go away once Start returns
+    if (simulation_thread_) simulation_thread_->Sync();
+}
+
+auto Window::RequestRedraw() -> void {
+    // ImGui reacts to input one frame late, so input gets a second frame
+    pending_frames_.store(2);
+    if (idle_.load()) glfwPostEmptyEvent();
+}
+
+auto Window::ShouldRender() const -> bool {
+    return render_mode_ == RenderMode::kContinuous ||
+           replay_ != nullptr ||
+           continuous_requests_.load() > 0 ||
+           pending_frames_.load() > 0 ||
+           event_queue.Size() > 0 ||
+           MainThreadQueue::Get().Depth() > 0 ||
+           EventBus::Get().Depth() > 0;
+}
+
+auto Window::ApplyResize() -> void {
+    resized_ = false;
+
+    // resize events only record that the size changed, so a window being
+    // dragged costs one update per frame; the render target reallocates
+    // only when it outgrows its storage
+    glfwGetFramebufferSize(window_, &framebuffer_width_, &framebuffer_height_);
+    if (!scaler_) glViewport(0, 0, framebuffer_width_, framebuffer_height_);
+
+    auto width {0}, height {0};
+    glfwGetWindowSize(window_, &width, &height);
+    if (resize_ && width > 0 && height > 0) resize_(width, height);
+}
+
+auto Window::SetFramePacer(const FramePacer::Parameters& params) -> void {
+    pacer_ = FramePacer {params};
+    glfwSwapInterval(pacer_.SwapInterval());
 }
 
 Window::~Window() {
+    // members outlive this body, so their GL objects go while the context
+    // still exists
+    scaler_.reset();
+    target_.Release();
+    PROFILE_RELEASE_GPU();
+
+    MainThreadQueue::Get().SetWakeCallback(nullptr);
+    EventBus::Get().SetWakeCallback(nullptr);
     imguiCleanup();
     glfwDestroyWindow(window_);
     glfwTerminate();
@@ -100,57 +240,86 @@ Window::~Window() {
 
 static auto glfwCursorPosCallback(GLFWwindow* window, double x, double y) -> void {
     auto instance = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    instance->RequestRedraw();
+
+    auto event = MouseEvent {};
+    event.type = MouseEvent::Type::Moved;
+    event.button = MouseButton::None;
+    event.position = {static_cast<float>(x), static_cast<float>(y)};
+    event.delta = {
+        static_cast<float>(x - instance->mouse_pos_x),
+        static_cast<float>(y - instance->mouse_pos_y)
+    };
+    event.scroll = {0.0f, 0.0f};
+
     instance->mouse_pos_x = x;
     instance->mouse_pos_y = y;
-
-    auto event = std::make_unique<MouseEvent>();
-    event->type = MouseEvent::Type::Moved;
-    event->button = MouseButton::None;
-    event->position = {static_cast<float>(x), static_cast<float>(y)};
-    event->scroll = {0.0f, 0.0f};
-
-    EventDispatcher::Get().Dispatch("mouse_event", std::move(event));
+    instance->event_queue.Push(event);
 }
 
 static auto glfwMouseButtonCallback(GLFWwindow* window, int button, int action, int) -> void {
+    static_cast<Window*>(glfwGetWindowUserPointer(window))->RequestRedraw();
     if (imguiEvent()) return;
 
-    auto event = std::make_unique<MouseEvent>();
+    auto event = MouseEvent {};
     auto instance = static_cast<Window*>(glfwGetWindowUserPointer(window));
 
-    event->type = MouseEvent::Type::ButtonPressed;
-    event->button = glfwMouseButtonMap(button);
-    event->position = {
+    event.type = MouseEvent::Type::ButtonPressed;
+    event.button = glfwMouseButtonMap(button);
+    event.position = {
         static_cast<float>(instance->mouse_pos_x),
         static_cast<float>(instance->mouse_pos_y)
     };
-    event->scroll = {0.0f, 0.0f};
+    event.delta = {0.0f, 0.0f};
+    event.scroll = {0.0f, 0.0f};
 
     if (action == GLFW_PRESS) {
-        EventDispatcher::Get().Dispatch("mouse_event", std::move(event));
+        instance->event_queue.Push(event);
     }
 
     if (action == GLFW_RELEASE) {
-        event->type = MouseEvent::Type::ButtonReleased;
-        EventDispatcher::Get().Dispatch("mouse_event", std::move(event));
+        event.type = MouseEvent::Type::ButtonReleased;
+        instance->event_queue.Push(event);
     }
 }
 
 static auto glfwScrollCallback(GLFWwindow* window, double x, double y) -> void {
+    static_cast<Window*>(glfwGetWindowUserPointer(window))->RequestRedraw();
     if (imguiEvent()) return;
 
-    auto event = std::make_unique<MouseEvent>();
+    auto event = MouseEvent {};
     auto instance = static_cast<Window*>(glfwGetWindowUserPointer(window));
 
-    event->type = MouseEvent::Type::Scrolled;
-    event->button = MouseButton::None;
-    event->position = {
+    event.type = MouseEvent::Type::Scrolled;
+    event.button = MouseButton::None;
+    event.position = {
         static_cast<float>(instance->mouse_pos_x),
         static_cast<float>(instance->mouse_pos_y)
     };
-    event->scroll = {static_cast<float>(x), static_cast<float>(y)};
+    event.delta = {0.0f, 0.0f};
+    event.scroll = {static_cast<float>(x), static_cast<float>(y)};
+
+    instance->event_queue.Push(event);
+}
 
-    EventDispatcher::Get().Dispatch("mouse_event", std::move(event));
+// keys only matter to ImGui, which installs its own callbacks on top of
+// these; all the window needs to know is that something changed
+static auto glfwKeyCallback(GLFWwindow* window, int, int, int, int) -> void {
+    static_cast<Window*>(glfwGetWindowUserPointer(window))->RequestRedraw();
+}
+
+static auto glfwCharCallback(GLFWwindow* window, unsigned int) -> void {
+    static_cast<Window*>(glfwGetWindowUserPointer(window))->RequestRedraw();
+}
+
+static auto glfwRefreshCallback(GLFWwindow* window) -> void {
+    static_cast<Window*>(glfwGetWindowUserPointer(window))->RequestRedraw();
+}
+
+static auto glfwFramebufferSizeCallback(GLFWwindow* window, int, int) -> void {
+    auto instance = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    instance->OnFramebufferResized();
+    instance->RequestRedraw();
 }
 
 static auto glfwMouseButtonMap(int button) -> MouseButton {
@@ -3,26 +3,149 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string_view>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "core/event_queue.h"
+#include "core/frame_pacer.h"
+#include "core/frame_time_log.h"
+#include "core/input_recorder.h"
+#include "core/render_target.h"
+#include "core/resolution_scaler.h"
+#include "core/simulation_thread.h"
 #include "core/timer.h"
 
+enum class RenderMode {
+    kContinuous,
+    kOnDemand  // render only after input, posted work or RequestRedraw
+};
+
 class Window {
 public:
     double mouse_pos_x {0.0};
     double mouse_pos_y {0.0};
 
+    EventQueue event_queue {};
+
     Window(int width, int height, std::string_view title);
 
     auto Start(const std::function<void(const double delta)>& program) -> void;
 
+    // records the input of every frame until the window is destroyed
+    auto Record(std::shared_ptr<InputRecorder> recorder) { recorder_ = recorder; }
+
+    // replaces live input with a recording and the measured frame delta with
+    // a fixed timestep; the window closes once the recording ends
+    auto Replay(std::shared_ptr<InputReplay> replay, double timestep) {
+        replay_ = replay;
+        replay_timestep_ = timestep;
+    }
+
+    auto LogFrameTimes(const fs::path& path) {
+        frame_log_ = std::make_unique<FrameTimeLog>(path);
+    }
+
+    auto SetFramePacer(const FramePacer::Parameters& params) -> void;
+
+    [[nodiscard]] auto GetFramePacer() const -> const FramePacer& { return pacer_; }
+
+    // runs update at a fixed rate before each frame's program
+    auto SetSimulation(double step, std::function<void(const double step)> update) {
+        simulation_.emplace(step, std::move(update));
+    }
+
+    // blend factor between the last two simulation steps
+    [[nodiscard]] auto SimulationAlpha() const {
+        return simulation_ ? simulation_->Alpha() : 1.0;
+    }
+
+    // Start syncs with the simulation thread before handling input and
+    // main-thread work, and kicks off the next frame's recording after
+    auto SetSimulationThread(std::shared_ptr<SimulationThread> simulation) {
+        simulation_thread_ = simulation;
+    }
+
+    auto SetRenderMode(RenderMode mode) { render_mode_ = mode; }
+
+    // renders the program offscreen at a scale picked from its GPU time and
+    // stretches it over the window before ImGui, which stays at full size
+    auto SetDynamicResolution(const ResolutionScaler::Parameters& params) {
+        scaler_.emplace(params);
+    }
+
+    [[nodiscard]] auto GetResolutionScaler() const -> const std::optional<ResolutionScaler>& {
+        return scaler_;
+    }
+
+    // called with the new size in window coordinates, as mouse events use,
+    // after the simulation thread syncs; a minimized window is not reported
+    auto SetResizeCallback(std::function<void(int width, int height)> resize) {
+        resize_ = std::move(resize);
+    }
+
+    // the event loop marks the size as changed, the next frame applies it
+    auto OnFramebufferResized() { resized_ = true; }
+
+    // safe to call from any thread; wakes the loop if it is idle
+    auto RequestRedraw() -> void;
+
+    // keeps an on-demand window rendering every frame, e.g. while an
+    // animation runs; calls nest, must be balanced and may come from any
+    // thread
+    auto BeginContinuousRendering() {
+        ++continuous_requests_;
+        RequestRedraw();
+    }
+
+    auto EndContinuousRendering() { --continuous_requests_; }
+
+    [[nodiscard]] auto FramesRendered() const { return frame_; }
+
     ~Window();
 
 private:
     GLFWwindow* window_ {nullptr};
     Timer timer_ {};
+
+    FramePacer pacer_ {};
+
+    std::optional<FixedTimestep> simulation_ {};
+
+    std::shared_ptr<SimulationThread> simulation_thread_ {nullptr};
+
+    std::optional<ResolutionScaler> scaler_ {};
+    RenderTarget target_ {};
+
+    std::function<void(int width, int height)> resize_ {};
+    bool resized_ {false};
+    int framebuffer_width_ {0};
+    int framebuffer_height_ {0};
+
+    RenderMode render_mode_ {RenderMode::kContinuous};
+
+    // frames still to render in on-demand mode
+    std::atomic<int> pending_frames_ {1};
+    std::atomic<bool> idle_ {false};
+
+    std::atomic<int> continuous_requests_ {0};
+
+    std::shared_ptr<InputRecorder> recorder_ {nullptr};
+    std::shared_ptr<InputReplay> replay_ {nullptr};
+    std::unique_ptr<FrameTimeLog> frame_log_ {nullptr};
+
+    double replay_timestep_ {1.0 / 60.0};
+
+    std::uint32_t frame_ {0};
+
+    [[nodiscard]] auto ShouldRender() const -> bool;
+
+    auto ApplyResize() -> void;
 };
\ No newline at end of file
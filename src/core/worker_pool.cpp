@@ -0,0 +1,65 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "worker_pool.h"
+
+#include <algorithm>
+
+namespace {
+
+// the most threads taking tasks, the caller included
+constexpr auto kMaxConcurrency = 8u;
+
+} // namespace
+
+WorkerPool::WorkerPool() {
+    const auto threads = std::clamp(std::thread::hardware_concurrency(), 1u, kMaxConcurrency);
+    for (auto i = 1u; i < threads; ++i) {
+        workers_.emplace_back([this](std::stop_token stop) { Worker(stop); });
+    }
+}
+
+auto WorkerPool::TaskCount(std::size_t count, std::size_t grain) const -> std::size_t {
+    return std::clamp<std::size_t>(count / std::max<std::size_t>(grain, 1), 1, Concurrency());
+}
+
+auto WorkerPool::Run(Job& job) -> void {
+    if (job.tasks == 0) return;
+    if (job.tasks == 1 || workers_.empty()) {
+        for (auto task = std::size_t {0}; task < job.tasks; ++task) job.invoke(job.context, task);
+        return;
+    }
+
+    auto lock = std::unique_lock {mutex_};
+    jobs_.emplace_back(&job);
+    wake_.notify_all();
+
+    Work(job, lock);
+
+    // every task has been taken; wait for the workers still running one
+    std::erase(jobs_, &job);
+    finished_.wait(lock, [&job] { return job.users == 0; });
+}
+
+auto WorkerPool::Work(Job& job, std::unique_lock<std::mutex>& lock) -> void {
+    while (job.next < job.tasks) {
+        const auto task = job.next++;
+        lock.unlock();
+        job.invoke(job.context, task);
+        lock.lock();
+    }
+}
+
+auto WorkerPool::Worker(std::stop_token stop) -> void {
+    auto lock = std::unique_lock {mutex_};
+    while (wake_.wait(lock, stop, [this] { return !jobs_.empty(); })) {
+        auto& job = *jobs_.front();
+        ++job.users;
+        Work(job, lock);
+        --job.users;
+
+        // nothing is left to take, so later workers go to the next job
+        if (!jobs_.empty() && jobs_.front() == &job) jobs_.pop_front();
+        finished_.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads that live for the whole program and split per-frame work between
+// them, so rasterizing, binning or building a mesh never pays for starting
+// threads. Run blocks until every task is done and the calling thread takes
+// tasks too, which keeps nested calls from waiting on a busy pool:
+//
+//   WorkerPool::Get().Run(tiles, [&](std::size_t tile) { Rasterize(tile); });
+//
+//   ParallelFor(count, 4096, [&](std::size_t begin, std::size_t end) {
+//       for (auto i = begin; i < end; ++i) ...
+//   });
+class WorkerPool {
+public:
+    // deleted copy constructors and assignment operators
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    static auto Get() -> WorkerPool& {
+        static auto instance = WorkerPool {};
+        return instance;
+    }
+
+    // threads that take tasks, the caller included
+    [[nodiscard]] auto Concurrency() const { return workers_.size() + 1; }
+
+    // count split into tasks of at least grain items, at most one per thread
+    [[nodiscard]] auto TaskCount(std::size_t count, std::size_t grain) const -> std::size_t;
+
+    // calls function(task) once for every task in [0, tasks), in any order
+    // and on any thread, and returns once all calls have returned
+    template <typename Function>
+    auto Run(std::size_t tasks, const Function& function) -> void {
+        auto job = Job {
+            .invoke = [](const void* context, std::size_t task) {
+                (*static_cast<const Function*>(context))(task);
+            },
+            .context = &function,
+            .tasks = tasks
+        };
+        Run(job);
+    }
+
+private:
+    struct Job {
+        void (*invoke)(const void* context, std::size_t task);
+        const void* context;
+        std::size_t tasks;
+        std::size_t next {0};  // the next task to take, under mutex_
+        std::size_t users {0}; // workers inside Work, under mutex_
+    };
+
+    std::mutex mutex_ {};
+    std::condition_variable_any wake_ {};
+    std::condition_variable finished_ {};
+    std::deque<Job*> jobs_ {};
+
+    // last, so the workers are stopped and joined before anything they use
+    std::vector<std::jthread> workers_ {};
+
+    WorkerPool();
+
+    auto Run(Job& job) -> void;
+
+    // takes tasks from job until none are left; called with the lock held
+    auto Work(Job& job, std::unique_lock<std::mutex>& lock) -> void;
+
+    auto Worker(std::stop_token stop) -> void;
+};
+
+// splits [0, count) into contiguous ranges of at least grain items and calls
+// function(begin, end) for each, on the pool
+template <typename Function>
+auto ParallelFor(std::size_t count, std::size_t grain, const Function& function) -> void {
+    auto& pool = WorkerPool::Get();
+    const auto tasks = pool.TaskCount(count, grain);
+    if (tasks == 1) {
+        function(std::size_t {0}, count);
+        return;
+    }
+    pool.Run(tasks, [&](std::size_t task) {
+        function(count * task / tasks, count * (task + 1) / tasks);
+    });
+}
\ No newline at end of file
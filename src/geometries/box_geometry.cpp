@@ -6,53 +6,53 @@
 #include <vector>
 
 BoxGeometry::BoxGeometry(const Parameters& params) {
-    auto vertex_data = std::vector<float>();
-    auto index_data = std::vector<unsigned int>();
+    const auto data = Generate(params);
+    SetVertexData(data.vertex_data, data.index_data);
+}
+
+auto BoxGeometry::Generate(const Parameters& params) -> GeometryData {
+    auto data = GeometryData {};
 
     BuildPlane({
         'z', 'y', 'x', -1, -1,
         params.depth, params.height, params.width,
         params.depth_segments, params.height_segments
-    }, vertex_data, index_data);
+    }, data);
 
     BuildPlane({
         'z', 'y', 'x', 1, -1,
         params.depth, params.height, -params.width,
         params.depth_segments, params.height_segments
-    }, vertex_data, index_data);
+    }, data);
 
     BuildPlane({
         'x', 'z', 'y', 1, 1,
         params.width, params.depth, params.height,
         params.width_segments, params.depth_segments
-    }, vertex_data, index_data);
+    }, data);
 
     BuildPlane({
         'x', 'z', 'y', 1, -1,
         params.width, params.depth, -params.height,
         params.width_segments, params.depth_segments
-    }, vertex_data, index_data);
+    }, data);
 
     BuildPlane({
         'x', 'y', 'z', 1, -1,
         params.width, params.height, params.depth,
         params.width_segments, params.height_segments
-    }, vertex_data, index_data);
+    }, data);
 
     BuildPlane({
         'x', 'y', 'z', -1, -1,
         params.width, params.height, -params.depth,
         params.width_segments, params.height_segments
-    }, vertex_data, index_data);
+    }, data);
 
-    SetVertexData(vertex_data, index_data);
+    return data;
 }
 
-auto BoxGeometry::BuildPlane(
-    const PlaneParameters& params,
-    std::vector<float>& vertex_data,
-    std::vector<unsigned int>& index_data
-) -> void {
+auto BoxGeometry::BuildPlane(const PlaneParameters& params, GeometryData& data) -> void {
     const auto width_half = params.width / 2;
     const auto height_half = params.height / 2;
     const auto depth_half = params.depth / 2;
@@ -63,8 +63,11 @@ auto BoxGeometry::BuildPlane(
     const auto segment_w = params.width / params.grid_x;
     const auto segment_h = params.height / params.grid_y;
 
+    auto& vertex_data = data.vertex_data;
+    auto& index_data = data.index_data;
+    const auto vertex_counter = static_cast<unsigned>(vertex_data.size() / 8);
+
     auto vec = glm::vec3 {};
-    auto counter = 0;
 
     for (auto iy = 0; iy < grid_y1; ++iy) {
         const auto y = iy * segment_h - height_half;
@@ -94,17 +97,15 @@ auto BoxGeometry::BuildPlane(
             const auto v = 1 - (static_cast<float>(iy) / params.grid_y);
             vertex_data.emplace_back(u);
             vertex_data.emplace_back(v);
-
-            ++counter;
         }
     }
 
     for (auto iy = 0; iy < params.grid_y; ++iy) {
         for (auto ix = 0; ix < params.grid_x; ++ix) {
-            const auto a = vertex_counter_ + ix + grid_x1 * iy;
-            const auto b = vertex_counter_ + ix + grid_x1 * (iy + 1);
-            const auto c = vertex_counter_ + ix + 1 + grid_x1 * (iy + 1);
-            const auto d = vertex_counter_ + ix + 1 + grid_x1 * iy;
+            const auto a = vertex_counter + ix + grid_x1 * iy;
+            const auto b = vertex_counter + ix + grid_x1 * (iy + 1);
+            const auto c = vertex_counter + ix + 1 + grid_x1 * (iy + 1);
+            const auto d = vertex_counter + ix + 1 + grid_x1 * iy;
 
             index_data.emplace_back(a);
             index_data.emplace_back(b);
@@ -114,8 +115,6 @@ auto BoxGeometry::BuildPlane(
             index_data.emplace_back(d);
         }
     }
-
-    vertex_counter_ += counter;
 }
 
 auto BoxGeometry::SetComponent(glm::vec3& vec, char axis, float value) -> void {
@@ -22,6 +22,9 @@ public:
 
     explicit BoxGeometry(const Parameters& params);
 
+    // builds the vertex data without touching GL
+    [[nodiscard]] static auto Generate(const Parameters& params) -> GeometryData;
+
 private:
     struct PlaneParameters {
         char u;
@@ -36,13 +39,7 @@ private:
         unsigned grid_y;
     };
 
-    unsigned vertex_counter_ {0};
-
-    auto BuildPlane(
-        const PlaneParameters& params,
-        std::vector<float>& vertex_data,
-        std::vector<unsigned int>& index_data
-    ) -> void;
+    static auto BuildPlane(const PlaneParameters& params, GeometryData& data) -> void;
 
-    auto SetComponent(glm::vec3& vec, char axis, float value) -> void;
+    static auto SetComponent(glm::vec3& vec, char axis, float value) -> void;
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "mesh_bvh.h"
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+namespace {
+
+auto Position(const GeometryData& data, unsigned vertex) {
+    const auto* p = data.vertex_data.data() + vertex * kVertexFloats;
+    return glm::vec3 {p[0], p[1], p[2]};
+}
+
+} // namespace
+
+MeshBvh::MeshBvh(const GeometryData& data, const BvhParameters& params) {
+    const auto count = data.lods.empty() ? data.index_data.size() : data.lods.front().index_count;
+    if (count < 3) {
+        std::cerr << "MeshBvh needs indexed triangles." << std::endl;
+        return;
+    }
+
+    triangles_.resize(count / 3);
+    auto bounds = std::vector<Bvh::Bounds>(count / 3);
+    for (auto t = std::size_t {0}; t < triangles_.size(); ++t) {
+        const auto a = Position(data, data.index_data[t * 3]);
+        const auto b = Position(data, data.index_data[t * 3 + 1]);
+        const auto c = Position(data, data.index_data[t * 3 + 2]);
+        triangles_[t] = {a, b - a, c - a};
+        bounds[t] = {glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c))};
+    }
+    bvh_ = Bvh {bounds, params};
+}
+
+auto MeshBvh::Raycast(const Ray& ray, float max_distance) const -> std::optional<RayHit> {
+    // Möller-Trumbore, hitting both sides
+    return bvh_.Raycast(ray, max_distance, [&](unsigned index, float nearest) -> std::optional<float> {
+        const auto& triangle = triangles_[index];
+        const auto p = glm::cross(ray.direction, triangle.edge2);
+        const auto determinant = glm::dot(triangle.edge1, p);
+        if (std::abs(determinant) < std::numeric_limits<float>::min()) return std::nullopt;
+
+        const auto inverse = 1.0f / determinant;
+        const auto s = ray.origin - triangle.origin;
+        const auto u = glm::dot(s, p) * inverse;
+        if (u < 0.0f || u > 1.0f) return std::nullopt;
+
+        const auto q = glm::cross(s, triangle.edge1);
+        const auto v = glm::dot(ray.direction, q) * inverse;
+        if (v < 0.0f || u + v > 1.0f) return std::nullopt;
+
+        const auto distance = glm::dot(triangle.edge2, q) * inverse;
+        if (distance < 0.0f || distance >= nearest) return std::nullopt;
+        return distance;
+    });
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "core/bvh.h"
+#include "core/geometry.h"
+#include "core/ray.h"
+
+// Triangles of a mesh in a Bvh, for ray picking and box queries in model
+// space. The positions of the finest level are copied, so the GeometryData
+// can be dropped once it is uploaded:
+//
+//   auto bvh = MeshBvh {data, {}};
+//   auto hit = bvh.Raycast(ray); // hit->index is the triangle
+class MeshBvh {
+public:
+    MeshBvh(const GeometryData& data, const BvhParameters& params);
+
+    [[nodiscard]] auto Raycast(
+        const Ray& ray,
+        float max_distance = std::numeric_limits<float>::infinity()
+    ) const -> std::optional<RayHit>;
+
+    [[nodiscard]] auto Bounds() const -> Bvh::Bounds { return bvh_.Root(); }
+
+    [[nodiscard]] auto Empty() const { return bvh_.Empty(); }
+
+    [[nodiscard]] auto TriangleCount() const { return triangles_.size(); }
+
+    [[nodiscard]] auto Tree() const -> const Bvh& { return bvh_; }
+
+private:
+    // one corner and the two edges from it, as the ray test wants them
+    struct Triangle {
+        glm::vec3 origin;
+        glm::vec3 edge1;
+        glm::vec3 edge2;
+    };
+
+    std::vector<Triangle> triangles_ {};
+
+    Bvh bvh_ {};
+};
\ No newline at end of file
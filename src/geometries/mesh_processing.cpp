@@ -0,0 +1,463 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "mesh_processing.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "core/simd.h"
+#include "core/worker_pool.h"
+
+namespace {
+
+constexpr auto kLanes = std::size_t {4};
+
+// four vectors, one per lane
+struct Vector4 {
+    Float4 x;
+    Float4 y;
+    Float4 z;
+
+    friend auto operator+(const Vector4& a, const Vector4& b) -> Vector4 { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+    friend auto operator-(const Vector4& a, const Vector4& b) -> Vector4 { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+    friend auto operator*(const Vector4& a, Float4 s) -> Vector4 { return {a.x * s, a.y * s, a.z * s}; }
+};
+
+auto Dot(const Vector4& a, const Vector4& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+auto Cross(const Vector4& a, const Vector4& b) -> Vector4 {
+    return {
+        a.y * b.z - a.z * b.y,
+        a.z * b.x - a.x * b.z,
+        a.x * b.y - a.y * b.x
+    };
+}
+
+// zero-length vectors stay zero
+auto Normalize(const Vector4& a) {
+    const auto length = Sqrt(Max(Dot(a, a), Float4::Broadcast(1e-30f)));
+    return a * (Float4::Broadcast(1.0f) / length);
+}
+
+auto Select(Float4 mask, const Vector4& a, const Vector4& b) -> Vector4 {
+    return {Select(mask, a.x, b.x), Select(mask, a.y, b.y), Select(mask, a.z, b.z)};
+}
+
+// four vertices; a tail repeats its last one in the unused lanes
+using VertexLanes = std::array<float*, kLanes>;
+
+auto VertexPointers(float* base, std::size_t stride, std::size_t i, std::size_t lanes) {
+    auto pointers = VertexLanes {};
+    for (auto lane = std::size_t {0}; lane < kLanes; ++lane) {
+        pointers[lane] = base + (i + std::min(lane, lanes - 1)) * stride;
+    }
+    return pointers;
+}
+
+// one attribute of four vertices, assembled in registers; writing lanes to
+// memory and loading them back as a vector stalls on store forwarding
+auto Gather(const VertexLanes& vertex, std::size_t offset) {
+    return Float4::Set(vertex[0][offset], vertex[1][offset], vertex[2][offset], vertex[3][offset]);
+}
+
+auto GatherVector(const VertexLanes& vertex, std::size_t offset) -> Vector4 {
+    return {Gather(vertex, offset), Gather(vertex, offset + 1), Gather(vertex, offset + 2)};
+}
+
+// results as plain floats, for the strided stores after the kernels;
+// nothing is cleared first, since every lane is written
+auto ToArray(Float4 v) {
+    std::array<float, kLanes> lanes;
+    v.Store(lanes.data());
+    return lanes;
+}
+
+struct Lanes {
+    std::array<float, kLanes> x;
+    std::array<float, kLanes> y;
+    std::array<float, kLanes> z;
+
+    explicit Lanes(const Vector4& v) : x(ToArray(v.x)), y(ToArray(v.y)), z(ToArray(v.z)) {}
+};
+
+// makes the tangent perpendicular to the unit normal and returns the sign
+// of the bitangent relative to cross(normal, tangent)
+auto Orthogonalize(const Vector4& normal, Vector4& tangent, const Vector4& bitangent) -> Float4 {
+    tangent = Normalize(tangent - normal * Dot(normal, tangent));
+
+    // without uvs any perpendicular direction will do
+    const auto one = Float4::Broadcast(1.0f);
+    const auto zero = Float4::Broadcast(0.0f);
+    const auto missing = LessThan(Dot(tangent, tangent), Float4::Broadcast(0.5f));
+    const auto mostly_y = LessThan(Float4::Broadcast(0.9f), Max(normal.y, -normal.y));
+    const auto axis = Select(mostly_y, Vector4 {one, zero, zero}, Vector4 {zero, one, zero});
+    tangent = Select(missing, Normalize(Cross(axis, normal)), tangent);
+
+    const auto flipped = LessThan(Dot(Cross(normal, tangent), bitangent), zero);
+    return Select(flipped, -one, one);
+}
+
+auto StoreTangent(float* tangent, const Lanes& lanes, const std::array<float, kLanes>& w, std::size_t lane) {
+    tangent[0] = lanes.x[lane];
+    tangent[1] = lanes.y[lane];
+    tangent[2] = lanes.z[lane];
+    tangent[3] = w[lane];
+}
+
+// positions of one grid row, padded with copies of the edge vertices so
+// that the neighbours of every column (and of the tail lanes) can be loaded
+// without bounds checks
+struct PaddedRow {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    auto Load(const float* vertices, std::size_t columns) -> void {
+        for (auto c = std::size_t {0}; c < columns; ++c) {
+            const auto* vertex = vertices + c * kVertexFloats;
+            x[c + 1] = vertex[0];
+            y[c + 1] = vertex[1];
+            z[c + 1] = vertex[2];
+        }
+        x[0] = x[1];
+        y[0] = y[1];
+        z[0] = z[1];
+        for (auto c = columns + 1; c < x.size(); ++c) {
+            x[c] = x[columns];
+            y[c] = y[columns];
+            z[c] = z[columns];
+        }
+    }
+
+    // columns i to i + 3 shifted by offset, which is -1, 0 or 1
+    [[nodiscard]] auto At(std::size_t i, int offset) const -> Vector4 {
+        const auto c = i + 1 + offset;
+        return {Float4::Load(&x[c]), Float4::Load(&y[c]), Float4::Load(&z[c])};
+    }
+};
+
+auto Sign(float x) { return x < 0.0f ? -1.0f : 1.0f; }
+
+} // namespace
+
+auto DisplaceVertices(GeometryData& data, const Image& image, const DisplacementParameters& params) -> void {
+    if (image.Data() == nullptr || image.width == 0 || image.height == 0) {
+        std::cerr << "Cannot displace vertices by an empty image." << std::endl;
+        return;
+    }
+
+    auto* vertices = data.vertex_data.data();
+    const auto count = data.vertex_data.size() / kVertexFloats;
+
+    const auto width = std::size_t {image.width};
+    const auto height = std::size_t {image.height};
+    const auto* pixels = image.Data() + std::min(params.channel, 3u);
+
+    const auto zero = Float4::Broadcast(0.0f);
+    const auto max_x = Float4::Broadcast(static_cast<float>(width - 1));
+    const auto max_y = Float4::Broadcast(static_cast<float>(height - 1));
+    const auto scale = Float4::Broadcast(params.scale / 255.0f);
+    const auto bias = Float4::Broadcast(params.bias);
+
+    ParallelFor(count, 4096, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i += kLanes) {
+            const auto lanes = std::min(kLanes, end - i);
+            const auto vertex = VertexPointers(vertices, kVertexFloats, i, lanes);
+
+            const auto x = Min(Max(Gather(vertex, 6) * max_x, zero), max_x);
+            const auto y = Min(Max(Gather(vertex, 7) * max_y, zero), max_y);
+            const auto x0 = Truncate(x);
+            const auto y0 = Truncate(y);
+
+            // byte offsets of the texels left, right, above and below each
+            // sample; not cleared, as every lane is written below
+            const auto columns = ToArray(x0);
+            const auto rows = ToArray(y0);
+            std::array<std::size_t, kLanes> left;
+            std::array<std::size_t, kLanes> right;
+            std::array<std::size_t, kLanes> top;
+            std::array<std::size_t, kLanes> bottom;
+            for (auto lane = std::size_t {0}; lane < kLanes; ++lane) {
+                const auto column = static_cast<std::size_t>(static_cast<int>(columns[lane]));
+                const auto row = static_cast<std::size_t>(static_cast<int>(rows[lane]));
+                left[lane] = column * 4;
+                right[lane] = std::min(column + 1, width - 1) * 4;
+                top[lane] = row * width * 4;
+                bottom[lane] = std::min(row + 1, height - 1) * width * 4;
+            }
+            const auto texels = [&](const auto& row, const auto& column) {
+                return Float4::Convert(
+                    pixels[row[0] + column[0]],
+                    pixels[row[1] + column[1]],
+                    pixels[row[2] + column[2]],
+                    pixels[row[3] + column[3]]
+                );
+            };
+
+            const auto fx = x - x0;
+            const auto fy = y - y0;
+            const auto t00 = texels(top, left);
+            const auto t10 = texels(top, right);
+            const auto t01 = texels(bottom, left);
+            const auto t11 = texels(bottom, right);
+            const auto upper = t00 + (t10 - t00) * fx;
+            const auto lower = t01 + (t11 - t01) * fx;
+
+            const auto offsets = ToArray((upper + (lower - upper) * fy) * scale + bias);
+
+            for (auto lane = std::size_t {0}; lane < lanes; ++lane) {
+                vertex[lane][0] += vertex[lane][3] * offsets[lane];
+                vertex[lane][1] += vertex[lane][4] * offsets[lane];
+                vertex[lane][2] += vertex[lane][5] * offsets[lane];
+            }
+        }
+    });
+}
+
+auto ComputeGridNormals(GeometryData& data, const GridLayout& grid) -> void {
+    const auto columns = std::size_t {grid.columns};
+    const auto rows = std::size_t {grid.rows};
+    const auto count = data.vertex_data.size() / kVertexFloats;
+    if (columns < 2 || rows < 2 || columns * rows != count) {
+        std::cerr << "Grid layout does not match the vertex data." << std::endl;
+        return;
+    }
+
+    data.tangent_data.resize(count * 4);
+    auto* vertices = data.vertex_data.data();
+    auto* tangents = data.tangent_data.data();
+
+    // the tangent follows u and the bitangent v; both are the same across
+    // a regular grid
+    const auto u_sign = Float4::Broadcast(Sign(vertices[kVertexFloats + 6] - vertices[6]));
+    const auto v_sign = Float4::Broadcast(Sign(vertices[columns * kVertexFloats + 7] - vertices[7]));
+
+    const auto padded = (columns + kLanes - 1) / kLanes * kLanes + 2;
+
+    ParallelFor(rows, 16, [&](std::size_t begin, std::size_t end) {
+        auto buffers = std::array<PaddedRow, 3> {};
+        for (auto& buffer : buffers) {
+            buffer.x.resize(padded);
+            buffer.y.resize(padded);
+            buffer.z.resize(padded);
+        }
+        const auto load = [&](PaddedRow& buffer, std::size_t row) {
+            buffer.Load(vertices + std::min(row, rows - 1) * columns * kVertexFloats, columns);
+        };
+
+        // previous, current and next row
+        auto window = std::array {&buffers[0], &buffers[1], &buffers[2]};
+        load(*window[0], begin == 0 ? 0 : begin - 1);
+        load(*window[1], begin);
+        load(*window[2], begin + 1);
+
+        for (auto row = begin; row < end; ++row) {
+            auto* row_vertices = vertices + row * columns * kVertexFloats;
+            auto* row_tangents = tangents + row * columns * 4;
+
+            for (auto i = std::size_t {0}; i < columns; i += kLanes) {
+                const auto lanes = std::min(kLanes, columns - i);
+                const auto vertex = VertexPointers(row_vertices, kVertexFloats, i, lanes);
+
+                // on the edges these are one-sided, which only changes the length
+                const auto along_row = window[1]->At(i, 1) - window[1]->At(i, -1);
+                const auto along_column = window[2]->At(i, 0) - window[0]->At(i, 0);
+
+                auto normal = Cross(along_row, along_column);
+                const auto flipped = LessThan(Dot(normal, GatherVector(vertex, 3)), Float4::Broadcast(0.0f));
+                normal = Normalize(Select(flipped, normal * Float4::Broadcast(-1.0f), normal));
+
+                auto tangent = along_row * u_sign;
+                const auto w = Orthogonalize(normal, tangent, along_column * v_sign);
+
+                const auto normal_lanes = Lanes {normal};
+                const auto tangent_lanes = Lanes {tangent};
+                const auto w_lanes = ToArray(w);
+
+                for (auto lane = std::size_t {0}; lane < lanes; ++lane) {
+                    vertex[lane][3] = normal_lanes.x[lane];
+                    vertex[lane][4] = normal_lanes.y[lane];
+                    vertex[lane][5] = normal_lanes.z[lane];
+                    StoreTangent(row_tangents + (i + lane) * 4, tangent_lanes, w_lanes, lane);
+                }
+            }
+
+            std::rotate(window.begin(), window.begin() + 1, window.end());
+            if (row + 1 < end) load(*window[2], row + 2);
+        }
+    });
+}
+
+auto ComputeNormals(GeometryData& data) -> void {
+    const auto count = data.vertex_data.size() / kVertexFloats;
+    const auto& indices = data.index_data;
+    const auto triangles = indices.size() / 3;
+    if (count == 0 || triangles == 0) {
+        std::cerr << "Cannot compute normals without indexed triangles." << std::endl;
+        return;
+    }
+
+    data.tangent_data.resize(count * 4);
+    auto* vertices = data.vertex_data.data();
+    auto* tangents = data.tangent_data.data();
+
+    // Each task sums the faces of its triangle range into its own buffer,
+    // covering only the vertices those faces use. Meshes are usually stored
+    // with nearby triangles sharing vertices, so the buffers add up to about
+    // one copy of the mesh; the sums are then added in task order, which
+    // keeps the result independent of scheduling.
+    struct Sum {
+        std::array<float, 9> frame {}; // normal, tangent, bitangent
+    };
+    struct Task {
+        std::size_t first {0};
+        std::size_t last {0};
+        std::vector<Sum> sums {};
+    };
+
+    auto& pool = WorkerPool::Get();
+    auto tasks = std::vector<Task>(pool.TaskCount(triangles, 16384));
+    const auto range = [&](std::size_t task) {
+        return std::pair {triangles * task / tasks.size(), triangles * (task + 1) / tasks.size()};
+    };
+
+    if (tasks.size() > 1) {
+        pool.Run(tasks.size(), [&](std::size_t task) {
+            const auto [begin, end] = range(task);
+            const auto [lowest, highest] = std::minmax_element(
+                indices.begin() + begin * 3,
+                indices.begin() + end * 3
+            );
+            tasks[task].first = *lowest;
+            tasks[task].last = *highest;
+        });
+
+        auto covered = std::size_t {0};
+        for (const auto& task : tasks) covered += task.last - task.first + 1;
+        if (covered > count * 2) {
+            // scattered indices; one buffer is better than one per task
+            tasks.resize(1);
+        }
+    }
+    if (tasks.size() == 1) {
+        tasks[0].first = 0;
+        tasks[0].last = count - 1;
+    }
+
+    pool.Run(tasks.size(), [&](std::size_t task_index) {
+        auto& task = tasks[task_index];
+        task.sums.resize(task.last - task.first + 1);
+        const auto [begin, end] = range(task_index);
+
+        for (auto t = begin; t < end; t += kLanes) {
+            const auto lanes = std::min(kLanes, end - t);
+
+            // the three corners of four triangles
+            auto corners = std::array<VertexLanes, 3> {};
+            for (auto lane = std::size_t {0}; lane < kLanes; ++lane) {
+                const auto* triangle = &indices[(t + std::min(lane, lanes - 1)) * 3];
+                for (auto corner = 0; corner < 3; ++corner) {
+                    corners[corner][lane] = vertices + triangle[corner] * kVertexFloats;
+                }
+            }
+            const auto& [a, b, c] = corners;
+
+            const auto p0 = GatherVector(a, 0);
+            const auto edge1 = GatherVector(b, 0) - p0;
+            const auto edge2 = GatherVector(c, 0) - p0;
+
+            // twice the area, so larger faces count for more
+            const auto normal = Cross(edge1, edge2);
+
+            const auto u0 = Gather(a, 6);
+            const auto v0 = Gather(a, 7);
+            const auto du1 = Gather(b, 6) - u0;
+            const auto dv1 = Gather(b, 7) - v0;
+            const auto du2 = Gather(c, 6) - u0;
+            const auto dv2 = Gather(c, 7) - v0;
+
+            // directions of increasing u and v, scaled by the face area;
+            // faces without uv area add nothing
+            const auto zero = Float4::Broadcast(0.0f);
+            const auto determinant = du1 * dv2 - du2 * dv1;
+            const auto area = Sqrt(Dot(normal, normal));
+            const auto degenerate = LessThan(Max(determinant, -determinant), Float4::Broadcast(1e-12f));
+            const auto weight = Select(degenerate, zero, area / Select(degenerate, Float4::Broadcast(1.0f), determinant));
+            const auto tangent = (edge1 * dv2 - edge2 * dv1) * weight;
+            const auto bitangent = (edge2 * du1 - edge1 * du2) * weight;
+
+            // one triangle's frame per vector, as laid out in a Sum, so each
+            // corner adds two vectors and the last float
+            auto head = std::array {normal.x, normal.y, normal.z, tangent.x};
+            auto middle = std::array {tangent.y, tangent.z, bitangent.x, bitangent.y};
+            Transpose(head[0], head[1], head[2], head[3]);
+            Transpose(middle[0], middle[1], middle[2], middle[3]);
+            const auto tail = ToArray(bitangent.z);
+
+            for (auto lane = std::size_t {0}; lane < lanes; ++lane) {
+                for (auto corner = 0; corner < 3; ++corner) {
+                    auto* sum = task.sums[indices[(t + lane) * 3 + corner] - task.first].frame.data();
+                    (Float4::Load(sum) + head[lane]).Store(sum);
+                    (Float4::Load(sum + 4) + middle[lane]).Store(sum + 4);
+                    sum[8] += tail[lane];
+                }
+            }
+        }
+    });
+
+    // vertices no face uses keep their normal
+    auto unused = Sum {};
+
+    ParallelFor(count, 4096, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i += kLanes) {
+            const auto lanes = std::min(kLanes, end - i);
+            const auto vertex = VertexPointers(vertices, kVertexFloats, i, lanes);
+
+            // the sums of the first task that covers each vertex, with the
+            // other tasks' sums added in; only this thread touches them
+            auto sums = VertexLanes {};
+            for (auto lane = std::size_t {0}; lane < lanes; ++lane) {
+                const auto index = i + lane;
+                auto* first = static_cast<Sum*>(nullptr);
+                for (auto& task : tasks) {
+                    if (index < task.first || index > task.last) continue;
+                    auto& sum = task.sums[index - task.first];
+                    if (first == nullptr) {
+                        first = &sum;
+                        continue;
+                    }
+                    for (auto k = std::size_t {0}; k < sum.frame.size(); ++k) {
+                        first->frame[k] += sum.frame[k];
+                    }
+                }
+                sums[lane] = first ? first->frame.data() : unused.frame.data();
+            }
+            for (auto lane = lanes; lane < kLanes; ++lane) sums[lane] = sums[lanes - 1];
+
+            auto normal = GatherVector(sums, 0);
+            const auto missing = LessThan(Dot(normal, normal), Float4::Broadcast(1e-30f));
+            normal = Normalize(Select(missing, GatherVector(vertex, 3), normal));
+
+            auto tangent = GatherVector(sums, 3);
+            const auto w = Orthogonalize(normal, tangent, GatherVector(sums, 6));
+
+            const auto normal_lanes = Lanes {normal};
+            const auto tangent_lanes = Lanes {tangent};
+            const auto w_lanes = ToArray(w);
+
+            for (auto lane = std::size_t {0}; lane < lanes; ++lane) {
+                vertex[lane][3] = normal_lanes.x[lane];
+                vertex[lane][4] = normal_lanes.y[lane];
+                vertex[lane][5] = normal_lanes.z[lane];
+                StoreTangent(tangents + (i + lane) * 4, tangent_lanes, w_lanes, lane);
+            }
+        }
+    });
+}
\ No newline at end of file
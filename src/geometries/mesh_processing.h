@@ -0,0 +1,42 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/geometry.h"
+#include "core/image.h"
+
+// Displacement and tangent frames for generated geometry. The kernels work
+// on four vertices at a time (see core/simd.h) and split the mesh across
+// the WorkerPool:
+//
+//   auto data = PlaneGeometry::Generate(params);
+//   DisplaceVertices(data, *heightmap, {.scale = 2.0f});
+//   ComputeGridNormals(data, PlaneGeometry::Grid(params));
+//   auto geometry = Geometry {data};
+//
+// Normals are written into the vertex data and tangents into tangent_data.
+
+struct DisplacementParameters {
+    unsigned channel {0}; // 0 to 3 for red, green, blue and alpha
+    float scale {1.0f};   // offset of a full-intensity texel
+    float bias {0.0f};    // added to every offset
+};
+
+// vertices stored row by row, as generated by PlaneGeometry
+struct GridLayout {
+    unsigned columns;
+    unsigned rows;
+};
+
+// moves every vertex along its normal by the image channel at its uv,
+// sampled bilinearly; v = 0 is the first image row, as in GL
+auto DisplaceVertices(GeometryData& data, const Image& image, const DisplacementParameters& params) -> void;
+
+// smooth normals and tangents from central differences over a grid; the
+// normals keep the side of the ones already in the vertex data
+auto ComputeGridNormals(GeometryData& data, const GridLayout& grid) -> void;
+
+// smooth normals and tangents for any indexed triangle mesh, accumulated
+// from the faces around each vertex weighted by their area
+auto ComputeNormals(GeometryData& data) -> void;
\ No newline at end of file
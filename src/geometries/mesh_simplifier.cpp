@@ -0,0 +1,485 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "mesh_simplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace {
+
+// squared distances to a set of planes, weighted by the area of the
+// triangles they came from
+struct Quadric {
+    double xx {0.0}, xy {0.0}, xz {0.0}, xw {0.0};
+    double yy {0.0}, yz {0.0}, yw {0.0};
+    double zz {0.0}, zw {0.0};
+    double ww {0.0};
+    double area {0.0};
+
+    static auto Plane(const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c) -> Quadric {
+        const auto normal = glm::cross(b - a, c - a);
+        const auto length = glm::length(normal);
+        if (length == 0.0) return {};
+
+        const auto n = normal / length;
+        const auto d = -glm::dot(n, a);
+        const auto area = length * 0.5;
+        return {
+            n.x * n.x * area, n.x * n.y * area, n.x * n.z * area, n.x * d * area,
+            n.y * n.y * area, n.y * n.z * area, n.y * d * area,
+            n.z * n.z * area, n.z * d * area,
+            d * d * area,
+            area
+        };
+    }
+
+    friend auto operator+(const Quadric& a, const Quadric& b) -> Quadric {
+        return {
+            a.xx + b.xx, a.xy + b.xy, a.xz + b.xz, a.xw + b.xw,
+            a.yy + b.yy, a.yz + b.yz, a.yw + b.yw,
+            a.zz + b.zz, a.zw + b.zw,
+            a.ww + b.ww,
+            a.area + b.area
+        };
+    }
+
+    [[nodiscard]] auto Error(const glm::dvec3& p) const -> double {
+        const auto error =
+            p.x * (xx * p.x + 2.0 * (xy * p.y + xz * p.z + xw)) +
+            p.y * (yy * p.y + 2.0 * (yz * p.z + yw)) +
+            p.z * (zz * p.z + 2.0 * zw) + ww;
+        return std::max(error, 0.0);
+    }
+};
+
+constexpr auto kBorderWeight = 10.0; // for open borders that may move
+constexpr auto kSplit = std::numeric_limits<unsigned>::max(); // no single target vertex
+
+// from a group to a neighbouring one
+struct Edge {
+    unsigned target;
+    unsigned target_vertex;
+    unsigned shared;         // triangles on the edge
+    double cost {0.0};
+    double error {0.0};
+};
+
+// moving every vertex of one position onto a neighbouring position
+struct Collapse {
+    double cost;
+    double error;            // area-weighted distance, relative to the mesh radius
+    unsigned group;          // the position that goes away
+    unsigned target;         // the position it moves to
+    unsigned target_vertex;  // the vertex whose normal and uv it takes
+    unsigned stamp;
+
+    friend auto operator>(const Collapse& a, const Collapse& b) { return a.cost > b.cost; }
+};
+
+// Vertices are welded into groups by position, so uv and normal seams do not
+// read as borders. Each group that may move keeps its cheapest collapse in the
+// queue; stamps invalidate the entries of groups whose neighbourhood changed.
+class Simplifier {
+public:
+    Simplifier(const GeometryData& data, const LodParameters& params)
+      : vertices_(data.vertex_data.data()),
+        triangles_(data.index_data),
+        params_(params) {
+        Weld(data.vertex_data.size() / kVertexFloats);
+        Connect();
+        Lock();
+        for (auto group = 0u; group < quadrics_.size(); ++group) {
+            if (!locked_[group]) Push(group);
+        }
+    }
+
+    // collapses until at most target triangles remain or nothing else can
+    // be collapsed within max_error
+    auto Reduce(std::size_t target) -> void {
+        while (live_ > target && !queue_.empty()) {
+            const auto candidate = queue_.top();
+            queue_.pop();
+            if (removed_[candidate.group] || candidate.stamp != stamps_[candidate.group]) continue;
+
+            // a neighbour may have changed since the candidate was queued
+            const auto current = Evaluate(candidate.group, candidate.target);
+            if (!current) {
+                Push(candidate.group);
+                continue;
+            }
+            if (current->cost > candidate.cost * (1.0 + 1e-6) + 1e-12) {
+                queue_.push(current.value());
+                continue;
+            }
+            // dropped until a neighbour changes
+            if (current->error > params_.max_error) continue;
+
+            Apply(current.value());
+        }
+    }
+
+    [[nodiscard]] auto Triangles() const { return live_; }
+
+    [[nodiscard]] auto Error() const { return static_cast<float>(error_ * radius_); }
+
+    auto Emit(std::vector<unsigned int>& indices) const {
+        for (auto triangle = std::size_t {0}; triangle < alive_.size(); ++triangle) {
+            if (!alive_[triangle]) continue;
+            const auto* corners = triangles_.data() + triangle * 3;
+            indices.insert(indices.end(), corners, corners + 3);
+        }
+    }
+
+private:
+    const float* vertices_;
+    std::vector<unsigned int> triangles_;
+    LodParameters params_;
+
+    std::vector<unsigned> group_ {}; // per vertex
+    std::vector<glm::dvec3> positions_ {}; // per group, normalised to the unit sphere
+    std::vector<Quadric> quadrics_ {};
+    std::vector<std::vector<unsigned>> incident_ {}; // triangles around each group
+    std::vector<unsigned> stamps_ {};
+    std::vector<char> locked_ {};
+    std::vector<char> removed_ {};
+    std::vector<char> alive_ {}; // per triangle
+
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> queue_ {};
+
+    // per group, for finding neighbours without sorting; Mark starts a new
+    // epoch so nothing needs clearing
+    std::vector<unsigned> marks_ {};
+    std::vector<unsigned> seen_ {};
+    unsigned epoch_ {0};
+    unsigned around_ {0}; // marks the neighbours of the group in edges_
+
+    std::vector<Edge> edges_ {};
+    std::vector<unsigned> affected_ {};
+
+    std::size_t live_ {0};
+    double error_ {0.0};
+    double radius_ {1.0};
+
+    [[nodiscard]] auto Position(unsigned vertex) const {
+        const auto* p = vertices_ + vertex * kVertexFloats;
+        return glm::vec3 {p[0], p[1], p[2]};
+    }
+
+    [[nodiscard]] auto Corners(unsigned triangle) const {
+        return std::array {
+            group_[triangles_[triangle * 3]],
+            group_[triangles_[triangle * 3 + 1]],
+            group_[triangles_[triangle * 3 + 2]]
+        };
+    }
+
+    // groups are numbered in position order, which also keeps neighbours close
+    auto Weld(std::size_t vertex_count) -> void {
+        auto min = glm::vec3 {std::numeric_limits<float>::max()};
+        auto max = -min;
+        for (auto vertex = 0u; vertex < vertex_count; ++vertex) {
+            min = glm::min(min, Position(vertex));
+            max = glm::max(max, Position(vertex));
+        }
+        const auto center = glm::dvec3 {(min + max) * 0.5f};
+        auto radius = 0.0;
+        for (auto vertex = 0u; vertex < vertex_count; ++vertex) {
+            radius = std::max(radius, glm::distance(glm::dvec3 {Position(vertex)}, center));
+        }
+        radius_ = radius > 0.0 ? radius : 1.0;
+
+        // adding zero turns -0 into 0, so both weld
+        const auto key = [this](unsigned vertex) {
+            const auto p = Position(vertex) + glm::vec3 {0.0f};
+            return std::array {std::bit_cast<std::uint32_t>(p.x), std::bit_cast<std::uint32_t>(p.y), std::bit_cast<std::uint32_t>(p.z)};
+        };
+        auto order = std::vector<unsigned>(vertex_count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::ranges::sort(order, [&key](unsigned a, unsigned b) { return key(a) < key(b); });
+
+        group_.resize(vertex_count);
+        for (auto i = std::size_t {0}; i < order.size(); ++i) {
+            if (i == 0 || key(order[i]) != key(order[i - 1])) {
+                positions_.emplace_back((glm::dvec3 {Position(order[i])} - center) / radius_);
+            }
+            group_[order[i]] = static_cast<unsigned>(positions_.size() - 1);
+        }
+
+        // members of a group that differ in normal or uv make it a seam
+        locked_.assign(positions_.size(), 0);
+        for (auto i = std::size_t {1}; i < order.size(); ++i) {
+            const auto group = group_[order[i]];
+            if (group != group_[order[i - 1]] || locked_[group]) continue;
+            const auto* a = vertices_ + order[i] * kVertexFloats;
+            const auto* b = vertices_ + order[i - 1] * kVertexFloats;
+            for (auto j = std::size_t {3}; j < kVertexFloats; ++j) {
+                if (std::abs(a[j] - b[j]) > 1e-6f) locked_[group] = 1;
+            }
+        }
+    }
+
+    auto Connect() -> void {
+        const auto triangle_count = triangles_.size() / 3;
+        quadrics_.resize(positions_.size());
+        incident_.resize(positions_.size());
+        stamps_.assign(positions_.size(), 0);
+        marks_.assign(positions_.size(), 0);
+        seen_.assign(positions_.size(), 0);
+        removed_.assign(positions_.size(), 0);
+        alive_.assign(triangle_count, 0);
+
+        for (auto triangle = 0u; triangle < triangle_count; ++triangle) {
+            const auto a = group_[triangles_[triangle * 3]];
+            const auto b = group_[triangles_[triangle * 3 + 1]];
+            const auto c = group_[triangles_[triangle * 3 + 2]];
+            if (a == b || b == c || c == a) continue;
+
+            alive_[triangle] = 1;
+            ++live_;
+            const auto quadric = Quadric::Plane(positions_[a], positions_[b], positions_[c]);
+            for (const auto group : {a, b, c}) {
+                quadrics_[group] = quadrics_[group] + quadric;
+                incident_[group].emplace_back(triangle);
+            }
+        }
+    }
+
+    // edges used by one triangle are borders, by more than two non-manifold
+    auto Lock() -> void {
+        // both groups of the edge, and the triangle it came from
+        auto edges = std::vector<std::pair<std::uint64_t, unsigned>> {};
+        edges.reserve(live_ * 3);
+        for (auto triangle = 0u; triangle < alive_.size(); ++triangle) {
+            if (!alive_[triangle]) continue;
+            for (auto corner = 0; corner < 3; ++corner) {
+                const auto a = group_[triangles_[triangle * 3 + corner]];
+                const auto b = group_[triangles_[triangle * 3 + (corner + 1) % 3]];
+                edges.emplace_back(std::uint64_t {std::min(a, b)} << 32 | std::max(a, b), triangle);
+            }
+        }
+        std::ranges::sort(edges);
+
+        for (auto begin = std::size_t {0}; begin < edges.size();) {
+            auto end = begin + 1;
+            while (end < edges.size() && edges[end].first == edges[begin].first) ++end;
+            const auto uses = end - begin;
+            const auto a = static_cast<unsigned>(edges[begin].first >> 32);
+            const auto b = static_cast<unsigned>(edges[begin].first & 0xffffffff);
+            if ((uses == 1 && params_.lock_border) || uses > 2) {
+                locked_[a] = 1;
+                locked_[b] = 1;
+            } else if (uses == 1) {
+                // a plane through the border, upright on its triangle, keeps
+                // the outline from drifting inside the surface; it weighs
+                // as much as a triangle kBorderWeight times the edge squared
+                const auto corners = Corners(edges[begin].second);
+                const auto normal = glm::cross(positions_[corners[1]] - positions_[corners[0]], positions_[corners[2]] - positions_[corners[0]]);
+                const auto height = kBorderWeight * glm::length(positions_[b] - positions_[a]);
+                const auto quadric = Quadric::Plane(positions_[a], positions_[b], positions_[a] + normal * (height / std::max(glm::length(normal), 1e-30)));
+                quadrics_[a] = quadrics_[a] + quadric;
+                quadrics_[b] = quadrics_[b] + quadric;
+            }
+            begin = end;
+        }
+    }
+
+    auto Mark() {
+        if (epoch_ == std::numeric_limits<unsigned>::max()) {
+            std::ranges::fill(marks_, 0u);
+            std::ranges::fill(seen_, 0u);
+            epoch_ = 0;
+        }
+        return ++epoch_;
+    }
+
+    // groups sharing a live triangle with the group; drops dead triangles
+    // from its list on the way
+    auto Neighbours(unsigned group, std::vector<unsigned>& neighbours) {
+        std::erase_if(incident_[group], [this](unsigned triangle) { return !alive_[triangle]; });
+
+        const auto mark = Mark();
+        neighbours.clear();
+        for (const auto triangle : incident_[group]) {
+            for (const auto corner : Corners(triangle)) {
+                if (corner == group || marks_[corner] == mark) continue;
+                marks_[corner] = mark;
+                neighbours.emplace_back(corner);
+            }
+        }
+    }
+
+    // fills edges_ with the groups the group could move to and what each
+    // move costs; the triangles on an edge say which of the target's
+    // vertices to use, edges where they disagree are left out
+    auto Edges(unsigned group) -> void {
+        std::erase_if(incident_[group], [this](unsigned triangle) { return !alive_[triangle]; });
+
+        around_ = Mark();
+        edges_.clear();
+        auto source_vertex = 0u;
+        for (const auto triangle : incident_[group]) {
+            const auto corners = Corners(triangle);
+            for (auto corner = 0; corner < 3; ++corner) {
+                const auto vertex = triangles_[triangle * 3 + corner];
+                if (corners[corner] == group) {
+                    source_vertex = vertex;
+                    continue;
+                }
+                marks_[corners[corner]] = around_;
+                auto edge = std::ranges::find(edges_, corners[corner], &Edge::target);
+                if (edge == edges_.end()) {
+                    edges_.emplace_back(corners[corner], vertex, 1u);
+                } else {
+                    ++edge->shared;
+                    if (edge->target_vertex != vertex) edge->target_vertex = kSplit;
+                }
+            }
+        }
+        std::erase_if(edges_, [](const Edge& edge) { return edge.target_vertex == kSplit; });
+
+        // the triangles around the group take the target's normal and uv
+        const auto* source = vertices_ + source_vertex * kVertexFloats;
+        for (auto& edge : edges_) {
+            const auto quadric = quadrics_[group] + quadrics_[edge.target];
+            const auto distance = quadric.Error(positions_[edge.target]);
+
+            const auto* destination = vertices_ + edge.target_vertex * kVertexFloats;
+            auto normal = 0.0;
+            for (auto i = 3; i < 6; ++i) normal += (source[i] - destination[i]) * (source[i] - destination[i]);
+            auto uv = 0.0;
+            for (auto i = 6; i < 8; ++i) uv += (source[i] - destination[i]) * (source[i] - destination[i]);
+
+            edge.cost = distance + quadrics_[group].area * (params_.normal_weight * normal + params_.uv_weight * uv);
+            edge.error = std::sqrt(distance / std::max(quadric.area, 1e-30));
+        }
+    }
+
+    // expects Edges(group) to have run last
+    auto Valid(unsigned group, const Edge& edge) -> bool {
+        // link condition: only the triangles on the edge may see both ends,
+        // otherwise the collapse pinches the surface
+        const auto seen = Mark();
+        auto common = 0u;
+        for (const auto triangle : incident_[edge.target]) {
+            if (!alive_[triangle]) continue;
+            for (const auto corner : Corners(triangle)) {
+                if (marks_[corner] != around_ || seen_[corner] == seen || corner == edge.target) continue;
+                seen_[corner] = seen;
+                ++common;
+            }
+        }
+        if (common != edge.shared) return false;
+
+        // the remaining triangles must not fold over or collapse to slivers
+        for (const auto triangle : incident_[group]) {
+            auto corners = Corners(triangle);
+            if (std::ranges::find(corners, edge.target) != corners.end()) continue;
+
+            const auto before = glm::cross(positions_[corners[1]] - positions_[corners[0]], positions_[corners[2]] - positions_[corners[0]]);
+            std::ranges::replace(corners, group, edge.target);
+            const auto after = glm::cross(positions_[corners[1]] - positions_[corners[0]], positions_[corners[2]] - positions_[corners[0]]);
+            if (glm::dot(before, after) <= 0.25 * glm::length(before) * glm::length(after)) return false;
+        }
+        return true;
+    }
+
+    auto ToCollapse(unsigned group, const Edge& edge) const {
+        return Collapse {
+            .cost = edge.cost,
+            .error = edge.error,
+            .group = group,
+            .target = edge.target,
+            .target_vertex = edge.target_vertex,
+            .stamp = stamps_[group]
+        };
+    }
+
+    auto Evaluate(unsigned group, unsigned target) -> std::optional<Collapse> {
+        Edges(group);
+        const auto edge = std::ranges::find(edges_, target, &Edge::target);
+        if (edge == edges_.end() || !Valid(group, *edge)) return std::nullopt;
+        return ToCollapse(group, *edge);
+    }
+
+    // queues the cheapest valid collapse of the group, if there is one; costs
+    // are cheap next to the validity checks, so those run in cost order
+    auto Push(unsigned group) -> void {
+        ++stamps_[group];
+        Edges(group);
+        std::ranges::sort(edges_, {}, &Edge::cost);
+        for (const auto& edge : edges_) {
+            if (Valid(group, edge)) {
+                queue_.push(ToCollapse(group, edge));
+                return;
+            }
+        }
+    }
+
+    auto Apply(const Collapse& collapse) -> void {
+        auto& moved = incident_[collapse.target];
+        for (const auto triangle : incident_[collapse.group]) {
+            if (!alive_[triangle]) continue;
+            auto* corners = &triangles_[triangle * 3];
+            if (std::ranges::any_of(corners, corners + 3, [&](unsigned v) { return group_[v] == collapse.target; })) {
+                alive_[triangle] = 0;
+                --live_;
+                continue;
+            }
+            for (auto corner = 0; corner < 3; ++corner) {
+                if (group_[corners[corner]] == collapse.group) corners[corner] = collapse.target_vertex;
+            }
+            moved.emplace_back(triangle);
+        }
+
+        quadrics_[collapse.target] = quadrics_[collapse.group] + quadrics_[collapse.target];
+        removed_[collapse.group] = 1;
+        incident_[collapse.group] = {};
+        error_ = std::max(error_, collapse.error);
+
+        // everything around the target now has a different neighbourhood
+        Neighbours(collapse.target, affected_);
+        affected_.emplace_back(collapse.target);
+        for (const auto group : affected_) {
+            if (!locked_[group]) Push(group);
+        }
+    }
+};
+
+} // namespace
+
+auto GenerateLods(GeometryData& data, const LodParameters& params) -> void {
+    if (data.index_data.empty() || data.vertex_data.size() < kVertexFloats * 3) {
+        std::cerr << "GenerateLods needs indexed triangles." << std::endl;
+        return;
+    }
+
+    data.lods = {LodLevel {0, data.index_data.size(), 0.0f}};
+
+    auto simplifier = Simplifier {data, params};
+    auto target = static_cast<double>(data.index_data.size() / 3);
+    for (auto level = 1u; level < params.levels; ++level) {
+        target *= params.reduction;
+        simplifier.Reduce(static_cast<std::size_t>(target));
+
+        // a level needs at least 5% fewer triangles than the one before
+        const auto previous = data.lods.back().index_count / 3;
+        if (simplifier.Triangles() * 20 > previous * 19) break;
+
+        const auto offset = data.index_data.size();
+        simplifier.Emit(data.index_data);
+        data.lods.emplace_back(offset, data.index_data.size() - offset, simplifier.Error());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/geometry.h"
+
+// Levels of detail for indexed triangle meshes, by collapsing edges in order
+// of their quadric error. Every level reuses the vertex data, only indices are
+// added, so one Geometry holds the whole chain:
+//
+//   auto data = BoxGeometry::Generate(params);
+//   GenerateLods(data, {.levels = 4});
+//   auto geometry = Geometry {data};
+//   geometry.Draw(shader, geometry.SelectLod(camera, model, height));
+//
+// Vertices where normals or uvs are split, and by default those on open
+// borders, never move, so seams and outlines are kept. The error of a level
+// is the quadric estimate of the furthest any collapse moved the surface.
+
+struct LodParameters {
+    unsigned levels {4};         // including the full mesh
+    float reduction {0.5f};      // triangles kept from one level to the next
+    float max_error {0.05f};     // largest collapse error, relative to the mesh radius
+    float normal_weight {0.5f};  // cost of bending normals, against distance
+    float uv_weight {1.0f};      // cost of stretching uvs, against distance
+    bool lock_border {true};     // pin open borders instead of only penalising them
+};
+
+// appends the coarser levels to index_data and fills lods; stops early when
+// a level cannot be reduced within max_error
+auto GenerateLods(GeometryData& data, const LodParameters& params) -> void;
\ No newline at end of file
@@ -0,0 +1,223 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "meshlets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace {
+
+struct Triangle {
+    glm::vec3 centroid;
+    glm::vec3 normal; // unit length, or zero when degenerate
+};
+
+// triangles around each vertex, in one array
+struct Adjacency {
+    std::vector<unsigned> offsets;
+    std::vector<unsigned> triangles;
+};
+
+auto Position(const GeometryData& data, unsigned vertex) {
+    const auto* p = data.vertex_data.data() + vertex * kVertexFloats;
+    return glm::vec3 {p[0], p[1], p[2]};
+}
+
+auto BuildAdjacency(const unsigned* indices, std::size_t triangle_count, std::size_t vertex_count) {
+    auto adjacency = Adjacency {
+        .offsets = std::vector<unsigned>(vertex_count + 1, 0),
+        .triangles = std::vector<unsigned>(triangle_count * 3)
+    };
+    for (auto i = std::size_t {0}; i < triangle_count * 3; ++i) ++adjacency.offsets[indices[i] + 1];
+    for (auto v = std::size_t {0}; v < vertex_count; ++v) adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+    auto fill = std::vector<unsigned>(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (auto i = std::size_t {0}; i < triangle_count * 3; ++i) {
+        adjacency.triangles[fill[indices[i]]++] = static_cast<unsigned>(i / 3);
+    }
+    return adjacency;
+}
+
+// bounding sphere and normal cone of the triangles of one meshlet
+auto ComputeBounds(const GeometryData& data, const std::vector<Triangle>& triangles, Meshlet& meshlet) {
+    const auto* indices = data.index_data.data() + meshlet.index_offset;
+
+    auto min = glm::vec3 {std::numeric_limits<float>::max()};
+    auto max = -min;
+    for (auto i = std::size_t {0}; i < meshlet.index_count; ++i) {
+        min = glm::min(min, Position(data, indices[i]));
+        max = glm::max(max, Position(data, indices[i]));
+    }
+    meshlet.center = (min + max) * 0.5f;
+    meshlet.radius = 0.0f;
+    for (auto i = std::size_t {0}; i < meshlet.index_count; ++i) {
+        meshlet.radius = std::max(meshlet.radius, glm::distance(Position(data, indices[i]), meshlet.center));
+    }
+
+    auto axis = glm::vec3 {0.0f};
+    for (auto i = std::size_t {0}; i < meshlet.index_count; i += 3) {
+        axis += triangles[(meshlet.index_offset + i) / 3].normal;
+    }
+    const auto length = glm::length(axis);
+    meshlet.cone_axis = length > 0.0f ? axis / length : glm::vec3 {0.0f};
+
+    // the widest normal decides the cone; past a half sphere nothing can be
+    // culled, which a cutoff of 1 expresses
+    auto spread = 1.0f;
+    for (auto i = std::size_t {0}; i < meshlet.index_count; i += 3) {
+        const auto& normal = triangles[(meshlet.index_offset + i) / 3].normal;
+        if (normal != glm::vec3 {0.0f}) spread = std::min(spread, glm::dot(normal, meshlet.cone_axis));
+    }
+    meshlet.cone_cutoff = length > 0.0f && spread > 0.0f ? std::sqrt(1.0f - spread * spread) : 1.0f;
+}
+
+} // namespace
+
+auto BuildMeshlets(GeometryData& data, const MeshletParameters& params) -> void {
+    const auto range = data.lods.empty() ? data.index_data.size() : data.lods.front().index_count;
+    if (range < 3 || params.max_triangles == 0) {
+        std::cerr << "BuildMeshlets needs indexed triangles." << std::endl;
+        return;
+    }
+    if (params.max_vertices < 3) {
+        std::cerr << "BuildMeshlets needs room for at least one triangle's vertices." << std::endl;
+        return;
+    }
+
+    const auto triangle_count = range / 3;
+    const auto* indices = data.index_data.data();
+
+    auto triangles = std::vector<Triangle>(triangle_count);
+    for (auto t = std::size_t {0}; t < triangle_count; ++t) {
+        const auto a = Position(data, indices[t * 3]);
+        const auto b = Position(data, indices[t * 3 + 1]);
+        const auto c = Position(data, indices[t * 3 + 2]);
+        const auto normal = glm::cross(b - a, c - a);
+        const auto length = glm::length(normal);
+        triangles[t] = {(a + b + c) / 3.0f, length > 0.0f ? normal / length : glm::vec3 {0.0f}};
+    }
+    const auto adjacency = BuildAdjacency(indices, triangle_count, data.vertex_data.size() / kVertexFloats);
+
+    // Meshlets grow one triangle at a time from a seed. The candidates share
+    // a vertex with the meshlet; the ones adding the fewest new vertices win,
+    // which fills notches, and among those the nearest and, weighted by
+    // cone_weight, the closest to the meshlet's average normal. The next seed
+    // is the leftover candidate with the fewest free triangles around it, so
+    // fewer slivers are left behind as the meshlets sweep across the surface.
+    auto order = std::vector<unsigned> {};
+    order.reserve(triangle_count);
+    auto used = std::vector<char>(triangle_count, 0);
+    auto queued = std::vector<unsigned>(triangle_count, 0); // meshlet number + 1
+    auto members = std::vector<unsigned>(data.vertex_data.size() / kVertexFloats, 0); // per vertex, likewise
+    auto remaining = std::vector<unsigned>(data.vertex_data.size() / kVertexFloats, 0); // unused triangles per vertex
+    for (auto v = std::size_t {0}; v + 1 < adjacency.offsets.size(); ++v) {
+        remaining[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+    const auto remaining_around = [&](unsigned triangle) {
+        return remaining[indices[triangle * 3]] + remaining[indices[triangle * 3 + 1]] + remaining[indices[triangle * 3 + 2]];
+    };
+
+    auto candidates = std::vector<unsigned> {};
+    auto meshlet_starts = std::vector<std::size_t> {};
+    auto scan = std::size_t {0};
+
+    while (order.size() < triangle_count) {
+        auto seed = std::numeric_limits<unsigned>::max();
+        auto seed_remaining = std::numeric_limits<unsigned>::max();
+        for (const auto candidate : candidates) {
+            if (used[candidate] || remaining_around(candidate) >= seed_remaining) continue;
+            seed = candidate;
+            seed_remaining = remaining_around(candidate);
+        }
+        // the last meshlet was cut off from the rest
+        if (seed == std::numeric_limits<unsigned>::max()) {
+            while (used[scan]) ++scan;
+            seed = static_cast<unsigned>(scan);
+        }
+
+        const auto meshlet = static_cast<unsigned>(meshlet_starts.size() + 1);
+        meshlet_starts.emplace_back(order.size());
+        candidates.clear();
+
+        auto center = glm::vec3 {0.0f};
+        auto axis = glm::vec3 {0.0f};
+        auto count = 0u;
+        auto vertices = 0u;
+        auto next = seed;
+        while (true) {
+            used[next] = 1;
+            order.emplace_back(next);
+            for (auto corner = 0; corner < 3; ++corner) {
+                const auto vertex = indices[next * 3 + corner];
+                --remaining[vertex];
+                if (members[vertex] != meshlet) ++vertices;
+                members[vertex] = meshlet;
+            }
+            ++count;
+            center += triangles[next].centroid;
+            axis += triangles[next].normal;
+            if (count == params.max_triangles || order.size() == triangle_count) break;
+
+            for (auto corner = 0; corner < 3; ++corner) {
+                const auto vertex = indices[next * 3 + corner];
+                for (auto i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+                    const auto neighbour = adjacency.triangles[i];
+                    if (used[neighbour] || queued[neighbour] == meshlet) continue;
+                    queued[neighbour] = meshlet;
+                    candidates.emplace_back(neighbour);
+                }
+            }
+
+            const auto mean = center / static_cast<float>(count);
+            const auto axis_length = glm::length(axis);
+            const auto direction = axis_length > 0.0f ? axis / axis_length : glm::vec3 {0.0f};
+            auto best = std::numeric_limits<unsigned>::max();
+            auto best_added = 4;
+            auto best_score = std::numeric_limits<float>::max();
+            std::erase_if(candidates, [&used](unsigned candidate) { return used[candidate] != 0; });
+            for (const auto candidate : candidates) {
+                auto added = 0;
+                for (auto corner = 0; corner < 3; ++corner) added += members[indices[candidate * 3 + corner]] != meshlet;
+                if (added > best_added || vertices + static_cast<unsigned>(added) > params.max_vertices) continue;
+
+                const auto& triangle = triangles[candidate];
+                const auto facing = 1.0f - glm::dot(triangle.normal, direction);
+                const auto score = glm::distance(triangle.centroid, mean) * (1.0f + params.cone_weight * facing);
+                if (added < best_added || score < best_score) {
+                    best = candidate;
+                    best_added = added;
+                    best_score = score;
+                }
+            }
+            if (best == std::numeric_limits<unsigned>::max()) break;
+            next = best;
+        }
+    }
+
+    // write the triangles back in meshlet order
+    auto reordered = std::vector<unsigned int>(range);
+    for (auto i = std::size_t {0}; i < triangle_count; ++i) {
+        std::copy_n(indices + order[i] * 3, 3, reordered.begin() + i * 3);
+    }
+    auto reordered_triangles = std::vector<Triangle>(triangle_count);
+    for (auto i = std::size_t {0}; i < triangle_count; ++i) reordered_triangles[i] = triangles[order[i]];
+    std::ranges::copy(reordered, data.index_data.begin());
+
+    meshlet_starts.emplace_back(triangle_count);
+    data.meshlets.clear();
+    for (auto i = std::size_t {0}; i + 1 < meshlet_starts.size(); ++i) {
+        auto meshlet = Meshlet {
+            .index_offset = meshlet_starts[i] * 3,
+            .index_count = (meshlet_starts[i + 1] - meshlet_starts[i]) * 3
+        };
+        ComputeBounds(data, reordered_triangles, meshlet);
+        data.meshlets.emplace_back(meshlet);
+    }
+}
\ No newline at end of file
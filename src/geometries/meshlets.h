@@ -0,0 +1,29 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/geometry.h"
+
+// Splits a mesh into small clusters of neighbouring, similarly facing
+// triangles, so Geometry::Cull can skip the ones that are off-screen or face
+// away. Run once when the mesh is built or loaded:
+//
+//   auto data = BoxGeometry::Generate(params);
+//   BuildMeshlets(data, {});
+//   auto geometry = Geometry {data};
+//   ...
+//   geometry.Cull(camera, model, draw_list); // every frame
+//   geometry.Draw(shader, draw_list);
+//
+// The triangles of the finest level are reordered in place so each meshlet
+// is one range of index_data; coarser levels are left alone.
+
+struct MeshletParameters {
+    unsigned max_triangles {124};
+    unsigned max_vertices {64}; // distinct vertices per meshlet, at least 3
+    float cone_weight {0.5f}; // 0 builds the most compact clusters, higher
+                              // ones keep normals closer for cone culling
+};
+
+auto BuildMeshlets(GeometryData& data, const MeshletParameters& params) -> void;
\ No newline at end of file
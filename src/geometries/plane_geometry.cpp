@@ -6,6 +6,11 @@
 #include <vector>
 
 PlaneGeometry::PlaneGeometry(const Parameters& params) {
+    const auto data = Generate(params);
+    SetVertexData(data.vertex_data, data.index_data);
+}
+
+auto PlaneGeometry::Generate(const Parameters& params) -> GeometryData {
     const auto width_half = params.width / 2;
     const auto height_half = params.height / 2;
 
@@ -17,8 +22,9 @@ PlaneGeometry::PlaneGeometry(const Parameters& params) {
     const auto segment_w = params.width / grid_x;
     const auto segment_h = params.height / grid_y;
 
-    auto vertex_data = std::vector<float>();
-    auto index_data = std::vector<unsigned int>();
+    auto data = GeometryData {};
+    auto& vertex_data = data.vertex_data;
+    auto& index_data = data.index_data;
 
     for (auto iy = 0; iy < grid_y1; ++iy) {
         const auto y = iy * segment_h - height_half;
@@ -54,5 +60,5 @@ PlaneGeometry::PlaneGeometry(const Parameters& params) {
         }
     }
 
-    SetVertexData(vertex_data, index_data);
+    return data;
 }
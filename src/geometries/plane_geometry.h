@@ -4,6 +4,7 @@
 #pragma once
 
 #include "core/geometry.h"
+#include "geometries/mesh_processing.h"
 
 class PlaneGeometry : public Geometry {
 public:
@@ -15,4 +16,12 @@ public:
     };
 
     explicit PlaneGeometry(const Parameters& params);
+
+    // builds the vertex data without touching GL
+    [[nodiscard]] static auto Generate(const Parameters& params) -> GeometryData;
+
+    // how the generated vertices are laid out, for ComputeGridNormals
+    [[nodiscard]] static auto Grid(const Parameters& params) -> GridLayout {
+        return {params.width_segments + 1, params.height_segments + 1};
+    }
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// On-disk layout shared by the asset packer and AssetArchive:
+//
+//   ArchiveHeader
+//   ArchiveEntry[entry_count]    sorted by hash
+//   path strings                 for collision checks and debugging
+//   payloads                     each aligned to kArchiveAlignment
+//
+// All integers are little-endian.
+
+constexpr auto kArchiveMagic = std::uint32_t {0x4B41504F}; // "OPAK"
+constexpr auto kArchiveVersion = std::uint32_t {1};
+constexpr auto kArchiveAlignment = std::uint64_t {64};
+
+enum class ArchiveFormat : std::uint32_t {
+    kRaw,        // file copied as-is
+    kImageRGBA8  // ArchiveImageHeader followed by decoded RGBA8 pixels
+};
+
+enum ArchiveFlags : std::uint32_t {
+    kArchiveCompressed = 1 << 0
+};
+
+struct ArchiveHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t entry_count;
+    std::uint32_t reserved;
+};
+
+struct ArchiveEntry {
+    std::uint64_t hash;
+    std::uint64_t offset;
+    std::uint64_t size;      // stored bytes
+    std::uint64_t raw_size;  // bytes after decompression
+    std::uint32_t path_offset;
+    std::uint32_t path_size;
+    ArchiveFormat format;
+    std::uint32_t flags;
+};
+
+struct ArchiveImageHeader {
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t depth;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(ArchiveHeader) == 16);
+static_assert(sizeof(ArchiveEntry) == 48);
+static_assert(sizeof(ArchiveImageHeader) == 16);
+
+// FNV-1a over the generic (forward slash) relative path
+constexpr auto ArchiveHash(std::string_view path) {
+    auto hash = std::uint64_t {0xcbf29ce484222325};
+    for (auto c : path) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= std::uint64_t {0x100000001b3};
+    }
+    return hash;
+}
\ No newline at end of file
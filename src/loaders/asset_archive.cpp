@@ -0,0 +1,182 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "asset_archive.h"
+
+#include "loaders/compression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <vector>
+
+// largest decompressed entry Read will allocate for
+constexpr auto kMaxRawSize = std::uint64_t {1} << 30;
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+auto AssetArchive::Open(const fs::path& path)
+    -> std::expected<std::shared_ptr<AssetArchive>, std::string> {
+    auto archive = std::shared_ptr<AssetArchive>(new AssetArchive());
+    if (auto mapped = archive->Map(path); !mapped) {
+        return std::unexpected(mapped.error());
+    }
+
+    auto header = ArchiveHeader {};
+    if (archive->size_ < sizeof(header)) {
+        return std::unexpected(std::format("Truncated archive '{}'", path.string()));
+    }
+    std::memcpy(&header, archive->data_, sizeof(header));
+
+    if (header.magic != kArchiveMagic || header.version != kArchiveVersion) {
+        return std::unexpected(std::format("Invalid archive '{}'", path.string()));
+    }
+
+    const auto toc_size = header.entry_count * sizeof(ArchiveEntry);
+    if (archive->size_ < sizeof(header) + toc_size) {
+        return std::unexpected(std::format("Truncated archive '{}'", path.string()));
+    }
+
+    // the header is 16 bytes and the mapping is page aligned, so the table
+    // of contents can be used in place
+    archive->entries_ = {
+        reinterpret_cast<const ArchiveEntry*>(archive->data_ + sizeof(header)),
+        header.entry_count
+    };
+
+    // compared by subtraction, since a crafted offset plus size can wrap
+    const auto fits = [size = archive->size_](std::uint64_t offset, std::uint64_t bytes) {
+        return offset <= size && bytes <= size - offset;
+    };
+    for (const auto& entry : archive->entries_) {
+        if (!fits(entry.offset, entry.size) || !fits(entry.path_offset, entry.path_size)) {
+            return std::unexpected(std::format("Corrupt entry in archive '{}'", path.string()));
+        }
+        // raw_size sizes the buffer Read allocates, so bound it before trusting it
+        if ((entry.flags & kArchiveCompressed) &&
+            (entry.raw_size > kMaxRawSize || entry.raw_size > entry.size * kMaxExpansion)) {
+            return std::unexpected(std::format("Corrupt entry in archive '{}'", path.string()));
+        }
+    }
+
+    return archive;
+}
+
+auto AssetArchive::Find(const fs::path& path) const -> const ArchiveEntry* {
+    const auto key = path.lexically_normal().generic_string();
+    const auto hash = ArchiveHash(key);
+
+    auto entry = std::ranges::lower_bound(entries_, hash, {}, &ArchiveEntry::hash);
+    for (; entry != end(entries_) && entry->hash == hash; ++entry) {
+        if (EntryPath(*entry) == key) {
+            return &*entry;
+        }
+    }
+    return nullptr;
+}
+
+auto AssetArchive::Read(const ArchiveEntry& entry) const
+    -> std::expected<AssetData, std::string> {
+    const auto stored = std::span {data_ + entry.offset, entry.size};
+
+    if ((entry.flags & kArchiveCompressed) == 0) {
+        return AssetData {
+            .bytes = stored,
+            .owner = shared_from_this(),
+            .format = entry.format
+        };
+    }
+
+    auto buffer = std::make_shared<std::vector<std::byte>>(entry.raw_size);
+    if (!Decompress(stored, *buffer)) {
+        return std::unexpected(std::format("Failed to decompress '{}'", EntryPath(entry)));
+    }
+
+    return AssetData {
+        .bytes = *buffer,
+        .owner = buffer,
+        .format = entry.format
+    };
+}
+
+auto AssetArchive::EntryPath(const ArchiveEntry& entry) const -> std::string_view {
+    return {reinterpret_cast<const char*>(data_ + entry.path_offset), entry.path_size};
+}
+
+#ifdef _WIN32
+
+auto AssetArchive::Map(const fs::path& path) -> std::expected<void, std::string> {
+    file_ = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        return std::unexpected(std::format("File not found '{}'", path.string()));
+    }
+
+    auto size = LARGE_INTEGER {};
+    GetFileSizeEx(file_, &size);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        return std::unexpected(std::format("Failed to map '{}'", path.string()));
+    }
+
+    data_ = static_cast<const std::byte*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        return std::unexpected(std::format("Failed to map '{}'", path.string()));
+    }
+    return {};
+}
+
+AssetArchive::~AssetArchive() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+}
+
+#else
+
+auto AssetArchive::Map(const fs::path& path) -> std::expected<void, std::string> {
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::unexpected(std::format("File not found '{}'", path.string()));
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return std::unexpected(std::format("Failed to stat '{}'", path.string()));
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+
+    // the mapping stays valid after the descriptor is closed
+    auto data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return std::unexpected(std::format("Failed to map '{}'", path.string()));
+    }
+    data_ = static_cast<const std::byte*>(data);
+    return {};
+}
+
+AssetArchive::~AssetArchive() {
+    if (data_) munmap(const_cast<std::byte*>(data_), size_);
+}
+
+#endif
\ No newline at end of file
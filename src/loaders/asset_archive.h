@@ -0,0 +1,63 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "loaders/archive_format.h"
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// View of one archive entry. Uncompressed payloads point straight into the
+// mapped file; owner keeps the mapping (or a decompressed copy) alive for as
+// long as the bytes are referenced.
+struct AssetData {
+    std::span<const std::byte> bytes {};
+    std::shared_ptr<const void> owner {nullptr};
+    ArchiveFormat format {ArchiveFormat::kRaw};
+};
+
+class AssetArchive : public std::enable_shared_from_this<AssetArchive> {
+public:
+    [[nodiscard]] static auto Open(const fs::path& path)
+        -> std::expected<std::shared_ptr<AssetArchive>, std::string>;
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    [[nodiscard]] auto Find(const fs::path& path) const -> const ArchiveEntry*;
+
+    [[nodiscard]] auto Contains(const fs::path& path) const {
+        return Find(path) != nullptr;
+    }
+
+    [[nodiscard]] auto Read(const ArchiveEntry& entry) const
+        -> std::expected<AssetData, std::string>;
+
+    [[nodiscard]] auto Size() const { return entries_.size(); }
+
+    ~AssetArchive();
+
+private:
+    AssetArchive() = default;
+
+    const std::byte* data_ {nullptr};
+    std::size_t size_ {0};
+
+#ifdef _WIN32
+    void* file_ {nullptr};
+    void* mapping_ {nullptr};
+#endif
+
+    std::span<const ArchiveEntry> entries_ {};
+
+    [[nodiscard]] auto Map(const fs::path& path) -> std::expected<void, std::string>;
+
+    [[nodiscard]] auto EntryPath(const ArchiveEntry& entry) const -> std::string_view;
+};
\ No newline at end of file
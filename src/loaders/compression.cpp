@@ -0,0 +1,149 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+// Stream of sequences: token (literal length << 4 | match length - 4),
+// optional extra literal length bytes, literals, 16-bit offset, optional
+// extra match length bytes. Lengths of 15 continue in bytes of 255. The
+// final sequence carries literals only.
+
+constexpr auto kMinMatch = std::size_t {4};
+constexpr auto kMaxOffset = std::size_t {0xFFFF};
+constexpr auto kHashBits = 14;
+
+static auto Read32(const std::byte* ptr) {
+    auto value = std::uint32_t {0};
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static auto Hash(std::uint32_t value) {
+    return (value * 2654435761u) >> (32 - kHashBits);
+}
+
+static auto WriteLength(std::vector<std::byte>& output, std::size_t length) {
+    while (length >= 255) {
+        output.emplace_back(std::byte {255});
+        length -= 255;
+    }
+    output.emplace_back(static_cast<std::byte>(length));
+}
+
+static auto WriteSequence(
+    std::vector<std::byte>& output,
+    std::span<const std::byte> literals,
+    std::size_t offset,
+    std::size_t match_length
+) {
+    const auto literal_length = literals.size();
+    const auto match_code = match_length ? match_length - kMinMatch : 0;
+    const auto token = (std::min<std::size_t>(literal_length, 15) << 4) |
+                        std::min<std::size_t>(match_code, 15);
+    output.emplace_back(static_cast<std::byte>(token));
+
+    if (literal_length >= 15) WriteLength(output, literal_length - 15);
+    output.insert(end(output), begin(literals), end(literals));
+
+    if (match_length == 0) return;
+
+    output.emplace_back(static_cast<std::byte>(offset & 0xFF));
+    output.emplace_back(static_cast<std::byte>(offset >> 8));
+    if (match_code >= 15) WriteLength(output, match_code - 15);
+}
+
+auto Compress(std::span<const std::byte> input) -> std::vector<std::byte> {
+    auto output = std::vector<std::byte> {};
+    output.reserve(input.size() / 2 + 16);
+
+    auto table = std::array<std::size_t, 1 << kHashBits> {};
+    table.fill(SIZE_MAX);
+
+    auto anchor = std::size_t {0};
+    auto pos = std::size_t {0};
+    const auto size = input.size();
+
+    while (size >= kMinMatch && pos + kMinMatch <= size) {
+        const auto sequence = Read32(&input[pos]);
+        const auto hash = Hash(sequence);
+        const auto candidate = table[hash];
+        table[hash] = pos;
+
+        if (candidate == SIZE_MAX ||
+            pos - candidate > kMaxOffset ||
+            Read32(&input[candidate]) != sequence) {
+            ++pos;
+            continue;
+        }
+
+        auto length = kMinMatch;
+        while (pos + length < size && input[candidate + length] == input[pos + length]) {
+            ++length;
+        }
+
+        WriteSequence(output, input.subspan(anchor, pos - anchor), pos - candidate, length);
+        pos += length;
+        anchor = pos;
+    }
+
+    WriteSequence(output, input.subspan(anchor), 0, 0);
+    return output;
+}
+
+static auto ReadLength(std::span<const std::byte> input, std::size_t& pos, std::size_t& length) {
+    auto value = std::byte {255};
+    while (value == std::byte {255}) {
+        if (pos >= input.size()) return false;
+        value = input[pos++];
+        length += static_cast<std::size_t>(value);
+    }
+    return true;
+}
+
+auto Decompress(std::span<const std::byte> input, std::span<std::byte> output) -> bool {
+    auto in = std::size_t {0};
+    auto out = std::size_t {0};
+
+    while (in < input.size()) {
+        const auto token = static_cast<std::size_t>(input[in++]);
+
+        auto literal_length = token >> 4;
+        if (literal_length == 15 && !ReadLength(input, in, literal_length)) return false;
+        if (in + literal_length > input.size() || out + literal_length > output.size()) {
+            return false;
+        }
+        if (literal_length > 0) {
+            std::memcpy(output.data() + out, input.data() + in, literal_length);
+        }
+        in += literal_length;
+        out += literal_length;
+
+        if (in == input.size()) break; // final, literal-only sequence
+
+        if (in + 2 > input.size()) return false;
+        const auto offset = static_cast<std::size_t>(input[in]) |
+                            static_cast<std::size_t>(input[in + 1]) << 8;
+        in += 2;
+
+        auto match_length = token & 0x0F;
+        if (match_length == 15 && !ReadLength(input, in, match_length)) return false;
+        match_length += kMinMatch;
+
+        if (offset == 0 || offset > out || out + match_length > output.size()) {
+            return false;
+        }
+
+        // byte-wise copy: matches may overlap their own output
+        auto source = out - offset;
+        for (auto i = std::size_t {0}; i < match_length; ++i) {
+            output[out++] = output[source++];
+        }
+    }
+
+    return out == output.size();
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Byte-oriented LZ77 block codec in the spirit of LZ4: fast to decode, no
+// entropy stage and no external dependency. Used for archive payloads.
+
+// a length byte of 255 is the densest encoding, so no input decodes to more
+// than this many bytes per byte
+constexpr auto kMaxExpansion = std::size_t {255};
+
+auto Compress(std::span<const std::byte> input) -> std::vector<std::byte>;
+
+// output must be exactly the size of the original data; returns false if the
+// input is malformed or decodes to more or fewer bytes than output holds
+auto Decompress(std::span<const std::byte> input, std::span<std::byte> output) -> bool;
\ No newline at end of file
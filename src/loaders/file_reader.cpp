@@ -0,0 +1,455 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "file_reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#elif !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+constexpr auto kMaxPoolThreads = 8u;
+
+// blocking read used by the thread pool backend
+static auto ReadFile(const fs::path& path) -> FileBuffer {
+#ifdef _WIN32
+    auto file = std::ifstream {path, std::ios::binary | std::ios::ate};
+    if (!file) {
+        return std::unexpected(std::format("File not found '{}'", path.string()));
+    }
+    auto buffer = std::vector<std::byte>(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    if (!file) {
+        return std::unexpected(std::format("Failed to read '{}'", path.string()));
+    }
+    return buffer;
+#else
+    const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(std::format("File not found '{}'", path.string()));
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return std::unexpected(std::format("Failed to stat '{}'", path.string()));
+    }
+
+    auto buffer = std::vector<std::byte>(static_cast<std::size_t>(info.st_size));
+    auto offset = std::size_t {0};
+    while (offset < buffer.size()) {
+        const auto result = pread(fd, buffer.data() + offset, buffer.size() - offset, offset);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) break;
+        offset += static_cast<std::size_t>(result);
+    }
+    close(fd);
+
+    if (offset != buffer.size()) {
+        return std::unexpected(std::format("Failed to read '{}'", path.string()));
+    }
+    return buffer;
+#endif
+}
+
+// Threads for blocking reads, started once and shared by every call. They
+// are separate from the compute pool, which blocking reads would stall.
+class ReadThreads {
+public:
+    static auto Get() -> ReadThreads& {
+        static auto instance = ReadThreads {};
+        return instance;
+    }
+
+    // deleted copy constructors and assignment operators
+    ReadThreads(const ReadThreads&) = delete;
+    ReadThreads& operator=(const ReadThreads&) = delete;
+
+    auto Post(std::function<void()> job) -> void {
+        {
+            auto lock = std::scoped_lock {mutex_};
+            jobs_.emplace_back(std::move(job));
+        }
+        wake_.notify_one();
+    }
+
+private:
+    std::mutex mutex_ {};
+    std::condition_variable_any wake_ {};
+    std::deque<std::function<void()>> jobs_ {};
+
+    // last, so the threads are joined before what they use is destroyed
+    std::vector<std::jthread> threads_ {};
+
+    ReadThreads() {
+        const auto count = std::clamp(std::thread::hardware_concurrency(), 1u, kMaxPoolThreads);
+        for (auto i = 0u; i < count; ++i) {
+            threads_.emplace_back([this](std::stop_token stop) { Work(stop); });
+        }
+    }
+
+    auto Work(std::stop_token stop) -> void {
+        auto lock = std::unique_lock {mutex_};
+        while (wake_.wait(lock, stop, [this] { return !jobs_.empty(); })) {
+            auto job = std::move(jobs_.front());
+            jobs_.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+};
+
+static auto ReadManyThreadPool(std::span<const fs::path> paths, const FileReadCallback& callback) {
+    auto mutex = std::mutex {};
+    auto ready = std::condition_variable {};
+    auto completed = std::vector<std::pair<std::size_t, FileBuffer>> {};
+
+    for (auto index = std::size_t {0}; index < paths.size(); ++index) {
+        ReadThreads::Get().Post([&, index]() {
+            auto buffer = ReadFile(paths[index]);
+            auto lock = std::scoped_lock {mutex};
+            completed.emplace_back(index, std::move(buffer));
+            ready.notify_one();
+        });
+    }
+
+    // hand buffers to the caller on this thread as they complete
+    for (auto delivered = std::size_t {0}; delivered < paths.size();) {
+        auto batch = std::vector<std::pair<std::size_t, FileBuffer>> {};
+        {
+            auto lock = std::unique_lock {mutex};
+            ready.wait(lock, [&]() { return !completed.empty(); });
+            std::swap(batch, completed);
+        }
+        for (auto& [index, buffer] : batch) {
+            callback(index, std::move(buffer));
+            ++delivered;
+        }
+    }
+}
+
+#ifdef __linux__
+
+// Minimal io_uring driver using the raw system calls, so no liburing
+// dependency is needed. Only used from one thread at a time.
+class IoUring {
+public:
+    explicit IoUring(unsigned entries) {
+        auto params = io_uring_params {};
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) return;
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const auto single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+
+        sq_ptr_ = Map(sq_size_, IORING_OFF_SQ_RING);
+        cq_ptr_ = single_mmap ? sq_ptr_ : Map(cq_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(Map(sqes_size_, IORING_OFF_SQES));
+        if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            Release();
+            return;
+        }
+
+        const auto sq = static_cast<std::byte*>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+
+        const auto cq = static_cast<std::byte*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    [[nodiscard]] auto IsValid() const { return fd_ >= 0; }
+
+    [[nodiscard]] auto Capacity() const { return sq_entries_; }
+
+    auto PushRead(int fd, std::span<std::byte> buffer, std::uint64_t offset, std::uint64_t user_data) {
+        const auto tail = *sq_tail_;
+        const auto head = std::atomic_ref {*sq_head_}.load(std::memory_order_acquire);
+        if (tail - head == sq_entries_) return false;
+
+        const auto index = tail & sq_mask_;
+        auto& sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer.data());
+        sqe.len = static_cast<std::uint32_t>(std::min<std::size_t>(buffer.size(), 1u << 30));
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        sq_array_[index] = index;
+
+        std::atomic_ref {*sq_tail_}.store(tail + 1, std::memory_order_release);
+        ++pending_submit_;
+        return true;
+    }
+
+    // submits queued reads and waits for at least one completion; false
+    // when the kernel took none of them, which stay queued. Reads are taken
+    // in the order they were pushed, even when only some are.
+    auto SubmitAndWait() {
+        const auto result = Enter(pending_submit_);
+        if (result > 0) pending_submit_ -= std::min(pending_submit_, static_cast<unsigned>(result));
+        return result >= 0;
+    }
+
+    // waits for a completion without submitting anything more
+    auto Wait() { return Enter(0) >= 0; }
+
+    // pushed but not yet taken by the kernel
+    [[nodiscard]] auto Unsubmitted() const { return pending_submit_; }
+
+    template <typename Callback>
+    auto Reap(Callback&& callback) {
+        auto head = *cq_head_;
+        const auto tail = std::atomic_ref {*cq_tail_}.load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            const auto& cqe = cqes_[head & cq_mask_];
+            callback(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref {*cq_head_}.store(head, std::memory_order_release);
+    }
+
+    ~IoUring() { Release(); }
+
+private:
+    int fd_ {-1};
+
+    void* sq_ptr_ {MAP_FAILED};
+    void* cq_ptr_ {MAP_FAILED};
+    io_uring_sqe* sqes_ {static_cast<io_uring_sqe*>(MAP_FAILED)};
+    std::size_t sq_size_ {0};
+    std::size_t cq_size_ {0};
+    std::size_t sqes_size_ {0};
+
+    unsigned* sq_head_ {nullptr};
+    unsigned* sq_tail_ {nullptr};
+    unsigned* sq_array_ {nullptr};
+    unsigned sq_mask_ {0};
+    unsigned sq_entries_ {0};
+
+    unsigned* cq_head_ {nullptr};
+    unsigned* cq_tail_ {nullptr};
+    io_uring_cqe* cqes_ {nullptr};
+    unsigned cq_mask_ {0};
+
+    unsigned pending_submit_ {0};
+
+    auto Enter(unsigned submit) const -> long {
+        auto result = 0L;
+        do {
+            result = syscall(__NR_io_uring_enter, fd_, submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        } while (result < 0 && errno == EINTR);
+        return result;
+    }
+
+    auto Map(std::size_t size, std::uint64_t offset) const -> void* {
+        return mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+    }
+
+    auto Release() -> void {
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+        if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_size_);
+        if (sq_ptr_ != MAP_FAILED) munmap(sq_ptr_, sq_size_);
+        sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+        sq_ptr_ = cq_ptr_ = MAP_FAILED;
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+    }
+};
+
+constexpr auto kRingEntries = 64u;
+
+static auto ReadManyIoUring(IoUring& ring, std::span<const fs::path> paths, const FileReadCallback& callback) {
+    struct Request {
+        int fd {-1};
+        std::vector<std::byte> buffer {};
+        std::size_t offset {0};
+    };
+
+    auto requests = std::vector<Request>(paths.size());
+    auto next = std::size_t {0};
+    auto in_flight = std::size_t {0};
+    auto delivered = std::size_t {0};
+
+    const auto finish = [&](std::size_t index, FileBuffer result) {
+        auto& request = requests[index];
+        if (request.fd >= 0) close(request.fd);
+        request.fd = -1;
+        callback(index, std::move(result));
+        ++delivered;
+    };
+
+    const auto fallback = [&](std::size_t index) {
+        if (requests[index].fd >= 0) close(requests[index].fd);
+        requests[index].fd = -1;
+        callback(index, ReadFile(paths[index]));
+        ++delivered;
+    };
+
+    // reads pushed but not yet taken by the kernel, oldest first
+    auto queued = std::deque<std::size_t> {};
+    const auto push = [&](std::size_t index) {
+        auto& request = requests[index];
+        ring.PushRead(request.fd, std::span {request.buffer}.subspan(request.offset), request.offset, index);
+        queued.push_back(index);
+        ++in_flight;
+    };
+
+    while (delivered < paths.size()) {
+        // open and queue as many files as the ring has room for
+        while (next < paths.size() && in_flight < ring.Capacity()) {
+            const auto index = next++;
+            auto& request = requests[index];
+            request.fd = open(paths[index].c_str(), O_RDONLY | O_CLOEXEC);
+            if (request.fd < 0) {
+                finish(index, std::unexpected(std::format("File not found '{}'", paths[index].string())));
+                continue;
+            }
+
+            struct stat info {};
+            if (fstat(request.fd, &info) != 0) {
+                finish(index, std::unexpected(std::format("Failed to stat '{}'", paths[index].string())));
+                continue;
+            }
+
+            request.buffer.resize(static_cast<std::size_t>(info.st_size));
+            if (request.buffer.empty()) {
+                finish(index, std::move(request.buffer));
+                continue;
+            }
+
+            push(index);
+        }
+
+        if (in_flight == 0) continue;
+
+        if (!ring.SubmitAndWait()) {
+            // the ring is unusable. Queued reads never reached the kernel, so
+            // they are read synchronously now; submitted ones own their
+            // buffers and fds until they complete
+            for (const auto index : queued) fallback(index);
+            in_flight -= queued.size();
+            queued.clear();
+            while (in_flight > 0 && ring.Wait()) {
+                ring.Reap([&](std::uint64_t user_data, int) {
+                    --in_flight;
+                    fallback(static_cast<std::size_t>(user_data));
+                });
+            }
+
+            // the kernel may still write into what it was never seen to
+            // finish, so those buffers are left allocated
+            for (auto i = std::size_t {0}; in_flight > 0 && i < next; ++i) {
+                auto& request = requests[i];
+                if (request.fd < 0) continue;
+                static_cast<void>(new std::vector<std::byte>(std::move(request.buffer)));
+                finish(i, std::unexpected(std::format("Failed to read '{}'", paths[i].string())));
+            }
+            for (; next < paths.size(); ++next) {
+                fallback(next);
+            }
+            return;
+        }
+        while (queued.size() > ring.Unsubmitted()) queued.pop_front();
+
+        ring.Reap([&](std::uint64_t user_data, int result) {
+            const auto index = static_cast<std::size_t>(user_data);
+            auto& request = requests[index];
+            --in_flight;
+
+            if (result < 0) {
+                // e.g. IORING_OP_READ is not supported by this kernel
+                fallback(index);
+                return;
+            }
+
+            request.offset += static_cast<std::size_t>(result);
+            if (result == 0 || request.offset == request.buffer.size()) {
+                request.buffer.resize(request.offset);
+                finish(index, std::move(request.buffer));
+                return;
+            }
+
+            // short read, queue the remainder
+            push(index);
+        });
+    }
+}
+
+static auto UringSupported() {
+    static const auto supported = IoUring {1}.IsValid();
+    return supported;
+}
+
+#endif
+
+auto FileReader::ReadMany(std::span<const fs::path> paths, const FileReadCallback& callback) -> void {
+    ReadMany(paths, callback, GetBackend());
+}
+
+auto FileReader::ReadMany(
+    std::span<const fs::path> paths,
+    const FileReadCallback& callback,
+    Backend backend
+) -> void {
+    if (paths.empty()) return;
+
+#ifdef __linux__
+    if (backend == Backend::kIoUring && UringSupported()) {
+        auto ring = IoUring {kRingEntries};
+        if (ring.IsValid()) {
+            ReadManyIoUring(ring, paths, callback);
+            return;
+        }
+    }
+#else
+    (void)backend;
+#endif
+
+    ReadManyThreadPool(paths, callback);
+}
+
+auto FileReader::GetBackend() -> Backend {
+#ifdef __linux__
+    if (UringSupported()) return Backend::kIoUring;
+#endif
+    return Backend::kThreadPool;
+}
\ No newline at end of file
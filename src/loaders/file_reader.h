@@ -0,0 +1,42 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using FileBuffer = std::expected<std::vector<std::byte>, std::string>;
+
+using FileReadCallback = std::function<void(std::size_t index, FileBuffer buffer)>;
+
+class FileReader {
+public:
+    enum class Backend {
+        kIoUring,
+        kThreadPool
+    };
+
+    // Reads every file in paths and blocks until all reads have completed.
+    // callback runs on the calling thread, in completion order, as soon as
+    // each file is fully read; index refers to the position in paths.
+    static auto ReadMany(std::span<const fs::path> paths, const FileReadCallback& callback) -> void;
+
+    // the same with a given backend, for comparing them; io_uring falls back
+    // to the thread pool where it is not available
+    static auto ReadMany(
+        std::span<const fs::path> paths,
+        const FileReadCallback& callback,
+        Backend backend
+    ) -> void;
+
+    // io_uring on Linux kernels that allow it, a pread thread pool elsewhere
+    [[nodiscard]] static auto GetBackend() -> Backend;
+};
\ No newline at end of file
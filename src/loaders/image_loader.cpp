@@ -5,6 +5,7 @@
 
 #include "image_loader.h"
 
+#include <cstring>
 #include <iostream>
 
 #include <stb_image.h>
@@ -30,4 +31,49 @@ auto ImageLoader::LoadImpl(const fs::path& path) const -> std::shared_ptr<void>
         .height = height,
         .depth = depth
     }, ImageData(data, &stbi_image_free)});
+}
+
+auto ImageLoader::LoadFromMemory(const fs::path& path, const AssetData& data) const
+    -> std::shared_ptr<void> {
+    if (data.format == ArchiveFormat::kImageRGBA8) {
+        auto header = ArchiveImageHeader {};
+        if (data.bytes.size() < sizeof(header)) return nullptr;
+        std::memcpy(&header, data.bytes.data(), sizeof(header));
+
+        const auto pixels = data.bytes.subspan(sizeof(header));
+        if (pixels.size() < static_cast<std::size_t>(header.width) * header.height * 4) {
+            return nullptr;
+        }
+
+        // zero-copy: the image borrows the archive bytes and keeps their owner
+        // alive until it is destroyed; the pixels are only ever read
+        auto pixel_data = reinterpret_cast<unsigned char*>(const_cast<std::byte*>(pixels.data()));
+        return std::make_shared<Image>(Image {{
+            .filename = path.filename().string(),
+            .width = static_cast<int>(header.width),
+            .height = static_cast<int>(header.height),
+            .depth = static_cast<int>(header.depth)
+        }, ImageData(pixel_data, [owner = data.owner](void*) {})});
+    }
+
+    auto width = 0;
+    auto height = 0;
+    auto depth = 0;
+    auto image_data = stbi_load_from_memory(
+        reinterpret_cast<const stbi_uc*>(data.bytes.data()),
+        static_cast<int>(data.bytes.size()),
+        &width, &height, &depth, 4
+    );
+
+    if (image_data == nullptr) {
+        std::cerr << "Failed to load image '" << path.string() << "'\n";
+        return nullptr;
+    }
+
+    return std::make_shared<Image>(Image {{
+        .filename = path.filename().string(),
+        .width = width,
+        .height = height,
+        .depth = depth
+    }, ImageData(image_data, &stbi_image_free)});
 }
\ No newline at end of file
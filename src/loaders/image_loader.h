@@ -28,4 +28,7 @@ private:
     [[nodiscard]] auto ValidFileExtensions() const -> std::vector<std::string> override;
 
     [[nodiscard]] auto LoadImpl(const fs::path& path) const -> std::shared_ptr<void> override;
+
+    [[nodiscard]] auto LoadFromMemory(const fs::path& path, const AssetData& data) const
+        -> std::shared_ptr<void> override;
 };
\ No newline at end of file
@@ -3,6 +3,12 @@
 
 #pragma once
 
+#include "core/main_thread_queue.h"
+#include "core/task.h"
+#include "core/worker_pool.h"
+#include "loaders/asset_archive.h"
+#include "loaders/file_reader.h"
+
 #include <algorithm>
 #include <expected>
 #include <filesystem>
@@ -11,6 +17,7 @@
 #include <iostream>
 #include <memory>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -21,37 +28,58 @@ using LoaderResult = std::expected<std::shared_ptr<T>, std::string>;
 template <typename T>
 using LoaderCallback = std::function<void(LoaderResult<T>)>;
 
+template <typename T>
+using LoaderBatchCallback = std::function<void(std::vector<LoaderResult<T>>)>;
+
 template <typename Resource>
 class Loader : public std::enable_shared_from_this<Loader<Resource>> {
 public:
     auto Load(const fs::path& path, LoaderCallback<Resource> callback) const {
         if (!ValidateFile(path, callback)) return;
-
-        auto resource = std::static_pointer_cast<Resource>(LoadImpl(path));
-        if (resource) {
-            callback(resource);
-        } else {
-            const auto message = std::format("Failed to load resource '{}'", path.string());
-            std::cerr << message << '\n';
-            callback(std::unexpected(message));
-        }
+        callback(LoadResource(path));
     }
 
     auto LoadAsync(const fs::path& path, LoaderCallback<Resource> callback) const {
         if (!ValidateFile(path, callback)) return;
         auto self = this->shared_from_this();
         std::thread([self, path, callback]() {
-            auto resource = std::static_pointer_cast<Resource>(self->LoadImpl(path));
-            if (resource) {
-                callback(resource);
-            } else {
-                const auto message = std::format("Failed to load resource '{}'", path.string());
-                std::cerr << message << '\n';
-                callback(std::unexpected(message));
-            }
+            auto result = self->LoadResource(path);
+            // callbacks run on the render thread, see Window::Start
+            MainThreadQueue::Get().Post([callback, result = std::move(result)]() {
+                callback(result);
+            });
         }).detach();
     }
 
+    // Reads all files with one batched I/O submission (io_uring where
+    // available) and decodes the buffers on the shared worker pool as their
+    // reads complete.
+    // Requires LoadFromMemory; results are in the order of paths.
+    auto LoadMany(std::vector<fs::path> paths, LoaderBatchCallback<Resource> callback) const {
+        auto self = this->shared_from_this();
+        std::thread([self, paths = std::move(paths), callback]() {
+            auto results = self->LoadBatch(paths);
+            MainThreadQueue::Get().Post([callback, results = std::move(results)]() {
+                callback(results);
+            });
+        }).detach();
+    }
+
+    // starts loading immediately; co_await the result from a Task
+    [[nodiscard]] auto LoadTask(const fs::path& path) const {
+        auto future = Future<LoaderResult<Resource>> {};
+        LoadAsync(path, [future](LoaderResult<Resource> result) mutable {
+            future.Set(std::move(result));
+        });
+        return future;
+    }
+
+    // paths found in the archive are served from it instead of the file
+    // system; set before issuing loads
+    auto SetArchive(std::shared_ptr<AssetArchive> archive) {
+        archive_ = std::move(archive);
+    }
+
     virtual ~Loader() = default;
 
 protected:
@@ -59,7 +87,95 @@ protected:
 
     [[nodiscard]] virtual auto LoadImpl(const fs::path& path) const -> std::shared_ptr<void> = 0;
 
+    // loaders that can decode archive payloads override this
+    [[nodiscard]] virtual auto LoadFromMemory(const fs::path&, const AssetData&) const
+        -> std::shared_ptr<void> {
+        return nullptr;
+    }
+
 private:
+    std::shared_ptr<AssetArchive> archive_ {nullptr};
+
+    auto LoadResource(const fs::path& path) const -> LoaderResult<Resource> {
+        auto resource = std::shared_ptr<Resource> {nullptr};
+        if (auto entry = archive_ ? archive_->Find(path) : nullptr) {
+            auto data = archive_->Read(*entry);
+            if (!data) {
+                std::cerr << data.error() << '\n';
+                return std::unexpected(data.error());
+            }
+            resource = std::static_pointer_cast<Resource>(LoadFromMemory(path, data.value()));
+        } else {
+            resource = std::static_pointer_cast<Resource>(LoadImpl(path));
+        }
+
+        if (!resource) {
+            const auto message = std::format("Failed to load resource '{}'", path.string());
+            std::cerr << message << '\n';
+            return std::unexpected(message);
+        }
+        return resource;
+    }
+
+    auto LoadBatch(const std::vector<fs::path>& paths) const {
+        auto results = std::vector<LoaderResult<Resource>>(paths.size());
+        auto reads = std::vector<fs::path> {};
+        auto read_indices = std::vector<std::size_t> {};
+
+        for (auto i = std::size_t {0}; i < paths.size(); ++i) {
+            if (!ValidateFileType(paths[i])) {
+                const auto& str = paths[i].extension().string();
+                results[i] = std::unexpected(std::format("Unsupported file type '{}'", str));
+            } else if (archive_ && archive_->Contains(paths[i])) {
+                results[i] = LoadResource(paths[i]);
+            } else {
+                reads.emplace_back(paths[i]);
+                read_indices.emplace_back(i);
+            }
+        }
+
+        // completed buffers are decoded on the pool a few at a time, one
+        // task each, while the reads still queued carry on; no task waits
+        auto& pool = WorkerPool::Get();
+        auto buffers = std::vector<std::pair<std::size_t, std::vector<std::byte>>> {};
+        const auto decode = [&]() {
+            pool.Run(buffers.size(), [&](std::size_t i) {
+                auto& [index, bytes] = buffers[i];
+                results[index] = Decode(paths[index], std::move(bytes));
+            });
+            buffers.clear();
+        };
+
+        FileReader::ReadMany(reads, [&](std::size_t i, FileBuffer buffer) {
+            const auto index = read_indices[i];
+            if (!buffer) {
+                results[index] = std::unexpected(buffer.error());
+                return;
+            }
+            buffers.emplace_back(index, std::move(buffer.value()));
+            if (buffers.size() >= pool.Concurrency()) decode();
+        });
+        decode();
+
+        return results;
+    }
+
+    auto Decode(const fs::path& path, std::vector<std::byte> bytes) const -> LoaderResult<Resource> {
+        auto buffer = std::make_shared<const std::vector<std::byte>>(std::move(bytes));
+        auto resource = std::static_pointer_cast<Resource>(LoadFromMemory(path, {
+            .bytes = *buffer,
+            .owner = buffer,
+            .format = ArchiveFormat::kRaw
+        }));
+
+        if (!resource) {
+            const auto message = std::format("Failed to load resource '{}'", path.string());
+            std::cerr << message << '\n';
+            return std::unexpected(message);
+        }
+        return resource;
+    }
+
     auto ValidateFile(const fs::path& path, LoaderCallback<Resource> callback) const {
         if (!ValidateFileType(path)) {
             const auto& str = path.extension().string();
@@ -68,6 +184,10 @@ private:
             return false;
         }
 
+        if (archive_ && archive_->Contains(path)) {
+            return true;
+        }
+
         if (!fs::exists(path)) {
             const auto& str = path.string();
             const auto message = std::format("File not found '{}'", str);
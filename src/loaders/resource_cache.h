@@ -0,0 +1,272 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include "core/main_thread_queue.h"
+#include "loaders/loader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+template <typename T>
+auto ResourceBytes(const T& resource) -> std::size_t {
+    if constexpr (requires { resource.Bytes(); }) {
+        return resource.Bytes();
+    } else {
+        return sizeof(T);
+    }
+}
+
+template <typename Resource>
+class ResourceCache : public std::enable_shared_from_this<ResourceCache<Resource>> {
+public:
+    struct Stats {
+        std::size_t hits {0};
+        std::size_t misses {0};
+        std::size_t coalesced {0};
+        std::size_t invalidated {0};
+        std::size_t bytes_deduplicated {0};
+
+        [[nodiscard]] auto HitRate() const {
+            const auto requests = hits + misses + coalesced;
+            return requests ? static_cast<double>(hits + coalesced) / requests : 0.0;
+        }
+    };
+
+    [[nodiscard]] static auto Create(
+        std::shared_ptr<Loader<Resource>> loader,
+        bool invalidate_on_change = false
+    ) -> std::shared_ptr<ResourceCache> {
+        return std::shared_ptr<ResourceCache>(
+            new ResourceCache(std::move(loader), invalidate_on_change)
+        );
+    }
+
+    // a path that is already loading, synchronously or not, is waited on
+    // rather than read a second time; a miss is registered as in flight so
+    // that later requests wait on it in turn
+    auto Load(const fs::path& path, LoaderCallback<Resource> callback) {
+        const auto key = path.lexically_normal().string();
+        const auto modified = Modified(path);
+        auto resource = std::shared_ptr<Resource> {};
+        auto pending = std::shared_future<LoaderResult<Resource>> {};
+        auto promise = std::promise<LoaderResult<Resource>> {};
+        {
+            auto lock = std::scoped_lock {mutex_};
+            resource = Lookup(key, modified);
+            if (auto in_flight = in_flight_.find(key); !resource && in_flight != end(in_flight_)) {
+                pending = in_flight->second.result;
+                ++stats_.coalesced;
+            } else if (!resource) {
+                in_flight_.try_emplace(key, InFlight {
+                    .callbacks = {},
+                    .result = promise.get_future().share()
+                });
+            }
+        }
+        if (resource) {
+            callback(resource);
+            return;
+        }
+        if (pending.valid()) {
+            // set by the loading thread, so this never waits on the render
+            // thread that may be calling
+            callback(pending.get());
+            return;
+        }
+
+        loader_->Load(path, [&](LoaderResult<Resource> result) {
+            promise.set_value(result);
+
+            // asynchronous requests that joined this load still get their
+            // callbacks on the render thread
+            auto callbacks = std::vector<LoaderCallback<Resource>> {};
+            {
+                auto lock = std::scoped_lock {mutex_};
+                callbacks = std::move(in_flight_[key].callbacks);
+                in_flight_.erase(key);
+                if (result) {
+                    Store(key, modified, result.value());
+                    stats_.bytes_deduplicated += entries_[key].bytes * callbacks.size();
+                }
+            }
+            if (!callbacks.empty()) {
+                MainThreadQueue::Get().Post([callbacks = std::move(callbacks), result]() {
+                    for (const auto& callback : callbacks) {
+                        callback(result);
+                    }
+                });
+            }
+
+            callback(std::move(result));
+        });
+    }
+
+    // concurrent requests for a path that is already loading are coalesced
+    // onto the in-flight load; every callback fires once on the render thread
+    auto LoadAsync(const fs::path& path, LoaderCallback<Resource> callback) {
+        const auto key = path.lexically_normal().string();
+        const auto modified = Modified(path);
+        auto promise = std::promise<LoaderResult<Resource>> {};
+        {
+            auto lock = std::scoped_lock {mutex_};
+            if (auto resource = Lookup(key, modified)) {
+                MainThreadQueue::Get().Post([callback, resource]() {
+                    callback(resource);
+                });
+                return;
+            }
+            if (auto in_flight = in_flight_.find(key); in_flight != end(in_flight_)) {
+                in_flight->second.callbacks.emplace_back(std::move(callback));
+                ++stats_.coalesced;
+                return;
+            }
+            in_flight_.try_emplace(key, InFlight {
+                .callbacks = {std::move(callback)},
+                .result = promise.get_future().share()
+            });
+        }
+
+        // the result is published to synchronous loads as soon as it is
+        // read, and to the callbacks on the render thread
+        auto self = this->shared_from_this();
+        std::thread([self, key, path, promise = std::move(promise)]() mutable {
+            self->loader_->Load(path, [&](LoaderResult<Resource> result) {
+                promise.set_value(result);
+                MainThreadQueue::Get().Post([self, key, path, result = std::move(result)]() {
+                    self->OnLoaded(key, path, result);
+                });
+            });
+        }).detach();
+    }
+
+    [[nodiscard]] auto LoadTask(const fs::path& path) {
+        auto future = Future<LoaderResult<Resource>> {};
+        LoadAsync(path, [future](LoaderResult<Resource> result) mutable {
+            future.Set(std::move(result));
+        });
+        return future;
+    }
+
+    auto Clear() {
+        auto lock = std::scoped_lock {mutex_};
+        entries_.clear();
+    }
+
+    [[nodiscard]] auto GetStats() const {
+        auto lock = std::scoped_lock {mutex_};
+        return stats_;
+    }
+
+private:
+    struct Entry {
+        std::weak_ptr<Resource> resource;
+        fs::file_time_type modified;
+        std::size_t bytes {0};
+    };
+
+    struct InFlight {
+        std::vector<LoaderCallback<Resource>> callbacks;
+        std::shared_future<LoaderResult<Resource>> result;
+    };
+
+    // expired entries are swept once the map reaches this size
+    static constexpr auto kMinSweep = std::size_t {64};
+
+    ResourceCache(std::shared_ptr<Loader<Resource>> loader, bool invalidate_on_change) :
+        loader_(std::move(loader)),
+        invalidate_on_change_(invalidate_on_change) {}
+
+    std::shared_ptr<Loader<Resource>> loader_;
+
+    std::unordered_map<std::string, Entry> entries_;
+    std::unordered_map<std::string, InFlight> in_flight_;
+    std::size_t sweep_at_ {kMinSweep};
+
+    mutable std::mutex mutex_;
+
+    Stats stats_ {};
+
+    bool invalidate_on_change_ {false};
+
+    // expects mutex_ to be held; modified is the file's current time
+    auto Lookup(const std::string& key, fs::file_time_type modified) -> std::shared_ptr<Resource> {
+        auto entry = entries_.find(key);
+        if (entry == end(entries_)) {
+            if (!in_flight_.contains(key)) ++stats_.misses;
+            return nullptr;
+        }
+
+        auto resource = entry->second.resource.lock();
+        if (resource && invalidate_on_change_ && entry->second.modified != modified) {
+            ++stats_.invalidated;
+            resource = nullptr;
+        }
+
+        if (!resource) {
+            entries_.erase(entry);
+            if (!in_flight_.contains(key)) ++stats_.misses;
+            return nullptr;
+        }
+
+        ++stats_.hits;
+        stats_.bytes_deduplicated += entry->second.bytes;
+        return resource;
+    }
+
+    auto OnLoaded(const std::string& key, const fs::path& path, const LoaderResult<Resource>& result) {
+        const auto modified = Modified(path);
+        auto callbacks = std::vector<LoaderCallback<Resource>> {};
+        {
+            auto lock = std::scoped_lock {mutex_};
+            callbacks = std::move(in_flight_[key].callbacks);
+            in_flight_.erase(key);
+            if (result) {
+                Store(key, modified, result.value());
+                stats_.bytes_deduplicated += entries_[key].bytes * (callbacks.size() - 1);
+            }
+        }
+
+        for (const auto& callback : callbacks) {
+            callback(result);
+        }
+    }
+
+    // expects mutex_ to be held
+    auto Store(const std::string& key, fs::file_time_type modified, const std::shared_ptr<Resource>& resource) {
+        // Lookup drops expired entries it finds; the rest are swept each
+        // time the map doubles, so storing stays constant time on average
+        if (entries_.size() >= sweep_at_) {
+            std::erase_if(entries_, [](const auto& entry) {
+                return entry.second.resource.expired();
+            });
+            sweep_at_ = std::max(kMinSweep, entries_.size() * 2);
+        }
+        entries_[key] = {
+            .resource = resource,
+            .modified = modified,
+            .bytes = ResourceBytes(*resource)
+        };
+    }
+
+    // called before taking mutex_; without invalidation nothing is stat'ed
+    auto Modified(const fs::path& path) const -> fs::file_time_type {
+        if (!invalidate_on_change_) return {};
+        auto error = std::error_code {};
+        const auto time = fs::last_write_time(path, error);
+        return error ? fs::file_time_type {} : time;
+    }
+};
\ No newline at end of file
@@ -1,34 +1,170 @@
 // Copyright © 2024 - Present, Shlomi Nissan.
 // All rights reserved.
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <imgui.h>
 
+#include "core/command_list.h"
+#include "core/debug_draw.h"
 #include "core/geometry.h"
+#ifdef HEADLESS_ENABLED
+    #include "core/headless_window.h"
+#endif
+#include "core/main_thread_queue.h"
 #include "core/perspective_camera.h"
+#include "core/profiler.h"
+#include "core/render_stats.h"
 #include "core/shaders.h"
+#include "core/task.h"
 #include "core/texture2d.h"
 #include "core/window.h"
 #include "geometries/box_geometry.h"
+#include "geometries/mesh_bvh.h"
+#include "loaders/asset_archive.h"
 #include "loaders/image_loader.h"
+#include "loaders/resource_cache.h"
+#include "resources/clustered_lights.h"
+#include "resources/orbit_controls.h"
+#include "resources/scene_index.h"
+#include "resources/terrain.h"
 #include "shaders/headers/scene_frag.h"
 #include "shaders/headers/scene_vert.h"
 
-auto main() -> int {
-    const auto win_width = 1024;
-    const auto win_height = 768;
+auto LoadTextures(ResourceCache<Image>& cache, Texture2D& texture) -> Task<> {
+    // independent loads go through WhenAll so they are all in flight at once
+    auto [image] = co_await WhenAll(cache.LoadTask("assets/checker.png"));
+    if (!image) {
+        std::cerr << image.error() << '\n';
+        co_return;
+    }
+    texture.SetImage(image.value());
+}
 
-    auto window = Window {win_width, win_height, "OpenGL starter project"};
-    auto ratio = static_cast<float>(win_width) / static_cast<float>(win_height);
-    auto camera = PerspectiveCamera {45.0f, ratio, 0.1f, 100.0f};
+auto GetOption(std::span<char*> args, std::string_view name) -> std::optional<std::string> {
+    for (auto i = std::size_t {1}; i + 1 < args.size(); ++i) {
+        if (args[i] == name) return args[i + 1];
+    }
+    return std::nullopt;
+}
+
+auto HasFlag(std::span<char*> args, std::string_view name) {
+    const auto options = args.subspan(1);
+    return std::ranges::find(options, name) != end(options);
+}
+
+// "unlimited", "vsync", "adaptive" or a target frame rate
+auto GetPacing(std::string_view pacing) -> FramePacer::Parameters {
+    using enum FramePacer::Mode;
+    if (pacing == "unlimited") return {.mode = kUnlimited};
+    if (pacing == "vsync") return {.mode = kVsync};
+    if (pacing == "adaptive") return {.mode = kAdaptiveVsync};
+    return {.mode = kTargetRate, .target_rate = std::atof(pacing.data())};
+}
+
+// lights on a shell around the cube, along a golden-angle spiral
+auto SpreadLights(std::size_t count) -> std::vector<Light> {
+    auto lights = std::vector<Light> {};
+    for (auto i = std::size_t {0}; i < count; ++i) {
+        const auto y = 1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / static_cast<float>(count);
+        const auto radius = std::sqrt(1.0f - y * y);
+        const auto angle = static_cast<float>(i) * 2.39996f;
+        lights.emplace_back(Light {
+            .position = glm::vec3 {std::cos(angle) * radius, y, std::sin(angle) * radius} * 0.8f,
+            .range = 0.6f,
+            .color = {
+                0.5f + 0.5f * std::cos(angle),
+                0.5f + 0.5f * std::cos(angle + 2.09f),
+                0.5f + 0.5f * std::cos(angle + 4.19f)
+            }
+        });
+    }
+    return lights;
+}
+
+// binary PPM, enough for diffing headless captures
+auto WritePpm(const fs::path& path, const Image& image) {
+    auto stream = std::ofstream {path, std::ios::binary};
+    stream << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+    for (auto i = std::size_t {0}; i < image.width * image.height; ++i) {
+        stream.write(reinterpret_cast<const char*>(image.Data() + i * 4), 3);
+    }
+}
+
+// the demo itself, shared by the windowed and headless entry points
+template <typename WindowType>
+auto Run(WindowType& window, std::span<char*> args, glm::vec2 viewport) -> int {
+    auto camera = PerspectiveCamera {45.0f, viewport.x / viewport.y, 0.1f, 100.0f};
+    auto controls = OrbitControls {&camera};
+
+    if constexpr (std::is_same_v<WindowType, Window>) {
+        if (auto path = GetOption(args, "--record")) {
+            auto recorder = InputRecorder::Create(path.value());
+            if (!recorder) {
+                std::cerr << recorder.error() << '\n';
+                return 1;
+            }
+            window.Record(recorder.value());
+        }
+
+        window.SetFramePacer(GetPacing(GetOption(args, "--pacing").value_or("vsync")));
+
+        if (auto budget = GetOption(args, "--dynamic-resolution")) {
+            window.SetDynamicResolution({.budget_ms = std::atof(budget->c_str())});
+        }
+
+        // the simulation is idle while this runs
+        window.SetResizeCallback([&](int width, int height) {
+            viewport = {width, height};
+            camera.SetAspect(viewport.x / viewport.y);
+        });
+    }
+
+    if (auto path = GetOption(args, "--replay")) {
+        auto replay = InputReplay::Open(path.value());
+        if (!replay) {
+            std::cerr << replay.error() << '\n';
+            return 1;
+        }
+        if constexpr (std::is_same_v<WindowType, Window>) {
+            const auto timestep = GetOption(args, "--timestep");
+            window.Replay(replay.value(), timestep ? std::atof(timestep->c_str()) : 1.0 / 60.0);
+        } else {
+            window.Replay(replay.value());
+        }
+    }
+
+    if (auto path = GetOption(args, "--frame-log")) {
+        window.LogFrameTimes(path.value());
+    }
+
+    #ifdef RENDER_STATS_ENABLED
+        if (auto path = GetOption(args, "--stats-log")) {
+            RenderStats::Get().LogFrames(path.value());
+        }
+    #endif
 
     auto image_loader = ImageLoader::Create();
+    if (auto archive = AssetArchive::Open("assets.pak")) {
+        image_loader->SetArchive(archive.value());
+    }
+    auto image_cache = ResourceCache<Image>::Create(image_loader);
     auto texture = Texture2D {};
-    auto geometry = BoxGeometry({
+    const auto box_data = BoxGeometry::Generate({
         .width = 1.0f,
         .height = 1.0f,
         .depth = 1.0f,
@@ -36,46 +172,240 @@ auto main() -> int {
         .height_segments = 1,
         .depth_segments = 1
     });
+    auto geometry = Geometry {box_data};
+
+    // written by ImGui on the render thread, read by the simulation
+    auto show_debug = std::atomic<bool> {false};
+    auto debug_draw = DebugDraw {};
+    // recorded by the simulation, handed to ImGui through the command list
+    auto debug_stats = DebugDraw::Stats {};
+
+    // dragging from a point on the cube orbits around that point
+    auto scene = SceneIndex {};
+    const auto box_bvh = std::make_shared<MeshBvh>(box_data, BvhParameters {});
+    const auto box = scene.Add(box_bvh, glm::mat4 {1.0f});
+    controls.SetPickCallback([&](const glm::vec2& cursor) -> std::optional<glm::vec3> {
+        const auto hit = scene.Raycast(camera.CursorRay(cursor, viewport));
+        if (hit && show_debug) {
+            debug_draw.Axes(glm::translate(glm::mat4 {1.0f}, hit->point), 0.2f, {.lifetime = 2.0f, .depth_test = false});
+        }
+        return hit ? std::optional {hit->point} : std::nullopt;
+    });
 
     auto shader = Shaders {{
         {ShaderType::kVertexShader, _SHADER_scene_vert},
         {ShaderType::kFragmentShader, _SHADER_scene_frag}
     }};
 
-    image_loader->LoadAsync("assets/checker.png", [&](const auto& image) {
-        if (!image) {
-            std::cerr << image.error() << '\n';
-            return;
-        }
-        texture.SetImage(image.value());
-    });
+    // without lights the cube keeps its plain texture
+    auto lighting = ClusteredLights {{}};
+    if (auto count = GetOption(args, "--lights")) {
+        lighting.lights = SpreadLights(static_cast<std::size_t>(std::atoi(count->c_str())));
+    }
+    // binned by the simulation, handed to ImGui through the command list
+    auto light_stats = ClusteredLights::Stats {};
 
-    glEnable(GL_DEPTH_TEST);
+    Spawn(LoadTextures(*image_cache, texture));
 
-    camera.transform = glm::translate(camera.transform, {0.0f, 0.0f, 1.0f});
+    auto terrain = std::unique_ptr<Terrain> {nullptr};
+    if (auto path = GetOption(args, "--terrain")) {
+        image_loader->Load(path.value(), [&terrain](LoaderResult<Image> heightmap) {
+            if (!heightmap) return;
+            terrain = std::make_unique<Terrain>(Terrain::Parameters {
+                .size = 64.0f,
+                .height = 6.0f,
+                .resolution = 32,
+                .leaf_size = 2.0f,
+                .lod_distance = 6.0f,
+                .morph_ratio = 0.3f,
+                .origin = {0.0f, -3.0f, 0.0f}
+            }, heightmap.value());
+        });
+    }
 
-    window.Start([&](const double delta){
-        glClearColor(0.0f, 0.0f, 0.5f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
 
-        ImGui::Begin("Hello, ImGui!");
-        ImGui::Text("Hello, world!");
-        ImGui::End();
+    auto time = 0.0;
+    // written by ImGui on the render thread, read by the simulation
+    auto animate = std::atomic<bool> {true};
+
+    // everything but ImGui is recorded into a command list, so with
+    // --simulation-thread it runs next to the previous frame's rendering
+    auto simulate = [&](const double delta, CommandList& commands) {
+        if (animate) time += delta;
 
+        controls.OnUpdate(static_cast<float>(delta));
         camera.OnUpdate();
 
         auto model = glm::mat4{1.0f};
         model = glm::scale(model, {0.3f, 0.3f, 0.3f});
-        model = glm::rotate(model, static_cast<float>(glfwGetTime()), {1.0f, 1.0f, 1.0f});
+        model = glm::rotate(model, static_cast<float>(time), {1.0f, 1.0f, 1.0f});
+        scene.SetTransform(box, model);
+        scene.Update();
+
+        if (show_debug) {
+            debug_draw.Box(box_bvh->Bounds().min, box_bvh->Bounds().max, model, {1.0f, 1.0f, 0.0f});
+            debug_draw.Axes(glm::translate(glm::mat4 {1.0f}, controls.Target()), 0.3f, {.depth_test = false});
+        }
 
-        shader.SetUniform("u_Projection", camera.Projection());
-        shader.SetUniform("u_ModelView", camera.View() * model);
+        commands.AddClear({0.0f, 0.0f, 0.5f, 1.0f});
+        commands.AddUniform(shader, "u_Projection", camera.Projection());
+        commands.AddUniform(shader, "u_ModelView", camera.View() * model);
 
         if (texture.IsLoaded()) {
-            texture.Bind();
-            geometry.Draw(shader);
+            lighting.Submit(commands, camera, shader);
+            commands.AddCallback([&light_stats, stats = lighting.GetStats()] { light_stats = stats; });
+            commands.AddBindTexture(texture);
+            commands.AddDraw(geometry, shader);
         }
+
+        if (terrain) {
+            // the camera is copied, it changes while the list is executed
+            commands.AddCallback([terrain = terrain.get(), camera] { terrain->Draw(camera); });
+        }
+
+        debug_draw.Submit(commands, camera.Projection() * camera.View(), delta);
+        commands.AddCallback([&debug_stats, stats = debug_draw.GetStats()] { debug_stats = stats; });
+    };
+
+    auto simulation = std::shared_ptr<SimulationThread> {nullptr};
+    auto commands = CommandList {};
+
+    if constexpr (std::is_same_v<WindowType, Window>) {
+        if (HasFlag(args, "--on-demand")) {
+            window.SetRenderMode(RenderMode::kOnDemand);
+        }
+        // the spinning cube needs every frame until it is paused
+        window.BeginContinuousRendering();
+
+        if (HasFlag(args, "--simulation-thread")) {
+            simulation = std::make_shared<SimulationThread>(simulate);
+            window.SetSimulationThread(simulation);
+        }
+    }
+
+    window.Start([&](const double delta){
+        if (simulation) {
+            simulation->Commands().Execute();
+        } else {
+            {
+                PROFILE_ZONE("Simulate");
+                commands.Reset();
+                simulate(delta, commands);
+            }
+            commands.Execute();
+        }
+
+        ImGui::Begin("Hello, ImGui!");
+        ImGui::Text("Hello, world!");
+        ImGui::Text("Pending callbacks: %zu", MainThreadQueue::Get().Depth());
+        ImGui::Text("Drained this frame: %zu", MainThreadQueue::Get().DrainedLastFrame());
+        ImGui::Text("Image cache hit rate: %.2f", image_cache->GetStats().HitRate());
+        if constexpr (std::is_same_v<WindowType, Window>) {
+            const auto& pacing = window.GetFramePacer().GetStats();
+            ImGui::Text("Frame time: %.2f ms (jitter %.2f ms)", pacing.frame_ms, pacing.jitter_ms);
+            ImGui::Text("Render thread CPU: %.0f%%", pacing.cpu_usage * 100.0);
+            ImGui::Text("Frames rendered: %u", window.FramesRendered());
+            if (const auto& scaler = window.GetResolutionScaler()) {
+                const auto& stats = scaler->GetStats();
+                ImGui::Text("Render scale: %.0f%% (scene GPU %.2f ms)", stats.scale * 100.0f, stats.gpu_ms);
+            }
+        }
+        if (terrain) {
+            const auto& stats = terrain->GetStats();
+            ImGui::Text("Terrain: %zu patches, %zu triangles", stats.patches, stats.triangles);
+            if (stats.finest_lod > 0) {
+                ImGui::Text("Terrain over budget, drawn from LOD %u", stats.finest_lod);
+            }
+        }
+        if (!lighting.lights.empty()) {
+            const auto& stats = light_stats;
+            ImGui::Text("Lights: %zu visible, %zu per cluster at most", stats.visible, stats.max_cluster);
+            ImGui::Text("Light binning: %.3f ms", stats.bin_ms);
+            ImGui::Checkbox("Brute-force lights", &lighting.brute_force);
+        }
+        if (auto value = show_debug.load(); ImGui::Checkbox("Debug draw", &value)) {
+            show_debug = value;
+        }
+        if (show_debug) {
+            ImGui::Text("Debug lines: %zu", debug_stats.lines);
+        }
+        if (simulation) {
+            ImGui::Text("Simulation: %.2f ms", simulation->GetStats().simulate_ms);
+            ImGui::Text("Waited for simulation: %.2f ms", simulation->GetStats().wait_ms);
+        }
+        if (auto value = animate.load(); ImGui::Checkbox("Animate", &value)) {
+            animate = value;
+            if constexpr (std::is_same_v<WindowType, Window>) {
+                if (value) {
+                    window.BeginContinuousRendering();
+                } else {
+                    window.EndContinuousRendering();
+                }
+            }
+        }
+        ImGui::End();
+
+        #ifdef PROFILER_ENABLED
+            Profiler::Get().DrawPanel();
+        #endif
+        #ifdef RENDER_STATS_ENABLED
+            RenderStats::Get().DrawOverlay();
+        #endif
     });
 
+    #ifdef PROFILER_ENABLED
+        if (auto path = GetOption(args, "--trace")) {
+            Profiler::Get().ExportChromeTrace(path.value());
+        }
+    #endif
+
+    #ifdef HEADLESS_ENABLED
+        if constexpr (std::is_same_v<WindowType, HeadlessWindow>) {
+            if (auto path = GetOption(args, "--capture")) {
+                WritePpm(path.value(), *window.ReadPixels());
+            }
+        }
+    #endif
+
     return 0;
+}
+
+// usage: opengl-cmake [--record <file> | --replay <file> [--timestep <seconds>]]
+//                     [--frame-log <file>] [--pacing unlimited|vsync|adaptive|<fps>]
+//                     [--dynamic-resolution <scene GPU budget in ms>]
+//                     [--on-demand] [--simulation-thread] [--trace <file.json>]
+//                     [--stats-log <file.csv>] [--terrain <heightmap.png>] [--lights <count>]
+//                     [--headless <frames> [--timestep <seconds>] [--capture <file.ppm>]]
+auto main(int argc, char* argv[]) -> int {
+    const auto args = std::span {argv, static_cast<std::size_t>(argc)};
+    const auto win_width = 1024;
+    const auto win_height = 768;
+    const auto viewport = glm::vec2 {win_width, win_height};
+
+    if (auto frames = GetOption(args, "--headless")) {
+        #ifdef HEADLESS_ENABLED
+            const auto timestep = GetOption(args, "--timestep");
+            const auto seconds = timestep ? std::atof(timestep->c_str()) : 1.0 / 60.0;
+            if (seconds <= 0.0) {
+                std::cerr << "--timestep must be a positive number of seconds\n";
+                return 1;
+            }
+
+            auto window = HeadlessWindow {{
+                .width = win_width,
+                .height = win_height,
+                .frames = static_cast<std::uint32_t>(std::atoi(frames->c_str())),
+                .timestep = seconds
+            }};
+            if (!window.IsValid()) return 1;
+            return Run(window, args, viewport);
+        #else
+            std::cerr << "Built without headless support (EGL not found)\n";
+            return 1;
+        #endif
+    }
+
+    auto window = Window {win_width, win_height, "OpenGL starter project"};
+    return Run(window, args, viewport);
 }
\ No newline at end of file
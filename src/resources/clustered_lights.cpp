@@ -0,0 +1,449 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "clustered_lights.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <iostream>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "core/render_stats.h"
+#include "core/simd.h"
+#include "core/timer.h"
+#include "core/worker_pool.h"
+
+namespace {
+
+constexpr auto kMaxLights = std::size_t {65535}; // indices are 16 bits
+constexpr auto kParallelLights = std::size_t {256}; // fewer are binned faster than the pool wakes
+constexpr auto kFar = 1e30f;                        // bounds of the padding columns
+
+constexpr auto kUnits = 3;
+constexpr int kFormats[kUnits] {GL_RGBA32F, GL_RG32UI, GL_R16UI};
+
+auto Tile(float ndc, unsigned tiles) {
+    const auto tile = std::floor((ndc + 1.0f) * 0.5f * static_cast<float>(tiles));
+    return static_cast<unsigned>(std::clamp(tile, 0.0f, static_cast<float>(tiles - 1)));
+}
+
+// the smallest and largest of p / depth over a depth range, which are at
+// its near end for negative p and at its far end otherwise
+auto Project(float low, float high, float near, float far) {
+    return std::pair {low / (low < 0.0f ? near : far), high / (high < 0.0f ? far : near)};
+}
+
+auto Upload(unsigned int buffer, std::size_t bytes, const void* data) {
+    // respecified each frame so the driver can hand out fresh storage, and
+    // never empty, since a texture buffer needs a texel to fetch from
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, std::max<std::size_t>(bytes, 16), nullptr, GL_STREAM_DRAW);
+    if (bytes) glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    RENDER_STATS_ADD(buffer_bytes, bytes);
+}
+
+} // namespace
+
+ClusteredLights::ClusteredLights(const Parameters& params)
+  : params_(params) {
+    params_.tiles_x = std::max(params_.tiles_x, 1u);
+    params_.tiles_y = std::max(params_.tiles_y, 1u);
+    params_.slices = std::max(params_.slices, 1u);
+    row_stride_ = (params_.tiles_x + 3) / 4 * 4;
+
+    bounds_.min_x.resize(params_.slices * row_stride_);
+    bounds_.max_x.resize(params_.slices * row_stride_);
+    bounds_.min_y.resize(params_.slices * params_.tiles_y);
+    bounds_.max_y.resize(params_.slices * params_.tiles_y);
+    bounds_.min_depth.resize(params_.slices);
+    bounds_.max_depth.resize(params_.slices);
+
+    clusters_.resize(params_.tiles_x * params_.tiles_y * params_.slices * 2);
+    slice_starts_.resize(params_.slices + 1);
+    slice_pairs_.resize(params_.slices);
+    slice_indices_.resize(params_.slices);
+}
+
+auto ClusteredLights::Bin(const PerspectiveCamera& camera) -> void {
+    const auto timer = Timer {};
+
+    if (camera.Projection() != projection_) {
+        // the planes come back out of the projection, as glm::perspective
+        // builds it
+        projection_ = camera.Projection();
+        near_ = projection_[3][2] / (projection_[2][2] - 1.0f);
+        far_ = projection_[3][2] / (projection_[2][2] + 1.0f);
+        BuildBounds();
+    }
+    view_ = camera.View();
+
+    const auto count = std::min(lights.size(), kMaxLights);
+    ranges_.resize(count);
+    PrepareLights(count);
+
+    // slices own their clusters, so each is binned by whichever thread
+    // takes it next
+    if (count < kParallelLights) {
+        for (auto slice = 0u; slice < params_.slices; ++slice) BinSlice(slice);
+    } else {
+        WorkerPool::Get().Run(params_.slices, [this](std::size_t slice) {
+            BinSlice(static_cast<unsigned>(slice));
+        });
+    }
+
+    // slice offsets were relative to their own lists
+    const auto per_slice = params_.tiles_x * params_.tiles_y;
+    indices_.clear();
+    stats_ = {.lights = lights.size()};
+    for (auto slice = 0u; slice < params_.slices; ++slice) {
+        const auto base = static_cast<std::uint32_t>(indices_.size());
+        for (auto cluster = slice * per_slice; cluster < (slice + 1) * per_slice; ++cluster) {
+            clusters_[cluster * 2] += base;
+            stats_.max_cluster = std::max<std::size_t>(stats_.max_cluster, clusters_[cluster * 2 + 1]);
+        }
+        indices_.insert(indices_.end(), slice_indices_[slice].begin(), slice_indices_[slice].end());
+    }
+    for (const auto& range : ranges_) {
+        if (range.slice0 <= range.slice1) ++stats_.visible;
+    }
+    stats_.references = indices_.size();
+    stats_.bin_ms = timer.GetSeconds() * 1000.0;
+}
+
+auto ClusteredLights::BuildBounds() -> void {
+    // slices grow exponentially, so clusters keep their shape with depth
+    const auto tiles_x = static_cast<float>(params_.tiles_x);
+    const auto tiles_y = static_cast<float>(params_.tiles_y);
+    const auto slices = static_cast<float>(params_.slices);
+    const auto tan_x = 1.0f / projection_[0][0];
+    const auto tan_y = 1.0f / projection_[1][1];
+
+    for (auto slice = 0u; slice < params_.slices; ++slice) {
+        const auto d0 = near_ * std::pow(far_ / near_, static_cast<float>(slice) / slices);
+        const auto d1 = near_ * std::pow(far_ / near_, static_cast<float>(slice + 1) / slices);
+        bounds_.min_depth[slice] = d0;
+        bounds_.max_depth[slice] = d1;
+
+        for (auto x = 0u; x < row_stride_; ++x) {
+            auto& min = bounds_.min_x[slice * row_stride_ + x];
+            auto& max = bounds_.max_x[slice * row_stride_ + x];
+            if (x >= params_.tiles_x) {
+                min = kFar;
+                max = -kFar;
+                continue;
+            }
+            const auto ndc0 = -1.0f + 2.0f * static_cast<float>(x) / tiles_x;
+            const auto ndc1 = -1.0f + 2.0f * static_cast<float>(x + 1) / tiles_x;
+            min = std::min(ndc0 * d0, ndc0 * d1) * tan_x;
+            max = std::max(ndc1 * d0, ndc1 * d1) * tan_x;
+        }
+        for (auto y = 0u; y < params_.tiles_y; ++y) {
+            const auto ndc0 = -1.0f + 2.0f * static_cast<float>(y) / tiles_y;
+            const auto ndc1 = -1.0f + 2.0f * static_cast<float>(y + 1) / tiles_y;
+            bounds_.min_y[slice * params_.tiles_y + y] = std::min(ndc0 * d0, ndc0 * d1) * tan_y;
+            bounds_.max_y[slice * params_.tiles_y + y] = std::max(ndc1 * d0, ndc1 * d1) * tan_y;
+        }
+    }
+}
+
+auto ClusteredLights::PrepareLights(std::size_t count) -> void {
+    const auto& m = view_;
+    const auto slice_scale = static_cast<float>(params_.slices) / std::log(far_ / near_);
+    const auto slice = [&](float depth) {
+        const auto s = std::floor(std::log(depth / near_) * slice_scale);
+        return static_cast<unsigned>(std::clamp(s, 0.0f, static_cast<float>(params_.slices - 1)));
+    };
+
+    // four lights at a time, one lane each, into view space and onto the
+    // screen by the bounds of their spheres
+    for (auto i = std::size_t {0}; i < count; i += 4) {
+        const auto& a = lights[i];
+        const auto& b = lights[std::min(i + 1, count - 1)];
+        const auto& c = lights[std::min(i + 2, count - 1)];
+        const auto& d = lights[std::min(i + 3, count - 1)];
+        const auto x = Float4::Set(a.position.x, b.position.x, c.position.x, d.position.x);
+        const auto y = Float4::Set(a.position.y, b.position.y, c.position.y, d.position.y);
+        const auto z = Float4::Set(a.position.z, b.position.z, c.position.z, d.position.z);
+        const auto radius = Float4::Set(a.range, b.range, c.range, d.range);
+        const auto row = [&](int r) {
+            return Float4::Broadcast(m[0][r]) * x + Float4::Broadcast(m[1][r]) * y +
+                   Float4::Broadcast(m[2][r]) * z + Float4::Broadcast(m[3][r]);
+        };
+        const auto vx = row(0);
+        const auto vy = row(1);
+        const auto depth = -row(2);
+        const auto depth_min = depth - radius;
+        const auto depth_max = depth + radius;
+
+        // as Project, a lane at a time
+        const auto zero = Float4::Broadcast(0.0f);
+        const auto project = [&](Float4 low, Float4 high, float scale) {
+            const auto min = Select(LessThan(low, zero), low / depth_min, low / depth_max);
+            const auto max = Select(LessThan(high, zero), high / depth_max, high / depth_min);
+            return std::pair {min * Float4::Broadcast(scale), max * Float4::Broadcast(scale)};
+        };
+        const auto [ndc_min_x, ndc_max_x] = project(vx - radius, vx + radius, projection_[0][0]);
+        const auto [ndc_min_y, ndc_max_y] = project(vy - radius, vy + radius, projection_[1][1]);
+
+        float lanes[8][4];
+        vx.Store(lanes[0]);
+        vy.Store(lanes[1]);
+        depth.Store(lanes[2]);
+        depth_min.Store(lanes[3]);
+        ndc_min_x.Store(lanes[4]);
+        ndc_max_x.Store(lanes[5]);
+        ndc_min_y.Store(lanes[6]);
+        ndc_max_y.Store(lanes[7]);
+
+        for (auto lane = std::size_t {0}; lane < 4 && i + lane < count; ++lane) {
+            auto& range = ranges_[i + lane];
+            const auto r = lights[i + lane].range;
+            const auto near = lanes[3][lane];
+            const auto far = lanes[2][lane] + r;
+            range = {
+                .center = {lanes[0][lane], lanes[1][lane], -lanes[2][lane]},
+                .radius = r,
+                .x0 = 0,
+                .x1 = params_.tiles_x - 1,
+                .y0 = 0,
+                .y1 = params_.tiles_y - 1,
+                .slice0 = 1,
+                .slice1 = 0
+            };
+            if (far < near_ || near > far_) continue;
+
+            // spheres across the near plane project past the screen edges,
+            // so they keep every tile
+            if (near > near_) {
+                const auto [min_x, max_x] = std::pair {lanes[4][lane], lanes[5][lane]};
+                const auto [min_y, max_y] = std::pair {lanes[6][lane], lanes[7][lane]};
+                if (max_x < -1.0f || min_x > 1.0f || max_y < -1.0f || min_y > 1.0f) continue;
+                range.x0 = Tile(min_x, params_.tiles_x);
+                range.x1 = Tile(max_x, params_.tiles_x);
+                range.y0 = Tile(min_y, params_.tiles_y);
+                range.y1 = Tile(max_y, params_.tiles_y);
+            }
+            range.slice0 = slice(std::max(near, near_));
+            range.slice1 = slice(std::min(far, far_));
+        }
+    }
+
+    // each slice gets the lights that reach it, so it skips the rest
+    // without looking at them
+    std::ranges::fill(slice_starts_, 0);
+    for (const auto& range : ranges_) {
+        for (auto s = range.slice0; s <= range.slice1; ++s) ++slice_starts_[s + 1];
+    }
+    for (auto s = 0u; s < params_.slices; ++s) slice_starts_[s + 1] += slice_starts_[s];
+    slice_lights_.resize(slice_starts_.back());
+    for (auto light = std::size_t {0}; light < ranges_.size(); ++light) {
+        const auto& range = ranges_[light];
+        for (auto s = range.slice0; s <= range.slice1; ++s) {
+            slice_lights_[slice_starts_[s]++] = static_cast<std::uint16_t>(light);
+        }
+    }
+    // the starts were moved to the ends while filling
+    for (auto s = params_.slices; s > 0; --s) slice_starts_[s] = slice_starts_[s - 1];
+    slice_starts_[0] = 0;
+}
+
+auto ClusteredLights::BinSlice(unsigned slice) -> void {
+    const auto tiles_x = params_.tiles_x;
+    const auto per_slice = tiles_x * params_.tiles_y;
+    const auto first = slice * per_slice;
+    auto& pairs = slice_pairs_[slice];
+    pairs.clear();
+
+    const auto* column_min = bounds_.min_x.data() + slice * row_stride_;
+    const auto* column_max = bounds_.max_x.data() + slice * row_stride_;
+    const auto* row_min = bounds_.min_y.data() + slice * params_.tiles_y;
+    const auto* row_max = bounds_.max_y.data() + slice * params_.tiles_y;
+    auto distance_x = std::vector<float>(row_stride_);
+
+    // the squared distance from a sphere to a cluster is the sum of the
+    // distances along each axis, which are shared by a column or a row
+    for (auto i = slice_starts_[slice]; i < slice_starts_[slice + 1]; ++i) {
+        const auto light = slice_lights_[i];
+        const auto& range = ranges_[light];
+
+        const auto radius = range.radius * range.radius;
+        const auto depth = -range.center.z;
+        const auto dz = depth - std::clamp(depth, bounds_.min_depth[slice], bounds_.max_depth[slice]);
+        if (dz * dz > radius) continue;
+
+        // the part of the sphere within this slice covers fewer tiles than
+        // all of it
+        const auto near = std::max(depth - range.radius, bounds_.min_depth[slice]);
+        const auto far = std::min(depth + range.radius, bounds_.max_depth[slice]);
+        const auto [min_x, max_x] = Project(range.center.x - range.radius, range.center.x + range.radius, near, far);
+        const auto [min_y, max_y] = Project(range.center.y - range.radius, range.center.y + range.radius, near, far);
+        const auto x0 = std::max(range.x0, Tile(min_x * projection_[0][0], tiles_x));
+        const auto x1 = std::min(range.x1, Tile(max_x * projection_[0][0], tiles_x));
+        const auto y0 = std::max(range.y0, Tile(min_y * projection_[1][1], params_.tiles_y));
+        const auto y1 = std::min(range.y1, Tile(max_y * projection_[1][1], params_.tiles_y));
+
+        const auto begin = x0 & ~3u;
+        const auto center_x = Float4::Broadcast(range.center.x);
+        for (auto x = begin; x <= x1; x += 4) {
+            const auto closest = Max(Float4::Load(column_min + x), Min(center_x, Float4::Load(column_max + x)));
+            const auto dx = center_x - closest;
+            (dx * dx).Store(distance_x.data() + x);
+        }
+
+        // columns of the first and last group outside the range are masked
+        const auto reach = Float4::Broadcast(radius);
+        const auto columns = [&](unsigned x) {
+            const auto low = x < x0 ? x0 - x : 0u;
+            const auto high = x + 3 > x1 ? x + 3 - x1 : 0u;
+            return (0xf << low) & (0xf >> high) & 0xf;
+        };
+        for (auto y = y0; y <= y1; ++y) {
+            const auto dy = range.center.y - std::clamp(range.center.y, row_min[y], row_max[y]);
+            const auto dyz = dy * dy + dz * dz;
+            if (dyz > radius) continue;
+
+            for (auto x = begin; x <= x1; x += 4) {
+                const auto inside = LessThan(Float4::Load(distance_x.data() + x) + Float4::Broadcast(dyz), reach);
+                for (auto mask = Mask(inside) & columns(x); mask; mask &= mask - 1) {
+                    const auto column = x + static_cast<unsigned>(std::countr_zero(static_cast<unsigned>(mask)));
+                    pairs.emplace_back(static_cast<std::uint64_t>(y * tiles_x + column) << 16 | light);
+                }
+            }
+        }
+    }
+
+    // counting sort by cluster; lights stay in order within each, and the
+    // offsets serve as cursors while filling
+    for (auto cluster = first; cluster < first + per_slice; ++cluster) clusters_[cluster * 2 + 1] = 0;
+    for (const auto pair : pairs) ++clusters_[(first + (pair >> 16)) * 2 + 1];
+    auto offset = std::uint32_t {0};
+    for (auto cluster = first; cluster < first + per_slice; ++cluster) {
+        clusters_[cluster * 2] = offset;
+        offset += clusters_[cluster * 2 + 1];
+    }
+    auto& indices = slice_indices_[slice];
+    indices.resize(pairs.size());
+    for (const auto pair : pairs) {
+        indices[clusters_[(first + (pair >> 16)) * 2]++] = static_cast<std::uint16_t>(pair & 0xffff);
+    }
+    for (auto cluster = first; cluster < first + per_slice; ++cluster) {
+        clusters_[cluster * 2] -= clusters_[cluster * 2 + 1];
+    }
+}
+
+auto ClusteredLights::Cluster(unsigned x, unsigned y, unsigned slice) const -> std::span<const std::uint16_t> {
+    const auto cluster = (slice * params_.tiles_y + y) * params_.tiles_x + x;
+    return {indices_.data() + clusters_[cluster * 2], clusters_[cluster * 2 + 1]};
+}
+
+auto ClusteredLights::CreateBuffers() -> void {
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels_);
+    glGenBuffers(kUnits, buffers_);
+    glGenTextures(kUnits, textures_);
+    for (auto i = 0; i < kUnits; ++i) {
+        Upload(buffers_[i], 0, nullptr);
+        glBindTexture(GL_TEXTURE_BUFFER, textures_[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, kFormats[i], buffers_[i]);
+    }
+}
+
+auto ClusteredLights::Submit(CommandList& commands, const PerspectiveCamera& camera, const Shaders& shader) -> void {
+    Bin(camera);
+
+    auto& frame = frames_[current_];
+    current_ ^= 1;
+    frame.clusters.assign(clusters_.begin(), clusters_.end());
+    frame.indices.assign(indices_.begin(), indices_.end());
+    frame.near = near_;
+    frame.slice_scale = static_cast<float>(params_.slices) / std::log(far_ / near_);
+
+    // lights go up in view space, so the shader needs no view matrix
+    const auto count = ranges_.size();
+    frame.texels.resize(count * 12);
+    const auto rotation = glm::mat3 {view_};
+    for (auto i = std::size_t {0}; i < count; ++i) {
+        const auto& light = lights[i];
+        const auto direction = glm::normalize(rotation * light.direction);
+
+        // point lights get a cone that lets everything through
+        auto scale = 0.0f;
+        auto offset = 1.0f;
+        if (light.outer_angle > 0.0f) {
+            const auto outer = std::cos(light.outer_angle);
+            const auto inner = std::cos(std::min(light.inner_angle, light.outer_angle));
+            scale = 1.0f / std::max(inner - outer, 1e-4f);
+            offset = -outer * scale;
+        }
+
+        const auto color = light.color * light.intensity;
+        const auto& center = ranges_[i].center;
+        const float texels[12] {
+            center.x, center.y, center.z, light.range,
+            color.x, color.y, color.z, scale,
+            direction.x, direction.y, direction.z, offset
+        };
+        std::ranges::copy(texels, frame.texels.begin() + static_cast<std::ptrdiff_t>(i * 12));
+    }
+
+    commands.AddCallback([this, &frame, &shader] { UploadFrame(frame, shader); });
+}
+
+auto ClusteredLights::UploadFrame(const Frame& frame, const Shaders& shader) -> void {
+    if (!buffers_[0]) CreateBuffers();
+
+    const auto count = frame.texels.size() / 12;
+    auto light_count = static_cast<int>(count);
+    if (count * 3 > static_cast<std::size_t>(max_texels_) || frame.indices.size() > static_cast<std::size_t>(max_texels_)) {
+        std::cerr << "Too many lights for a texture buffer, drawing unlit." << std::endl;
+        light_count = 0;
+    } else {
+        Upload(buffers_[0], frame.texels.size() * sizeof(float), frame.texels.data());
+        Upload(buffers_[1], frame.clusters.size() * sizeof(std::uint32_t), frame.clusters.data());
+        Upload(buffers_[2], frame.indices.size() * sizeof(std::uint16_t), frame.indices.data());
+    }
+
+    for (auto i = 0; i < kUnits; ++i) {
+        glActiveTexture(GL_TEXTURE1 + i);
+        glBindTexture(GL_TEXTURE_BUFFER, textures_[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    RENDER_STATS_ADD(texture_binds, kUnits);
+
+    // the clusters span what is drawn, which with dynamic resolution is
+    // less than the window
+    auto viewport = std::array<GLint, 4> {};
+    glGetIntegerv(GL_VIEWPORT, viewport.data());
+
+    SetSamplers(shader);
+    shader.SetUniform("u_LightCount", light_count);
+    shader.SetUniform("u_BruteForce", brute_force ? 1 : 0);
+    shader.SetUniform("u_Ambient", params_.ambient);
+    shader.SetUniform("u_ClusterGrid", glm::vec3 {
+        static_cast<float>(params_.tiles_x),
+        static_cast<float>(params_.tiles_y),
+        static_cast<float>(params_.slices)
+    });
+    shader.SetUniform("u_ClusterScale", glm::vec3 {
+        static_cast<float>(params_.tiles_x) / static_cast<float>(viewport[2]),
+        static_cast<float>(params_.tiles_y) / static_cast<float>(viewport[3]),
+        frame.slice_scale
+    });
+    shader.SetUniform("u_ClusterBias", -std::log(frame.near) * frame.slice_scale);
+}
+
+auto ClusteredLights::SetSamplers(const Shaders& shader) -> void {
+    shader.SetUniform("u_Lights", 1);
+    shader.SetUniform("u_Clusters", 2);
+    shader.SetUniform("u_LightIndices", 3);
+}
+
+ClusteredLights::~ClusteredLights() {
+    if (buffers_[0]) {
+        glDeleteTextures(kUnits, textures_);
+        glDeleteBuffers(kUnits, buffers_);
+    }
+}
\ No newline at end of file
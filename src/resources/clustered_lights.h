@@ -0,0 +1,161 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "core/command_list.h"
+#include "core/perspective_camera.h"
+#include "core/shaders.h"
+
+struct Light {
+    glm::vec3 position {0.0f};
+    float range {10.0f};                 // no light reaches past this
+    glm::vec3 color {1.0f};
+    float intensity {1.0f};
+    glm::vec3 direction {0.0f, -1.0f, 0.0f}; // spot lights only
+    float outer_angle {0.0f};            // cone half-angle in radians, 0 for a point light
+    float inner_angle {0.0f};            // full intensity inside this
+};
+
+// Clustered forward lighting. The view frustum is split into a grid of
+// clusters, tiles on screen by slices in depth, which grow exponentially so
+// clusters stay roughly cubic. Every frame the lights are binned into the
+// clusters they reach on the CPU, and scene.frag only loops over the lights
+// of its fragment's cluster:
+//
+//   lighting.lights = ...;
+//   lighting.Submit(commands, camera, shader);
+//   commands.AddDraw(geometry, shader);
+//
+// Binning runs on the recording thread, such as the simulation, with the
+// slices spread over the shared worker pool; the command list only uploads
+// the result. Frames are double buffered as the command lists are, so the
+// next frame is binned while the last one is drawn.
+//
+// Lights are binned by the sphere of their range, for spot lights as well,
+// and at most 65535 of them are used. The lights, cluster ranges and light
+// indices are texture buffers on units 1 to 3.
+class ClusteredLights {
+public:
+    struct Parameters {
+        unsigned tiles_x {16};
+        unsigned tiles_y {9};
+        unsigned slices {24};
+        glm::vec3 ambient {0.05f};
+    };
+
+    struct Stats {
+        std::size_t lights {0};
+        std::size_t visible {0};    // inside the view frustum's depth range and tiles
+        std::size_t references {0}; // light indices over all clusters
+        std::size_t max_cluster {0};
+        double bin_ms {0.0};
+    };
+
+    std::vector<Light> lights {};
+
+    // every fragment loops over all lights instead, for comparison
+    bool brute_force {false};
+
+    // GL objects are created by the first Bind, so binning alone needs no
+    // context
+    explicit ClusteredLights(const Parameters& params);
+
+    // deleted copy constructors and assignment operators
+    ClusteredLights(const ClusteredLights&) = delete;
+    ClusteredLights& operator=(const ClusteredLights&) = delete;
+
+    // bins the lights for this camera without touching GL
+    auto Bin(const PerspectiveCamera& camera) -> void;
+
+    // bins, then records the upload and the lighting uniforms of a scene
+    // shader, which must outlive the list; with no lights the shader leaves
+    // its texture unlit
+    auto Submit(CommandList& commands, const PerspectiveCamera& camera, const Shaders& shader) -> void;
+
+    // points the light buffers of a scene shader at their units, which it
+    // needs even when drawn without lights, since its texture is on unit 0
+    static auto SetSamplers(const Shaders& shader) -> void;
+
+    // light indices of one cluster, slice by slice, row by row from the bottom
+    [[nodiscard]] auto Cluster(unsigned x, unsigned y, unsigned slice) const -> std::span<const std::uint16_t>;
+
+    // of the last Bin, for the thread that bins
+    [[nodiscard]] auto GetStats() const -> const Stats& { return stats_; }
+
+    ~ClusteredLights();
+
+private:
+    // clusters are boxes in view space whose x extent depends only on the
+    // column and slice, and y only on the row and slice; columns are
+    // padded to a multiple of four for Float4, with bounds nothing reaches
+    struct ClusterBounds {
+        std::vector<float> min_x; // slice * row_stride + x
+        std::vector<float> max_x;
+        std::vector<float> min_y; // slice * tiles_y + y
+        std::vector<float> max_y;
+        std::vector<float> min_depth; // per slice
+        std::vector<float> max_depth;
+    };
+
+    // what one frame uploads, copied from the binning so the next frame can
+    // be binned while this one is drawn
+    struct Frame {
+        std::vector<float> texels {}; // three RGBA texels per light
+        std::vector<std::uint32_t> clusters {};
+        std::vector<std::uint16_t> indices {};
+        float near {0.0f};
+        float slice_scale {0.0f};
+    };
+
+    // a light's view-space sphere and the clusters it may reach; slice0 is
+    // past slice1 when it reaches none
+    struct LightRange {
+        glm::vec3 center;
+        float radius;
+        unsigned x0, x1;
+        unsigned y0, y1;
+        unsigned slice0, slice1;
+    };
+
+    Parameters params_;
+    unsigned row_stride_;
+
+    float near_ {0.0f};
+    float far_ {0.0f};
+    glm::mat4 projection_ {0.0f};
+    glm::mat4 view_ {1.0f};
+    ClusterBounds bounds_ {};
+
+    std::vector<LightRange> ranges_ {};
+    std::vector<std::uint32_t> slice_starts_ {}; // into slice_lights_, one past the last slice too
+    std::vector<std::uint16_t> slice_lights_ {};
+    std::vector<std::uint32_t> clusters_ {}; // offset and count per cluster
+    std::vector<std::uint16_t> indices_ {};
+    std::vector<std::vector<std::uint64_t>> slice_pairs_ {}; // cluster << 16 | light
+    std::vector<std::vector<std::uint16_t>> slice_indices_ {};
+
+    Stats stats_ {};
+
+    std::array<Frame, 2> frames_ {};
+    std::size_t current_ {0};
+
+    std::int32_t max_texels_ {0};
+    unsigned int buffers_[3] {0, 0, 0}; // lights, clusters, indices
+    unsigned int textures_[3] {0, 0, 0};
+
+    auto BuildBounds() -> void;
+    auto PrepareLights(std::size_t count) -> void;
+    auto BinSlice(unsigned slice) -> void;
+    auto CreateBuffers() -> void;
+    auto UploadFrame(const Frame& frame, const Shaders& shader) -> void;
+};
\ No newline at end of file
@@ -12,30 +12,30 @@
 constexpr auto kVerticalLimit = glm::half_pi<float>() - 0.1f;
 
 OrbitControls::OrbitControls(PerspectiveCamera* camera) : camera_(camera) {
-    event_listener_ = std::make_shared<EventListener>([this](Event* event) {
-        if (const auto e = dynamic_cast<MouseEvent*>(event)) {
-            OnMouseEvent(e);
+    event_listener_ = EventDispatcher::Get().AddEventListener<MouseEvent>(
+        [this](const MouseEvent& event) {
+            OnMouseEvent(event);
         }
-    });
-    EventDispatcher::Get().AddEventListener("mouse_event", event_listener_);
+    );
 }
 
-auto OrbitControls::OnMouseEvent(MouseEvent* event) -> void {
+auto OrbitControls::OnMouseEvent(const MouseEvent& event) -> void {
     using enum MouseButton;
     using enum MouseEvent::Type;
 
-    curr_mouse_pos_ = event->position;
+    curr_mouse_pos_ = event.position;
 
-    if (event->type == ButtonPressed && curr_mouse_button_ == None) {
-        curr_mouse_button_ = event->button;
+    if (event.type == ButtonPressed && curr_mouse_button_ == None) {
+        curr_mouse_button_ = event.button;
+        press_position_ = event.position;
     }
 
-    if (event->type == ButtonReleased && event->button == curr_mouse_button_) {
+    if (event.type == ButtonReleased && event.button == curr_mouse_button_) {
         curr_mouse_button_ = None;
     }
 
-    if (event->type == Scrolled) {
-        curr_scroll_offset_ = event->scroll.y;
+    if (event.type == Scrolled) {
+        curr_scroll_offset_ = event.scroll.y;
     }
 }
 
@@ -48,6 +48,11 @@ auto OrbitControls::OnUpdate(float delta) -> void {
 
     const auto mouse_offset = curr_mouse_pos_ - prev_mouse_pos_;
 
+    if (curr_mouse_button_ == MouseButton::Left && prev_mouse_button_ != MouseButton::Left) {
+        pivot_ = pick_ ? pick_(press_position_) : std::nullopt;
+    }
+    prev_mouse_button_ = curr_mouse_button_;
+
     if (curr_mouse_button_ == MouseButton::Left) {
         Orbit(mouse_offset, delta);
     }
@@ -77,9 +82,20 @@ auto OrbitControls::OnUpdate(float delta) -> void {
 }
 
 auto OrbitControls::Orbit(const glm::vec2& offset, float delta) -> void {
-    yaw -= offset.x * orbit_speed * delta;
-    pitch += offset.y * orbit_speed * delta;
-    pitch = std::clamp(pitch, -kVerticalLimit, kVerticalLimit);
+    const auto yaw_delta = -offset.x * orbit_speed * delta;
+    const auto next_pitch = std::clamp(pitch + offset.y * orbit_speed * delta, -kVerticalLimit, kVerticalLimit);
+
+    // the camera and target turn together around the pivot: pitch about the
+    // camera's horizontal axis, then yaw about the vertical one
+    if (pivot_) {
+        const auto axis = glm::vec3 {-std::cos(yaw), 0.0f, std::sin(yaw)};
+        auto rotation = glm::rotate(glm::mat4 {1.0f}, yaw_delta, {0.0f, 1.0f, 0.0f});
+        rotation = glm::rotate(rotation, next_pitch - pitch, axis);
+        target = pivot_.value() + glm::vec3 {rotation * glm::vec4 {target - pivot_.value(), 0.0f}};
+    }
+
+    yaw += yaw_delta;
+    pitch = next_pitch;
 }
 
 auto OrbitControls::Pan(const glm::vec2& offset, float delta) -> void {
@@ -96,4 +112,8 @@ auto OrbitControls::Pan(const glm::vec2& offset, float delta) -> void {
 auto OrbitControls::Zoom(const float scroll_offset, float delta) -> void {
     radius -= scroll_offset * zoom_speed * delta;
     radius = std::max(0.1f, radius);
+}
+
+OrbitControls::~OrbitControls() {
+    EventDispatcher::Get().RemoveEventListener(event_listener_);
 }
\ No newline at end of file
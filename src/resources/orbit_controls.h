@@ -7,11 +7,12 @@
 #include "core/event_dispatcher.h"
 #include "core/perspective_camera.h"
 
+#include <functional>
+#include <optional>
+
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
-#include <memory>
-
 class OrbitControls {
 public:
     float radius {1.0f};
@@ -24,8 +25,22 @@ public:
 
     explicit OrbitControls(PerspectiveCamera* camera);
 
+    // deleted copy constructors and assignment operators
+    OrbitControls(const OrbitControls&) = delete;
+    OrbitControls& operator=(const OrbitControls&) = delete;
+
     auto OnUpdate(float delta) -> void;
 
+    // returns the point under a cursor position, if any; a left drag
+    // starting there orbits around it instead of the target
+    using PickFunction = std::function<std::optional<glm::vec3>(const glm::vec2& cursor)>;
+
+    auto SetPickCallback(PickFunction pick) { pick_ = std::move(pick); }
+
+    [[nodiscard]] auto Target() const -> const glm::vec3& { return target; }
+
+    ~OrbitControls();
+
 private:
     glm::vec3 target {0.0f};
     glm::vec2 curr_mouse_pos_ {0.0f};
@@ -34,14 +49,19 @@ private:
     float curr_scroll_offset_ {0.0f};
 
     MouseButton curr_mouse_button_ {MouseButton::None};
+    MouseButton prev_mouse_button_ {MouseButton::None};
+
+    glm::vec2 press_position_ {0.0f};
+    std::optional<glm::vec3> pivot_ {};
+    PickFunction pick_ {};
 
     PerspectiveCamera* camera_;
 
-    std::shared_ptr<EventListener> event_listener_;
+    ListenerHandle event_listener_ {};
 
     bool first_update_ {false};
 
-    auto OnMouseEvent(MouseEvent* event) -> void;
+    auto OnMouseEvent(const MouseEvent& event) -> void;
 
     auto Orbit(const glm::vec2& offset, float delta) -> void;
 
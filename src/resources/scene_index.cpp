@@ -0,0 +1,76 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "scene_index.h"
+
+#include <glm/glm.hpp>
+
+namespace {
+
+// refitted trees grow looser as objects move apart; past this much more
+// node area than when built, rays pay for a rebuild
+constexpr auto kMaxRefitGrowth = 1.5f;
+
+auto WorldBounds(const Bvh::Bounds& local, const glm::mat4& model) {
+    // a mesh without triangles stays empty wherever it is placed
+    auto bounds = Bvh::Bounds {};
+    if (local.Empty()) return bounds;
+    for (auto corner = 0; corner < 8; ++corner) {
+        const auto p = glm::vec3 {model * glm::vec4 {
+            corner & 1 ? local.max.x : local.min.x,
+            corner & 2 ? local.max.y : local.min.y,
+            corner & 4 ? local.max.z : local.min.z,
+            1.0f
+        }};
+        bounds.Grow({p, p});
+    }
+    return bounds;
+}
+
+auto NodeArea(const Bvh& bvh) {
+    auto area = 0.0f;
+    for (const auto& node : bvh.Nodes()) area += node.bounds.Area();
+    return area;
+}
+
+} // namespace
+
+auto SceneIndex::Add(std::shared_ptr<const MeshBvh> mesh, const glm::mat4& model) -> unsigned {
+    bounds_.emplace_back(WorldBounds(mesh->Bounds(), model));
+    objects_.emplace_back(std::move(mesh), glm::inverse(model));
+    rebuild_ = true;
+    return static_cast<unsigned>(objects_.size() - 1);
+}
+
+auto SceneIndex::SetTransform(unsigned object, const glm::mat4& model) -> void {
+    objects_[object].inverse_model = glm::inverse(model);
+    bounds_[object] = WorldBounds(objects_[object].mesh->Bounds(), model);
+    refit_ = true;
+}
+
+auto SceneIndex::Update() -> void {
+    if (refit_ && !rebuild_) {
+        bvh_.Refit(bounds_);
+        rebuild_ = NodeArea(bvh_) > built_area_ * kMaxRefitGrowth;
+    }
+    if (rebuild_) {
+        bvh_ = Bvh {bounds_, {}};
+        built_area_ = NodeArea(bvh_);
+    }
+    rebuild_ = false;
+    refit_ = false;
+}
+
+auto SceneIndex::Raycast(const Ray& ray) const -> std::optional<RayHit> {
+    return bvh_.Raycast(ray, std::numeric_limits<float>::infinity(), [&](unsigned index, float nearest) {
+        // in model space the direction is scaled with the object, which
+        // leaves distances along the ray unchanged
+        const auto& object = objects_[index];
+        const auto local = Ray {
+            glm::vec3 {object.inverse_model * glm::vec4 {ray.origin, 1.0f}},
+            glm::vec3 {object.inverse_model * glm::vec4 {ray.direction, 0.0f}}
+        };
+        const auto hit = object.mesh->Raycast(local, nearest);
+        return hit ? std::optional {hit->distance} : std::nullopt;
+    });
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include "core/bvh.h"
+#include "core/frustum.h"
+#include "core/ray.h"
+#include "geometries/mesh_bvh.h"
+
+// Objects of a scene in a Bvh over their world bounds, each with the
+// triangle Bvh of its mesh, so rays reach only the triangles near them.
+// Meshes may be shared between objects:
+//
+//   auto box = index.Add(box_bvh, model);
+//   index.SetTransform(box, model); // every frame it moves
+//   index.Update();
+//   auto hit = index.Raycast(camera.CursorRay(cursor, viewport));
+class SceneIndex {
+public:
+    // returns the object, which is hit->index for its hits
+    auto Add(std::shared_ptr<const MeshBvh> mesh, const glm::mat4& model) -> unsigned;
+
+    auto SetTransform(unsigned object, const glm::mat4& model) -> void;
+
+    // rebuilds the tree after objects were added and refits it after they
+    // moved; a tree refitted many times over is rebuilt as well
+    auto Update() -> void;
+
+    [[nodiscard]] auto Raycast(const Ray& ray) const -> std::optional<RayHit>;
+
+    // visit(object) for every object that may be inside the frustum
+    template <typename Visit>
+    auto Query(const Frustum& frustum, Visit&& visit) const {
+        bvh_.Query(frustum, visit);
+    }
+
+    [[nodiscard]] auto Size() const { return objects_.size(); }
+
+private:
+    struct Object {
+        std::shared_ptr<const MeshBvh> mesh;
+        glm::mat4 inverse_model;
+    };
+
+    std::vector<Object> objects_ {};
+    std::vector<Bvh::Bounds> bounds_ {};
+
+    Bvh bvh_ {};
+
+    bool rebuild_ {false};
+    bool refit_ {false};
+    float built_area_ {0.0f};
+};
\ No newline at end of file
@@ -0,0 +1,370 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "terrain.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "core/render_stats.h"
+#include "shaders/headers/terrain_frag.h"
+#include "shaders/headers/terrain_vert.h"
+
+namespace {
+
+auto IntersectsSphere(const glm::vec3& center, float radius, const glm::vec3& min, const glm::vec3& max) {
+    const auto closest = glm::clamp(center, min, max);
+    const auto offset = closest - center;
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+} // namespace
+
+Terrain::Terrain(const Parameters& params, std::shared_ptr<Image> heightmap)
+  : params_(params),
+    heightmap_(heightmap) {
+    // odd vertices morph onto every other one, so a patch needs an even
+    // number of quads at each LOD
+    params_.resolution = std::bit_ceil(std::clamp(params_.resolution, 2u, 1024u));
+
+    // a leaf at least as large as the terrain, or an invalid one, leaves a
+    // single LOD; the cap keeps the shift below in range
+    auto levels = std::ceil(std::log2(params_.size / params_.leaf_size));
+    if (!(levels > 0.0f)) levels = 0.0f;
+    lods_ = static_cast<unsigned>(std::min(levels, 16.0f)) + 1;
+    leaf_size_ = params_.size / static_cast<float>(1u << (lods_ - 1));
+
+    // a node is drawn at its LOD while its children are out of their range;
+    // the ranges have to leave room for it to morph before its neighbours
+    // switch, which holds while the finest range is about three leaves
+    auto range = std::max(params_.lod_distance, leaf_size_ * 3.0f);
+    auto previous = 0.0f;
+    for (auto lod = 0u; lod < lods_; ++lod) {
+        if (lod + 1 == lods_) {
+            // the root covers everything and never morphs
+            ranges_.emplace_back(std::numeric_limits<float>::max());
+            morph_.emplace_back(1e30f, 2e30f);
+            break;
+        }
+        ranges_.emplace_back(range);
+        morph_.emplace_back(range - (range - previous) * params_.morph_ratio, range);
+        previous = range;
+        range *= 2.0f;
+    }
+
+    BuildHeights(*heightmap);
+
+    shader_ = std::make_unique<Shaders>(std::vector<ShaderInfo> {
+        {ShaderType::kVertexShader, _SHADER_terrain_vert},
+        {ShaderType::kFragmentShader, _SHADER_terrain_frag}
+    });
+
+    const auto patch = GeneratePatch(params_.resolution);
+    quadrant_indices_ = patch.index_data.size() / 4;
+
+    glGenVertexArrays(1, &vao_);
+    glBindVertexArray(vao_);
+
+    glGenBuffers(1, &vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        patch.vertex_data.size() * sizeof(float),
+        patch.vertex_data.data(),
+        GL_STATIC_DRAW
+    );
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, kVertexFloats * sizeof(float), nullptr);
+
+    glGenBuffers(1, &ebo_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    glBufferData(
+        GL_ELEMENT_ARRAY_BUFFER,
+        patch.index_data.size() * sizeof(unsigned int),
+        patch.index_data.data(),
+        GL_STATIC_DRAW
+    );
+    RENDER_STATS_ADD(buffer_bytes, patch.vertex_data.size() * sizeof(float));
+    RENDER_STATS_ADD(buffer_bytes, patch.index_data.size() * sizeof(unsigned int));
+
+    // per-patch attributes; the pointers are set per group when drawing
+    glGenBuffers(1, &instance_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+    glEnableVertexAttribArray(3);
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(3, 1);
+    glVertexAttribDivisor(4, 1);
+
+    glBindVertexArray(0);
+}
+
+auto Terrain::GeneratePatch(unsigned resolution) -> GeometryData {
+    const auto n = resolution;
+    const auto half = n / 2;
+    const auto row = n + 1;
+    const auto skirts = row * row;
+
+    auto data = GeometryData {};
+    const auto add_vertex = [&](unsigned x, unsigned z, float skirt) {
+        const auto u = static_cast<float>(x) / static_cast<float>(n);
+        const auto v = static_cast<float>(z) / static_cast<float>(n);
+        data.vertex_data.insert(data.vertex_data.end(), {u, skirt, v, 0.0f, 1.0f, 0.0f, u, v});
+    };
+
+    for (auto z = 0u; z <= n; ++z) {
+        for (auto x = 0u; x <= n; ++x) add_vertex(x, z, 0.0f);
+    }
+    // one skirt vertex under each edge vertex: z = 0, z = n, x = 0, x = n
+    for (auto i = 0u; i <= n; ++i) add_vertex(i, 0, 1.0f);
+    for (auto i = 0u; i <= n; ++i) add_vertex(i, n, 1.0f);
+    for (auto i = 0u; i <= n; ++i) add_vertex(0, i, 1.0f);
+    for (auto i = 0u; i <= n; ++i) add_vertex(n, i, 1.0f);
+
+    const auto grid = [row](unsigned x, unsigned z) { return z * row + x; };
+    const auto skirt = [row, skirts](unsigned edge, unsigned i) { return skirts + edge * row + i; };
+
+    auto& indices = data.index_data;
+    const auto add_skirt = [&](unsigned a, unsigned b, unsigned skirt_a, unsigned skirt_b) {
+        indices.insert(indices.end(), {a, skirt_a, b, b, skirt_a, skirt_b});
+    };
+
+    for (auto quadrant = 0u; quadrant < 4; ++quadrant) {
+        const auto qx = quadrant & 1;
+        const auto qz = quadrant >> 1;
+        const auto x0 = qx * half;
+        const auto z0 = qz * half;
+
+        for (auto z = z0; z < z0 + half; ++z) {
+            for (auto x = x0; x < x0 + half; ++x) {
+                const auto a = grid(x, z);
+                const auto b = grid(x, z + 1);
+                const auto c = grid(x + 1, z + 1);
+                const auto d = grid(x + 1, z);
+                indices.insert(indices.end(), {a, b, d, b, c, d});
+            }
+        }
+
+        // each quadrant owns the two patch edges it touches
+        const auto edge_z = qz == 0 ? 0u : n;
+        for (auto x = x0; x < x0 + half; ++x) {
+            add_skirt(grid(x, edge_z), grid(x + 1, edge_z), skirt(qz, x), skirt(qz, x + 1));
+        }
+        const auto edge_x = qx == 0 ? 0u : n;
+        for (auto z = z0; z < z0 + half; ++z) {
+            add_skirt(grid(edge_x, z), grid(edge_x, z + 1), skirt(2 + qx, z), skirt(2 + qx, z + 1));
+        }
+    }
+
+    return data;
+}
+
+auto Terrain::BuildHeights(const Image& heightmap) -> void {
+    const auto width = static_cast<std::size_t>(heightmap.width);
+    const auto height = static_cast<std::size_t>(heightmap.height);
+    const auto texel = [&](std::size_t x, std::size_t z) {
+        return static_cast<float>(heightmap.Data()[(z * width + x) * 4]) / 255.0f * params_.height;
+    };
+
+    // heights are filtered between texel centres, so a node's range is the
+    // range of every texel it touches
+    const auto leaves = std::size_t {1} << (lods_ - 1);
+    const auto to_texel = [](std::size_t cell, std::size_t cells, std::size_t texels) {
+        return static_cast<double>(cell) / static_cast<double>(cells) * static_cast<double>(texels - 1);
+    };
+
+    auto& finest = heights_.emplace_back(leaves * leaves);
+    for (auto z = std::size_t {0}; z < leaves; ++z) {
+        const auto z0 = static_cast<std::size_t>(std::floor(to_texel(z, leaves, height)));
+        const auto z1 = static_cast<std::size_t>(std::ceil(to_texel(z + 1, leaves, height)));
+        for (auto x = std::size_t {0}; x < leaves; ++x) {
+            const auto x0 = static_cast<std::size_t>(std::floor(to_texel(x, leaves, width)));
+            const auto x1 = static_cast<std::size_t>(std::ceil(to_texel(x + 1, leaves, width)));
+
+            auto range = std::pair {std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()};
+            for (auto tz = z0; tz <= z1; ++tz) {
+                for (auto tx = x0; tx <= x1; ++tx) {
+                    range.first = std::min(range.first, texel(tx, tz));
+                    range.second = std::max(range.second, texel(tx, tz));
+                }
+            }
+            finest[z * leaves + x] = range;
+        }
+    }
+
+    for (auto count = leaves / 2; count > 0; count /= 2) {
+        const auto& children = heights_.back();
+        auto parents = std::vector<std::pair<float, float>>(count * count);
+        for (auto z = std::size_t {0}; z < count; ++z) {
+            for (auto x = std::size_t {0}; x < count; ++x) {
+                auto& range = parents[z * count + x];
+                range = children[(z * 2) * count * 2 + x * 2];
+                for (auto i = std::size_t {1}; i < 4; ++i) {
+                    const auto& child = children[(z * 2 + (i >> 1)) * count * 2 + x * 2 + (i & 1)];
+                    range.first = std::min(range.first, child.first);
+                    range.second = std::max(range.second, child.second);
+                }
+            }
+        }
+        heights_.emplace_back(std::move(parents));
+    }
+}
+
+auto Terrain::GetBounds(unsigned lod, std::size_t x, std::size_t z) const -> Bounds {
+    const auto size = leaf_size_ * static_cast<float>(1u << lod);
+    const auto count = std::size_t {1} << (lods_ - 1 - lod);
+    const auto [low, high] = heights_[lod][z * count + x];
+    const auto min = glm::vec3 {
+        -params_.size / 2.0f + static_cast<float>(x) * size,
+        low,
+        -params_.size / 2.0f + static_cast<float>(z) * size
+    };
+    return {
+        .min = params_.origin + min,
+        .max = params_.origin + min + glm::vec3 {size, high - low, size}
+    };
+}
+
+auto Terrain::Select(const PerspectiveCamera& camera) -> void {
+    const auto frustum = Frustum {camera.Projection() * camera.View()};
+    const auto position = glm::vec3 {camera.transform[3]};
+
+    // each LOD left out roughly quarters the patches around the camera; the
+    // ranges stay the same, so the coarser patches still morph into their
+    // neighbours
+    for (finest_lod_ = 0; ; ++finest_lod_) {
+        SelectAll(frustum, position);
+        const auto fits = params_.triangle_budget == 0 || stats_.triangles <= params_.triangle_budget;
+        if (fits || finest_lod_ + 1 == lods_) break;
+    }
+}
+
+auto Terrain::SelectAll(const Frustum& frustum, const glm::vec3& camera) -> void {
+    for (auto& group : instances_) group.clear();
+    stats_ = {.patches = 0, .triangles = 0, .culled = 0, .lods = lods_, .finest_lod = finest_lod_};
+
+    SelectNode(lods_ - 1, 0, 0, frustum, camera);
+
+    for (auto group = std::size_t {0}; group < kGroups; ++group) {
+        const auto indices = group == 0 ? quadrant_indices_ * 4 : quadrant_indices_;
+        stats_.patches += instances_[group].size();
+        stats_.triangles += instances_[group].size() * indices / 3;
+    }
+}
+
+auto Terrain::SelectNode(
+    unsigned lod,
+    std::size_t x,
+    std::size_t z,
+    const Frustum& frustum,
+    const glm::vec3& camera
+) -> bool {
+    const auto bounds = GetBounds(lod, x, z);
+
+    // out of range for this LOD; the parent covers it at a coarser one
+    if (!IntersectsSphere(camera, ranges_[lod], bounds.min, bounds.max)) return false;
+
+    if (!frustum.IntersectsBox(bounds.min, bounds.max)) {
+        ++stats_.culled;
+        return true;
+    }
+
+    if (lod == finest_lod_ || !IntersectsSphere(camera, ranges_[lod - 1], bounds.min, bounds.max)) {
+        AddPatch(0, lod, bounds);
+        return true;
+    }
+
+    // children within their range are drawn finer; the quadrants that are
+    // not are drawn here, at this LOD
+    for (auto quadrant = std::size_t {0}; quadrant < 4; ++quadrant) {
+        const auto child_x = x * 2 + (quadrant & 1);
+        const auto child_z = z * 2 + (quadrant >> 1);
+        if (SelectNode(lod - 1, child_x, child_z, frustum, camera)) continue;
+
+        const auto child = GetBounds(lod - 1, child_x, child_z);
+        if (frustum.IntersectsBox(child.min, child.max)) {
+            AddPatch(1 + quadrant, lod, bounds);
+        } else {
+            ++stats_.culled;
+        }
+    }
+    return true;
+}
+
+auto Terrain::AddPatch(std::size_t group, unsigned lod, const Bounds& bounds) -> void {
+    instances_[group].emplace_back(PatchInstance {
+        .x = bounds.min.x - params_.origin.x,
+        .z = bounds.min.z - params_.origin.z,
+        .size = bounds.max.x - bounds.min.x,
+        .lod = static_cast<float>(lod),
+        .morph_start = morph_[lod].first,
+        .morph_end = morph_[lod].second
+    });
+}
+
+auto Terrain::Draw(const PerspectiveCamera& camera) -> void {
+    Select(camera);
+    if (stats_.patches == 0) return;
+
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+
+    // one buffer for all groups, respecified each frame so the driver can
+    // hand out fresh storage instead of waiting for the previous frame
+    auto bytes = std::size_t {0};
+    for (const auto& group : instances_) bytes += group.size() * sizeof(PatchInstance);
+    glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    auto offset = std::size_t {0};
+    for (const auto& group : instances_) {
+        const auto size = group.size() * sizeof(PatchInstance);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, group.data());
+        offset += size;
+    }
+    RENDER_STATS_ADD(buffer_bytes, bytes);
+
+    shader_->SetUniform("u_Projection", camera.Projection());
+    shader_->SetUniform("u_View", camera.View());
+    shader_->SetUniform("u_CameraPosition", glm::vec3 {camera.transform[3]});
+    shader_->SetUniform("u_Origin", params_.origin);
+    shader_->SetUniform("u_Size", params_.size);
+    shader_->SetUniform("u_Height", params_.height);
+    shader_->SetUniform("u_Resolution", static_cast<float>(params_.resolution));
+    shader_->SetUniform("u_Heightmap", 0);
+    heightmap_.Bind();
+
+    offset = 0;
+    for (auto group = std::size_t {0}; group < kGroups; ++group) {
+        const auto count = instances_[group].size();
+        if (count == 0) continue;
+
+        const auto base = reinterpret_cast<void*>(offset);
+        const auto morph = reinterpret_cast<void*>(offset + offsetof(PatchInstance, morph_start));
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(PatchInstance), base);
+        glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, sizeof(PatchInstance), morph);
+        offset += count * sizeof(PatchInstance);
+
+        const auto indices = group == 0 ? quadrant_indices_ * 4 : quadrant_indices_;
+        const auto first = group == 0 ? 0 : (group - 1) * quadrant_indices_;
+        glDrawElementsInstanced(
+            GL_TRIANGLES,
+            static_cast<GLsizei>(indices),
+            GL_UNSIGNED_INT,
+            reinterpret_cast<void*>(first * sizeof(unsigned int)),
+            static_cast<GLsizei>(count)
+        );
+        RENDER_STATS_ADD(draw_calls, 1);
+        RENDER_STATS_ADD(triangles, count * indices / 3);
+    }
+    RENDER_STATS_ADD(vao_binds, 1);
+}
+
+Terrain::~Terrain() {
+    glDeleteBuffers(1, &instance_vbo_);
+    glDeleteBuffers(1, &ebo_);
+    glDeleteBuffers(1, &vbo_);
+    glDeleteVertexArrays(1, &vao_);
+}
\ No newline at end of file
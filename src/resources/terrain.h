@@ -0,0 +1,130 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "core/frustum.h"
+#include "core/geometry.h"
+#include "core/image.h"
+#include "core/perspective_camera.h"
+#include "core/shaders.h"
+#include "core/texture2d.h"
+
+// Continuous-LOD terrain over a heightfield (CDLOD). The terrain is a
+// quadtree whose nodes all draw the same grid patch, scaled to the node, so
+// every LOD has the same number of triangles per patch and finer nodes are
+// only chosen near the camera. Each doubling of the terrain size adds one
+// coarser ring of patches, so the triangles drawn grow with the log of the
+// size; past the triangle budget the finest LODs are left out near the
+// camera until the selection fits.
+//
+// Each LOD covers the distances up to its range, which doubles per level.
+// Close to the end of its range a patch morphs its odd vertices onto the
+// next coarser grid, so neighbouring LODs meet without cracks or popping.
+class Terrain {
+public:
+    struct Parameters {
+        float size {256.0f};             // world size of each side
+        float height {32.0f};            // world height of a white heightmap texel
+        unsigned resolution {32};        // quads along a patch edge; rounded up to a power of two, 2 to 1024
+        float leaf_size {16.0f};         // size of the finest patch; rounded so the root splits evenly
+        float lod_distance {48.0f};      // range of the finest LOD
+        float morph_ratio {0.3f};        // part of each range spent morphing
+        glm::vec3 origin {0.0f};         // world position of the centre at height 0
+        std::size_t triangle_budget {131072}; // per frame, 0 for no limit
+    };
+
+    struct Stats {
+        std::size_t patches {0};
+        std::size_t triangles {0};
+        std::size_t culled {0}; // nodes rejected by the frustum
+        unsigned lods {0};
+        unsigned finest_lod {0}; // above 0 when the budget was reached
+    };
+
+    Terrain(const Parameters& params, std::shared_ptr<Image> heightmap);
+
+    // deleted copy constructors and assignment operators
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
+
+    // A grid patch in [0, 1] on x and z with skirts (y = 1) along its edges.
+    // Indices are ordered by quadrant, so a quarter patch is a quarter of
+    // the index range.
+    [[nodiscard]] static auto GeneratePatch(unsigned resolution) -> GeometryData;
+
+    // chooses the patches for this camera without touching GL
+    auto Select(const PerspectiveCamera& camera) -> void;
+
+    auto Draw(const PerspectiveCamera& camera) -> void;
+
+    [[nodiscard]] auto GetStats() const -> const Stats& { return stats_; }
+
+    ~Terrain();
+
+private:
+    struct PatchInstance {
+        float x;
+        float z;
+        float size;
+        float lod;
+        float morph_start;
+        float morph_end;
+    };
+
+    struct Bounds {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // whole patches, then one group per quadrant
+    static constexpr auto kGroups = std::size_t {5};
+
+    Parameters params_;
+
+    unsigned lods_ {0};
+    unsigned finest_lod_ {0};
+    float leaf_size_ {0.0f};
+    std::vector<float> ranges_ {};
+    std::vector<std::pair<float, float>> morph_ {};
+
+    // min and max height of every node, finest LOD first
+    std::vector<std::vector<std::pair<float, float>>> heights_ {};
+
+    std::array<std::vector<PatchInstance>, kGroups> instances_ {};
+
+    Stats stats_ {};
+
+    std::unique_ptr<Shaders> shader_ {nullptr};
+    Texture2D heightmap_;
+
+    unsigned int vao_ {0};
+    unsigned int vbo_ {0};
+    unsigned int ebo_ {0};
+    unsigned int instance_vbo_ {0};
+    std::size_t quadrant_indices_ {0};
+
+    auto BuildHeights(const Image& heightmap) -> void;
+
+    auto GetBounds(unsigned lod, std::size_t x, std::size_t z) const -> Bounds;
+
+    auto SelectNode(
+        unsigned lod,
+        std::size_t x,
+        std::size_t z,
+        const Frustum& frustum,
+        const glm::vec3& camera
+    ) -> bool;
+
+    auto SelectAll(const Frustum& frustum, const glm::vec3& camera) -> void;
+
+    auto AddPatch(std::size_t group, unsigned lod, const Bounds& bounds) -> void;
+};
\ No newline at end of file
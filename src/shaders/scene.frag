@@ -5,9 +5,62 @@
 layout (location = 0) out vec4 FragColor;
 
 in vec2 v_TexCoord;
+in vec3 v_Position;
+in vec3 v_Normal;
 
 uniform sampler2D u_TextureMap;
 
+// from ClusteredLights: three texels per light, (position, range),
+// (color, spot scale) and (direction, spot offset), all in view space
+uniform samplerBuffer u_Lights;
+uniform usamplerBuffer u_Clusters;     // offset and count into u_LightIndices
+uniform usamplerBuffer u_LightIndices;
+uniform int u_LightCount;
+uniform int u_BruteForce;
+uniform vec3 u_Ambient;
+
+// cluster = floor((gl_FragCoord.xy, log(depth)) * scale + (0, 0, bias))
+uniform vec3 u_ClusterGrid;
+uniform vec3 u_ClusterScale;
+uniform float u_ClusterBias;
+
+vec3 Shade(int light, vec3 normal) {
+    vec4 position = texelFetch(u_Lights, light * 3);
+    vec4 color = texelFetch(u_Lights, light * 3 + 1);
+    vec4 direction = texelFetch(u_Lights, light * 3 + 2);
+
+    vec3 to_light = position.xyz - v_Position;
+    float distance = length(to_light);
+    if (distance >= position.w) return vec3(0.0);
+    vec3 l = to_light / distance;
+
+    // smooth to zero at the range, which is where binning stops
+    float window = clamp(1.0 - pow(distance / position.w, 4.0), 0.0, 1.0);
+    float falloff = window * window / (distance * distance + 1.0);
+    float cone = clamp(dot(-l, direction.xyz) * color.w + direction.w, 0.0, 1.0);
+
+    return color.rgb * max(dot(normal, l), 0.0) * falloff * cone * cone;
+}
+
 void main() {
-    FragColor = texture(u_TextureMap, v_TexCoord);
+    vec4 albedo = texture(u_TextureMap, v_TexCoord);
+    if (u_LightCount == 0) {
+        FragColor = albedo;
+        return;
+    }
+
+    vec3 normal = normalize(v_Normal);
+    vec3 light = u_Ambient;
+    if (u_BruteForce != 0) {
+        for (int i = 0; i < u_LightCount; ++i) light += Shade(i, normal);
+    } else {
+        vec3 cell = floor(vec3(gl_FragCoord.xy, log(-v_Position.z)) * u_ClusterScale + vec3(0.0, 0.0, u_ClusterBias));
+        ivec3 grid = ivec3(u_ClusterGrid);
+        ivec3 c = clamp(ivec3(cell), ivec3(0), grid - 1);
+        uvec2 range = texelFetch(u_Clusters, (c.z * grid.y + c.y) * grid.x + c.x).xy;
+        for (uint i = 0u; i < range.y; ++i) {
+            light += Shade(int(texelFetch(u_LightIndices, int(range.x + i)).r), normal);
+        }
+    }
+    FragColor = vec4(albedo.rgb * light, albedo.a);
 }
\ No newline at end of file
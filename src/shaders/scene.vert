@@ -10,9 +10,16 @@ uniform mat4 u_Projection;
 uniform mat4 u_ModelView;
 
 out vec2 v_TexCoord;
+out vec3 v_Position;
+out vec3 v_Normal;
 
 void main() {
     v_TexCoord = a_TexCoord;
 
-    gl_Position = u_Projection * u_ModelView * vec4(a_Position, 1.0);
+    // view space, where the lights are; scales are assumed uniform
+    vec4 position = u_ModelView * vec4(a_Position, 1.0);
+    v_Position = position.xyz;
+    v_Normal = mat3(u_ModelView) * a_Normal;
+
+    gl_Position = u_Projection * position;
 }
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 410 core
+
+layout (location = 0) out vec4 FragColor;
+
+in vec3 v_Normal;
+in float v_Height;
+
+const vec3 kLightDirection = normalize(vec3(0.4, 1.0, 0.3));
+
+void main() {
+    vec3 low = vec3(0.25, 0.45, 0.2);
+    vec3 high = vec3(0.85, 0.85, 0.8);
+    vec3 color = mix(low, high, smoothstep(0.4, 0.9, v_Height));
+
+    float diffuse = max(dot(normalize(v_Normal), kLightDirection), 0.0);
+    FragColor = vec4(color * (0.25 + 0.75 * diffuse), 1.0);
+}
\ No newline at end of file
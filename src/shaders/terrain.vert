@@ -0,0 +1,54 @@
+#version 410 core
+
+// grid position in [0, 1] on x and z; y is 1 for skirt vertices
+layout (location = 0) in vec3 a_Position;
+
+// per patch: world x, world z, size, unused
+layout (location = 3) in vec4 a_Patch;
+// per patch: distances over which vertices morph to the next coarser grid
+layout (location = 4) in vec2 a_Morph;
+
+uniform mat4 u_Projection;
+uniform mat4 u_View;
+uniform vec3 u_CameraPosition;
+uniform vec3 u_Origin;
+uniform float u_Size;
+uniform float u_Height;
+uniform float u_Resolution;
+uniform sampler2D u_Heightmap;
+
+out vec3 v_Normal;
+out float v_Height;
+
+float SampleHeight(vec2 world) {
+    vec2 texels = vec2(textureSize(u_Heightmap, 0));
+    vec2 uv = (world / u_Size + 0.5) * (texels - 1.0) / texels + 0.5 / texels;
+    return texture(u_Heightmap, uv).r * u_Height;
+}
+
+void main() {
+    vec2 grid = a_Position.xz;
+    vec2 world = a_Patch.xy + grid * a_Patch.z;
+    float height = SampleHeight(world);
+
+    // morph odd vertices onto the edges of the next coarser grid as the
+    // patch approaches its range, so switching LOD does not pop
+    float dist = length(u_CameraPosition - (u_Origin + vec3(world.x, height, world.y)));
+    float morph = clamp((dist - a_Morph.x) / (a_Morph.y - a_Morph.x), 0.0, 1.0);
+    vec2 odd = fract(grid * u_Resolution * 0.5) * 2.0 / u_Resolution;
+    grid -= odd * morph;
+
+    world = a_Patch.xy + grid * a_Patch.z;
+    height = SampleHeight(world);
+
+    float cell = a_Patch.z / u_Resolution;
+    float dx = SampleHeight(world + vec2(cell, 0.0)) - SampleHeight(world - vec2(cell, 0.0));
+    float dz = SampleHeight(world + vec2(0.0, cell)) - SampleHeight(world - vec2(0.0, cell));
+    v_Normal = normalize(vec3(-dx, 2.0 * cell, -dz));
+    v_Height = height / u_Height;
+
+    // skirts hang below the edges to hide any remaining cracks
+    height -= a_Position.y * cell * 2.0;
+
+    gl_Position = u_Projection * u_View * vec4(u_Origin + vec3(world.x, height, world.y), 1.0);
+}
\ No newline at end of file
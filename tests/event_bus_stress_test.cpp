@@ -0,0 +1,100 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "expect.h"
+
+#include "core/event_bus.h"
+#include "core/event_dispatcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <format>
+#include <thread>
+#include <vector>
+
+// Producers post to every priority while one consumer drains and another
+// thread reads the stats, as the overlay does. Built with ThreadSanitizer,
+// which reports any race; the checks catch lost or repeated events.
+namespace {
+
+constexpr auto kProducers = std::size_t {4};
+constexpr auto kEventsPerProducer = std::size_t {20000};
+
+struct StressEvent {
+    std::size_t producer;
+    std::size_t sequence;
+};
+
+} // namespace
+
+auto main() -> int {
+    auto& bus = EventBus::Get();
+
+    // written only on the consumer thread, inside Drain
+    auto seen = std::vector<std::vector<unsigned>>(kProducers, std::vector<unsigned>(kEventsPerProducer));
+    auto handle = EventDispatcher::Get().AddEventListener<StressEvent>([&seen](const StressEvent& event) {
+        ++seen[event.producer][event.sequence];
+    });
+
+    auto producing = std::atomic<std::size_t> {kProducers};
+    auto producers = std::vector<std::jthread> {};
+    for (auto producer = std::size_t {0}; producer < kProducers; ++producer) {
+        producers.emplace_back([&bus, &producing, producer] {
+            for (auto sequence = std::size_t {0}; sequence < kEventsPerProducer; ++sequence) {
+                const auto priority = static_cast<EventPriority>(sequence % 3);
+                // a full queue drops the event, so post it again until it fits
+                while (!bus.Post(StressEvent {producer, sequence}, priority)) {
+                    std::this_thread::yield();
+                }
+            }
+            producing.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    auto delivered = std::size_t {0};
+    auto consumer = std::jthread {[&bus, &producing, &delivered] {
+        while (producing.load(std::memory_order_acquire) > 0 || bus.Depth() > 0) {
+            delivered += bus.Drain();
+            std::this_thread::yield();
+        }
+    }};
+
+    auto observed = std::size_t {0};
+    while (producing.load(std::memory_order_acquire) > 0) {
+        for (const auto priority : {EventPriority::kHigh, EventPriority::kNormal, EventPriority::kLow}) {
+            observed = std::max(observed, bus.GetStats(priority).delivered);
+        }
+        std::this_thread::yield();
+    }
+    producers.clear();
+    consumer.join();
+
+    constexpr auto kTotal = kProducers * kEventsPerProducer;
+    Expect(delivered == kTotal, std::format("{} events delivered, expected {}", delivered, kTotal));
+
+    auto missing = std::size_t {0};
+    auto repeated = std::size_t {0};
+    for (const auto& sequences : seen) {
+        for (const auto count : sequences) {
+            if (count == 0) ++missing;
+            if (count > 1) ++repeated;
+        }
+    }
+    Expect(missing == 0, std::format("{} events never delivered", missing));
+    Expect(repeated == 0, std::format("{} events delivered more than once", repeated));
+
+    auto posted = std::size_t {0};
+    auto counted = std::size_t {0};
+    for (const auto priority : {EventPriority::kHigh, EventPriority::kNormal, EventPriority::kLow}) {
+        const auto stats = bus.GetStats(priority);
+        posted += stats.posted;
+        counted += stats.delivered;
+    }
+    Expect(posted == kTotal, std::format("{} events counted as posted, expected {}", posted, kTotal));
+    Expect(counted == kTotal, std::format("{} events counted as delivered, expected {}", counted, kTotal));
+    Expect(observed <= kTotal, "stats read during the run exceed the events posted");
+
+    EventDispatcher::Get().RemoveEventListener(handle);
+    return TestResult();
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "expect.h"
+
+#include "core/event_dispatcher.h"
+#include "core/event_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <new>
+
+// every heap allocation in the program goes through these
+namespace {
+
+auto counting = std::atomic<bool> {false};
+auto allocations = std::atomic<std::size_t> {0};
+
+auto Allocate(std::size_t size, std::size_t alignment) -> void* {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    const auto rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (auto memory = std::aligned_alloc(alignment, rounded)) return memory;
+    throw std::bad_alloc {};
+}
+
+} // namespace
+
+auto operator new(std::size_t size) -> void* {
+    return Allocate(size, alignof(std::max_align_t));
+}
+
+auto operator new(std::size_t size, std::align_val_t alignment) -> void* {
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+auto operator delete(void* memory) noexcept -> void { std::free(memory); }
+
+auto operator delete(void* memory, std::size_t) noexcept -> void { std::free(memory); }
+
+auto operator delete(void* memory, std::align_val_t) noexcept -> void { std::free(memory); }
+
+auto operator delete(void* memory, std::size_t, std::align_val_t) noexcept -> void { std::free(memory); }
+
+auto main() -> int {
+    using enum MouseEvent::Type;
+
+    auto received = std::size_t {0};
+    auto handle = EventDispatcher::Get().AddEventListener<MouseEvent>(
+        [&received](const MouseEvent&) { ++received; }
+    );
+
+    auto queue = EventQueue {};
+    auto event = MouseEvent {};
+    event.button = MouseButton::Left;
+
+    // a frame of input: a click, then a drag that merges into one move
+    const auto frame = [&] {
+        event.type = ButtonPressed;
+        queue.Push(event);
+        for (auto i = 0; i < 32; ++i) {
+            event.type = Moved;
+            event.position.x += 1.0f;
+            event.delta = {1.0f, 0.0f};
+            queue.Push(event);
+        }
+        event.type = ButtonReleased;
+        queue.Push(event);
+        queue.Dispatch();
+    };
+
+    // the first frame may size anything lazily created
+    frame();
+    received = 0;
+
+    constexpr auto kFrames = 1000;
+    counting = true;
+    for (auto i = 0; i < kFrames; ++i) frame();
+    counting = false;
+
+    Expect(allocations == 0, std::format("{} allocations while queueing and dispatching input", allocations.load()));
+    Expect(received == kFrames * 3, std::format("{} events delivered, expected {}", received, kFrames * 3));
+    Expect(queue.Size() == 0, "events left in the queue after dispatch");
+
+    // a full queue drops instead of growing
+    auto full = EventQueue {};
+    counting = true;
+    for (auto i = std::size_t {0}; i < EventQueue::kCapacity + 8; ++i) {
+        event.type = i % 2 == 0 ? ButtonPressed : ButtonReleased;
+        full.Push(event);
+    }
+    counting = false;
+    Expect(allocations == 0, "allocations while filling the queue past its capacity");
+    Expect(full.GetStats().dropped == 8, std::format("{} events dropped, expected 8", full.GetStats().dropped));
+
+    EventDispatcher::Get().RemoveEventListener(handle);
+    return TestResult();
+}
\ No newline at end of file
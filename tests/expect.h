@@ -0,0 +1,29 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#pragma once
+
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <source_location>
+#include <string_view>
+
+// Each test is an executable run by ctest; a failed Expect is reported with
+// its location and turns the exit code into a failure, without stopping the
+// checks that follow.
+inline auto expect_failures = 0;
+
+inline auto Expect(
+    bool condition,
+    std::string_view message,
+    const std::source_location& where = std::source_location::current()
+) {
+    if (condition) return;
+    ++expect_failures;
+    std::cerr << std::format("{}:{}: {}\n", where.file_name(), where.line(), message);
+}
+
+[[nodiscard]] inline auto TestResult() {
+    return expect_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "expect.h"
+
+#include "fixtures.h"
+#include "reference_mesh.h"
+
+#include "geometries/box_geometry.h"
+#include "geometries/mesh_processing.h"
+#include "geometries/plane_geometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <span>
+#include <string_view>
+
+// The four-wide kernels against the plain per-vertex versions the
+// benchmarks compare with. Sums are added in a different order, so results
+// match within a tolerance rather than exactly.
+namespace {
+
+auto ExpectClose(
+    std::string_view what,
+    std::span<const float> actual,
+    std::span<const float> expected,
+    float tolerance
+) {
+    if (actual.size() != expected.size()) {
+        Expect(false, std::format("{}: {} floats, expected {}", what, actual.size(), expected.size()));
+        return;
+    }
+    auto worst = std::size_t {0};
+    auto worst_error = 0.0f;
+    for (auto i = std::size_t {0}; i < actual.size(); ++i) {
+        const auto error = std::abs(actual[i] - expected[i]) / std::max(1.0f, std::abs(expected[i]));
+        if (error > worst_error) {
+            worst = i;
+            worst_error = error;
+        }
+    }
+    Expect(worst_error <= tolerance, std::format(
+        "{}: float {} is {}, expected {}",
+        what, worst, actual.empty() ? 0.0f : actual[worst], expected.empty() ? 0.0f : expected[worst]
+    ));
+}
+
+// 255 vertices a side, so the count is not a multiple of the four lanes
+auto Plane() {
+    return PlaneGeometry::Parameters {
+        .width = 100.0f,
+        .height = 100.0f,
+        .width_segments = 254,
+        .height_segments = 254
+    };
+}
+
+} // namespace
+
+auto main() -> int {
+    const auto heightmap = Heightmap(255);
+
+    {
+        auto actual = PlaneGeometry::Generate(Plane());
+        auto expected = actual;
+        DisplaceVertices(actual, *heightmap, {.scale = 2.0f});
+        ReferenceDisplace(expected, *heightmap, 2.0f);
+        ExpectClose("DisplaceVertices", actual.vertex_data, expected.vertex_data, 1e-5f);
+    }
+
+    {
+        auto actual = PlaneGeometry::Generate(Plane());
+        DisplaceVertices(actual, *heightmap, {.scale = 2.0f});
+        auto expected = actual;
+        ComputeGridNormals(actual, PlaneGeometry::Grid(Plane()));
+        ReferenceGridNormals(expected, PlaneGeometry::Grid(Plane()));
+        ExpectClose("ComputeGridNormals vertices", actual.vertex_data, expected.vertex_data, 1e-5f);
+        ExpectClose("ComputeGridNormals tangents", actual.tangent_data, expected.tangent_data, 1e-5f);
+    }
+
+    {
+        auto actual = PlaneGeometry::Generate(Plane());
+        DisplaceVertices(actual, *heightmap, {.scale = 2.0f});
+        auto expected = actual;
+        ComputeNormals(actual);
+        ReferenceNormals(expected);
+        ExpectClose("ComputeNormals vertices", actual.vertex_data, expected.vertex_data, 1e-4f);
+        ExpectClose("ComputeNormals tangents", actual.tangent_data, expected.tangent_data, 1e-4f);
+    }
+
+    // hard edges and faces that share no vertices, unlike a grid
+    {
+        auto actual = BoxGeometry::Generate({
+            .width = 1.0f,
+            .height = 2.0f,
+            .depth = 3.0f,
+            .width_segments = 5,
+            .height_segments = 7,
+            .depth_segments = 3
+        });
+        auto expected = actual;
+        ComputeNormals(actual);
+        ReferenceNormals(expected);
+        ExpectClose("ComputeNormals box vertices", actual.vertex_data, expected.vertex_data, 1e-4f);
+        ExpectClose("ComputeNormals box tangents", actual.tangent_data, expected.tangent_data, 1e-4f);
+    }
+
+    return TestResult();
+}
\ No newline at end of file
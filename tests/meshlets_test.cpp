@@ -0,0 +1,110 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "expect.h"
+
+#include "fixtures.h"
+
+#include "geometries/box_geometry.h"
+#include "geometries/mesh_processing.h"
+#include "geometries/mesh_simplifier.h"
+#include "geometries/meshlets.h"
+#include "geometries/plane_geometry.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <format>
+#include <string_view>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// BuildMeshlets only reorders triangles: every triangle of the finest level
+// has to end up in exactly one meshlet, unchanged, and no meshlet may go
+// over its triangle or vertex limit.
+namespace {
+
+using Triangle = std::array<unsigned, 3>;
+
+auto Triangles(const std::vector<unsigned int>& indices, std::size_t begin, std::size_t end) {
+    auto triangles = std::vector<Triangle> {};
+    for (auto i = begin; i + 2 < end; i += 3) {
+        triangles.emplace_back(Triangle {indices[i], indices[i + 1], indices[i + 2]});
+    }
+    std::ranges::sort(triangles);
+    return triangles;
+}
+
+auto Check(std::string_view name, GeometryData data, const MeshletParameters& params) {
+    const auto original = data;
+    BuildMeshlets(data, params);
+
+    const auto range = data.lods.empty() ? data.index_data.size() : data.lods.front().index_count;
+    Expect(!data.meshlets.empty(), std::format("{}: no meshlets", name));
+    Expect(data.vertex_data == original.vertex_data, std::format("{}: vertices changed", name));
+    Expect(
+        Triangles(data.index_data, 0, range) == Triangles(original.index_data, 0, range),
+        std::format("{}: the finest level's triangles changed", name)
+    );
+    Expect(
+        std::ranges::equal(data.index_data.begin() + range, data.index_data.end(), original.index_data.begin() + range, original.index_data.end()),
+        std::format("{}: coarser levels were reordered", name)
+    );
+
+    // the meshlets are consecutive ranges, so every triangle is in one
+    auto offset = std::size_t {0};
+    auto vertices = std::vector<unsigned>(data.vertex_data.size() / 8, 0);
+    for (auto m = std::size_t {0}; m < data.meshlets.size(); ++m) {
+        const auto& meshlet = data.meshlets[m];
+        Expect(meshlet.index_offset == offset, std::format("{}: meshlet {} starts at {}, expected {}", name, m, meshlet.index_offset, offset));
+        Expect(meshlet.index_count > 0 && meshlet.index_count % 3 == 0, std::format("{}: meshlet {} has {} indices", name, m, meshlet.index_count));
+        Expect(meshlet.index_count / 3 <= params.max_triangles, std::format("{}: meshlet {} has {} triangles", name, m, meshlet.index_count / 3));
+        offset = meshlet.index_offset + meshlet.index_count;
+
+        auto distinct = 0u;
+        auto outside = 0u;
+        for (auto i = meshlet.index_offset; i < offset; ++i) {
+            const auto vertex = data.index_data[i];
+            if (vertices[vertex] != m + 1) ++distinct;
+            vertices[vertex] = static_cast<unsigned>(m + 1);
+
+            const auto* p = &data.vertex_data[vertex * 8];
+            if (glm::distance(glm::vec3 {p[0], p[1], p[2]}, meshlet.center) > meshlet.radius * 1.0001f + 1e-6f) ++outside;
+        }
+        Expect(distinct <= params.max_vertices, std::format("{}: meshlet {} has {} vertices", name, m, distinct));
+        Expect(outside == 0, std::format("{}: meshlet {} has {} vertices outside its sphere", name, m, outside));
+    }
+    Expect(offset == range, std::format("{}: meshlets cover {} indices, expected {}", name, offset, range));
+}
+
+} // namespace
+
+auto main() -> int {
+    const auto box = BoxGeometry::Generate({
+        .width = 1.0f,
+        .height = 1.0f,
+        .depth = 1.0f,
+        .width_segments = 32,
+        .height_segments = 32,
+        .depth_segments = 32
+    });
+    Check("box", box, {});
+    Check("box, small meshlets", box, {.max_triangles = 16, .max_vertices = 12});
+    Check("box, vertex bound", box, {.max_triangles = 124, .max_vertices = 3});
+
+    const auto plane = PlaneGeometry::Parameters {
+        .width = 10.0f,
+        .height = 10.0f,
+        .width_segments = 63,
+        .height_segments = 63
+    };
+    auto terrain = PlaneGeometry::Generate(plane);
+    DisplaceVertices(terrain, *Heightmap(64), {.scale = 2.0f});
+    ComputeGridNormals(terrain, PlaneGeometry::Grid(plane));
+    GenerateLods(terrain, {.levels = 3});
+    Expect(!terrain.lods.empty(), "the displaced plane has no levels of detail");
+    Check("displaced plane with levels", terrain, {.max_triangles = 64, .max_vertices = 40, .cone_weight = 1.0f});
+
+    return TestResult();
+}
\ No newline at end of file
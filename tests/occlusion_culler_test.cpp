@@ -0,0 +1,76 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "expect.h"
+
+#include "core/occlusion_culler.h"
+#include "geometries/plane_geometry.h"
+
+#include <format>
+#include <string_view>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// A ten by ten wall ten units in front of a camera at the origin, looking
+// down -z. Boxes fully behind one of its triangles are hidden; anything in
+// front of it, past its edges, across the seam between its triangles or
+// reaching the camera is not.
+namespace {
+
+auto Check(OcclusionCuller& culler, std::string_view name, glm::vec3 min, glm::vec3 max, bool occluded) {
+    Expect(
+        culler.IsOccluded(min, max) == occluded,
+        std::format("{}: expected {}", name, occluded ? "hidden" : "visible")
+    );
+}
+
+} // namespace
+
+auto main() -> int {
+    const auto wall = PlaneGeometry::Generate({
+        .width = 10.0f,
+        .height = 10.0f,
+        .width_segments = 1,
+        .height_segments = 1
+    });
+    const auto projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+
+    auto culler = OcclusionCuller {{.width = 256, .height = 128}};
+    culler.BeginFrame(projection);
+    culler.AddOccluder(wall, glm::translate(glm::mat4 {1.0f}, {0.0f, 0.0f, -10.0f}));
+    culler.Rasterize();
+
+    Expect(culler.GetStats().occluder_triangles == 2, "every wall triangle is rasterized");
+
+    // the seam runs from the bottom left corner to the top right one
+    Check(culler, "behind", {-3.0f, 1.0f, -15.0f}, {-1.0f, 3.0f, -14.0f}, true);
+    Check(culler, "behind, below the seam", {1.0f, -3.0f, -12.0f}, {3.0f, -1.0f, -11.0f}, true);
+    Check(culler, "far behind", {-4.0f, 3.9f, -90.0f}, {-3.9f, 4.0f, -89.0f}, true);
+    Check(culler, "behind the seam", {-1.0f, -1.0f, -15.0f}, {1.0f, 1.0f, -14.0f}, false);
+    Check(culler, "in front", {-1.0f, -1.0f, -8.0f}, {1.0f, 1.0f, -7.0f}, false);
+    Check(culler, "just in front", {-1.0f, -1.0f, -9.9f}, {1.0f, 1.0f, -9.8f}, false);
+    Check(culler, "through the wall", {-1.0f, -1.0f, -11.0f}, {1.0f, 1.0f, -9.0f}, false);
+    Check(culler, "beside", {12.0f, -1.0f, -15.0f}, {14.0f, 1.0f, -14.0f}, false);
+    Check(culler, "past the edge", {4.0f, -1.0f, -20.0f}, {12.0f, 1.0f, -19.0f}, false);
+    Check(culler, "reaching the camera", {-1.0f, -1.0f, -15.0f}, {1.0f, 1.0f, 1.0f}, false);
+
+    // the wall's back faces the camera, so it hides nothing
+    culler.BeginFrame(projection);
+    culler.AddOccluder(wall, glm::rotate(glm::translate(glm::mat4 {1.0f}, {0.0f, 0.0f, -10.0f}), glm::radians(180.0f), {0.0f, 1.0f, 0.0f}));
+    culler.Rasterize();
+    Check(culler, "behind a back face", {-1.0f, -1.0f, -15.0f}, {1.0f, 1.0f, -14.0f}, false);
+
+    // a wall seen at a grazing angle: a box resting on its surface is in
+    // front of it wherever it shows
+    const auto slope = glm::rotate(glm::translate(glm::mat4 {1.0f}, {0.0f, 0.0f, -10.0f}), glm::radians(-80.0f), {0.0f, 1.0f, 0.0f});
+    culler.BeginFrame(projection);
+    culler.AddOccluder(wall, slope);
+    culler.Rasterize();
+    for (auto i = -4; i <= 4; ++i) {
+        const auto centre = glm::vec3 {slope * glm::vec4 {static_cast<float>(i), 0.0f, 0.02f, 1.0f}};
+        Check(culler, std::format("on a sloped wall at {}", i), centre - glm::vec3 {0.01f}, centre + glm::vec3 {0.01f}, false);
+    }
+
+    return TestResult();
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "expect.h"
+
+#include "core/main_thread_queue.h"
+#include "core/task.h"
+
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+// Tasks that finish a frame later, awaited together through WhenAll. The
+// queue is drained by hand, standing in for Window::Start.
+namespace {
+
+auto Step(int& finished) -> Task<> {
+    co_await NextFrame();
+    ++finished;
+}
+
+auto Value(int value) -> Task<int> {
+    co_await NextFrame();
+    co_return value;
+}
+
+auto RunFrames() {
+    for (auto frame = 0; frame < 8; ++frame) {
+        MainThreadQueue::Get().Drain();
+    }
+}
+
+} // namespace
+
+auto main() -> int {
+    auto finished = 0;
+    auto done = false;
+    Spawn([](int& finished, bool& done) -> Task<> {
+        auto steps = std::vector<Task<>> {};
+        for (auto i = 0; i < 4; ++i) steps.emplace_back(Step(finished));
+        const auto results = co_await WhenAll(std::move(steps));
+        Expect(results.size() == 4, "one result per task");
+        Expect(finished == 4, "every task completes before WhenAll resumes");
+        done = true;
+    }(finished, done));
+    RunFrames();
+    Expect(done, "WhenAll over Task<>s resumes");
+
+    auto mixed = false;
+    Spawn([](int& finished, bool& mixed) -> Task<> {
+        auto [value, step] = co_await WhenAll(Value(42), Step(finished));
+        Expect(value == 42, "results keep their order");
+        Expect(std::is_same_v<decltype(step), std::monostate>, "Task<> yields std::monostate");
+        mixed = true;
+    }(finished, mixed));
+    RunFrames();
+    Expect(mixed, "WhenAll over Task<int> and Task<> resumes");
+    Expect(finished == 5, "every task ran once");
+
+    return TestResult();
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+
+#include "expect.h"
+
+#include "core/worker_pool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <format>
+#include <vector>
+
+auto main() -> int {
+    auto& pool = WorkerPool::Get();
+
+    {
+        auto calls = std::vector<std::atomic<int>>(1000);
+        pool.Run(calls.size(), [&calls](std::size_t task) { ++calls[task]; });
+        auto wrong = std::size_t {0};
+        for (const auto& count : calls) wrong += count != 1;
+        Expect(wrong == 0, std::format("{} of 1000 tasks not run exactly once", wrong));
+    }
+
+    {
+        auto calls = 0;
+        pool.Run(0, [&calls](std::size_t) { ++calls; });
+        Expect(calls == 0, "a run without tasks called its function");
+    }
+
+    // ranges cover every item once, including a count that does not divide
+    {
+        constexpr auto kCount = std::size_t {10007};
+        auto items = std::vector<std::atomic<int>>(kCount);
+        ParallelFor(kCount, 100, [&items](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; ++i) ++items[i];
+        });
+        auto wrong = std::size_t {0};
+        for (const auto& count : items) wrong += count != 1;
+        Expect(wrong == 0, std::format("{} of {} items not covered exactly once", wrong, kCount));
+    }
+
+    // tasks that run on the pool can use it themselves
+    {
+        auto total = std::atomic<std::size_t> {0};
+        pool.Run(16, [&total](std::size_t) {
+            ParallelFor(1000, 10, [&total](std::size_t begin, std::size_t end) {
+                total += end - begin;
+            });
+        });
+        Expect(total == 16000, std::format("nested runs covered {} items, expected 16000", total.load()));
+    }
+
+    Expect(pool.TaskCount(0, 16) == 1, "no work still makes one task");
+    Expect(pool.TaskCount(1 << 20, 16) == pool.Concurrency(), "tasks are capped at one per thread");
+
+    return TestResult();
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+// Copyright © 2024 - Present, Shlomi Nissan.
+// All rights reserved.
+//
+// Packs a directory into a single archive for AssetArchive.
+// usage: asset-packer <input directory> <output file> [--compress]
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef ASSET_PACKER_TRANSCODE
+    #define STB_IMAGE_IMPLEMENTATION
+    #include <stb_image.h>
+#endif
+
+#include "loaders/archive_format.h"
+#include "loaders/compression.h"
+
+namespace fs = std::filesystem;
+
+struct PackedFile {
+    std::string path;
+    std::vector<std::byte> payload;
+    std::uint64_t raw_size;
+    ArchiveFormat format;
+    std::uint32_t flags;
+};
+
+static auto ReadFile(const fs::path& path) -> std::vector<std::byte> {
+    auto file = std::ifstream {path, std::ios::binary};
+    auto bytes = std::vector<char> {std::istreambuf_iterator<char>(file), {}};
+    auto output = std::vector<std::byte>(bytes.size());
+    std::memcpy(output.data(), bytes.data(), bytes.size());
+    return output;
+}
+
+static auto IsImage(const fs::path& path) {
+    const auto ext = path.extension().string();
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg";
+}
+
+// decodes images ahead of time so the runtime can upload them directly;
+// built without stb, images are stored as-is and decoded at load time
+static auto Transcode(const fs::path& path, std::vector<std::byte>& payload) {
+#ifdef ASSET_PACKER_TRANSCODE
+    auto width = 0;
+    auto height = 0;
+    auto depth = 0;
+    auto pixels = stbi_load_from_memory(
+        reinterpret_cast<const stbi_uc*>(payload.data()),
+        static_cast<int>(payload.size()),
+        &width, &height, &depth, 4
+    );
+    if (pixels == nullptr) {
+        std::cerr << std::format("Keeping '{}' as-is: {}\n", path.string(), stbi_failure_reason());
+        return ArchiveFormat::kRaw;
+    }
+
+    const auto header = ArchiveImageHeader {
+        .width = static_cast<std::uint32_t>(width),
+        .height = static_cast<std::uint32_t>(height),
+        .depth = static_cast<std::uint32_t>(depth),
+        .reserved = 0
+    };
+    const auto pixel_bytes = static_cast<std::size_t>(width) * height * 4;
+
+    payload.resize(sizeof(header) + pixel_bytes);
+    std::memcpy(payload.data(), &header, sizeof(header));
+    std::memcpy(payload.data() + sizeof(header), pixels, pixel_bytes);
+    stbi_image_free(pixels);
+
+    return ArchiveFormat::kImageRGBA8;
+#else
+    static_cast<void>(path);
+    static_cast<void>(payload);
+    return ArchiveFormat::kRaw;
+#endif
+}
+
+static auto Align(std::uint64_t value) {
+    return (value + kArchiveAlignment - 1) & ~(kArchiveAlignment - 1);
+}
+
+auto main(int argc, char* argv[]) -> int {
+    if (argc < 3) {
+        std::cerr << "usage: asset-packer <input directory> <output file> [--compress]\n";
+        return 1;
+    }
+
+    const auto input = fs::path {argv[1]};
+    const auto output = fs::path {argv[2]};
+    const auto compress = argc > 3 && std::string_view {argv[3]} == "--compress";
+
+    if (!fs::is_directory(input)) {
+        std::cerr << std::format("Input directory not found '{}'\n", input.string());
+        return 1;
+    }
+
+    // entries are keyed by paths relative to the input's parent so that
+    // "assets/checker.png" resolves the same way as the loose file
+    auto files = std::vector<PackedFile> {};
+    for (const auto& item : fs::recursive_directory_iterator(input)) {
+        if (!item.is_regular_file()) continue;
+
+        auto file = PackedFile {
+            .path = item.path().lexically_relative(input.parent_path()).generic_string(),
+            .payload = ReadFile(item.path()),
+            .raw_size = 0,
+            .format = ArchiveFormat::kRaw,
+            .flags = 0
+        };
+
+        if (IsImage(item.path())) {
+            file.format = Transcode(item.path(), file.payload);
+        }
+        file.raw_size = file.payload.size();
+
+        if (compress) {
+            auto compressed = Compress(file.payload);
+            // only worth it when the saving outweighs the decode cost
+            if (compressed.size() < file.payload.size() * 9 / 10) {
+                file.payload = std::move(compressed);
+                file.flags |= kArchiveCompressed;
+            }
+        }
+
+        files.emplace_back(std::move(file));
+    }
+
+    std::ranges::sort(files, {}, [](const auto& file) { return ArchiveHash(file.path); });
+
+    auto entries = std::vector<ArchiveEntry>(files.size());
+    auto paths = std::string {};
+
+    auto offset = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    for (auto i = std::size_t {0}; i < files.size(); ++i) {
+        entries[i].hash = ArchiveHash(files[i].path);
+        entries[i].path_offset = static_cast<std::uint32_t>(offset + paths.size());
+        entries[i].path_size = static_cast<std::uint32_t>(files[i].path.size());
+        paths += files[i].path;
+    }
+    offset = Align(offset + paths.size());
+
+    for (auto i = std::size_t {0}; i < files.size(); ++i) {
+        entries[i].offset = offset;
+        entries[i].size = files[i].payload.size();
+        entries[i].raw_size = files[i].raw_size;
+        entries[i].format = files[i].format;
+        entries[i].flags = files[i].flags;
+        offset = Align(offset + files[i].payload.size());
+    }
+
+    const auto header = ArchiveHeader {
+        .magic = kArchiveMagic,
+        .version = kArchiveVersion,
+        .entry_count = static_cast<std::uint32_t>(entries.size()),
+        .reserved = 0
+    };
+
+    auto stream = std::ofstream {output, std::ios::binary | std::ios::trunc};
+    if (!stream) {
+        std::cerr << std::format("Failed to open '{}' for writing\n", output.string());
+        return 1;
+    }
+
+    const auto pad = [&stream]() {
+        const auto position = static_cast<std::uint64_t>(stream.tellp());
+        const auto zeros = std::string(Align(position) - position, '\0');
+        stream.write(zeros.data(), zeros.size());
+    };
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ArchiveEntry));
+    stream.write(paths.data(), paths.size());
+    pad();
+    for (const auto& file : files) {
+        stream.write(reinterpret_cast<const char*>(file.payload.data()), file.payload.size());
+        pad();
+    }
+
+    std::cout << std::format("Packed {} files into {}\n", files.size(), output.string());
+    return 0;
+}
\ No newline at end of file